@@ -0,0 +1,155 @@
+#ifndef HF705D06A_A4C9_467D_A02A_977EEFE39670
+#define HF705D06A_A4C9_467D_A02A_977EEFE39670
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Helpers shared by the benchmarks
+ */
+namespace Bench {
+
+/**
+ * @brief Deterministic pseudo-random generator (xorshift64*), the corpora are identical on every run
+ */
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : m_state(seed != 0 ? seed : 1) {}
+
+    /**
+     * @brief Returns the next 64 bits value
+     */
+    uint64_t next() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /**
+     * @brief Returns a value in [0, n)
+     */
+    uint64_t below(uint64_t n) {
+        return next() % n;
+    }
+
+    /**
+     * @brief Returns a value in [0, 1)
+     */
+    double real() {
+        return double(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    uint64_t m_state;
+};
+
+/**
+ * @brief Prevent the compiler from discarding a computed value
+ */
+template<typename T> inline void keep(const T &v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(v) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &v;
+#endif
+}
+
+/**
+ * @brief Options of the command line common to the benchmarks
+ */
+struct Options {
+    double m_seconds = 1.0;         ///< measuring time of each case
+    const char *m_filter = nullptr; ///< only run the cases whose name contains this string
+
+    /**
+     * @brief Parse the command line, exits on error
+     *
+     * @param argc argc
+     * @param argv argv
+     * @param usage description of the benchmark
+     */
+    void parse(int argc, char **argv, const char *usage) {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+                m_seconds = atof(argv[++i]);
+            }
+            else if (argv[i][0] != '-' && m_filter == nullptr) {
+                m_filter = argv[i];
+            }
+            else {
+                fprintf(stderr, "Usage: %s [-t SECONDS] [FILTER]\n", argv[0]);
+                fprintf(stderr, "%s\n", usage);
+                fprintf(stderr, "Each case runs for SECONDS (default 1), FILTER selects the cases by name.\n");
+                exit(2);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns true if a case is selected
+     *
+     * @param name name of the case
+     */
+    bool selected(const std::string &name) const {
+        return m_filter == nullptr || name.find(m_filter) != std::string::npos;
+    }
+};
+
+/**
+ * @brief Measure an operation
+ *
+ * The operation is run in batches for the given time, split in 5 rounds. The fastest round is kept,
+ * which filters out the noise of the other processes.
+ *
+ * @param seconds measuring time
+ * @param op operation
+ * @return time of one operation, in nanoseconds
+ */
+template<typename Op> inline double measure(double seconds, Op &&op) {
+    using clock = std::chrono::steady_clock;
+    const double round_ns = seconds * 1e9 / 5;
+
+    // calibrate the batch size to about 1 ms
+    uint64_t batch = 1;
+    while (true) {
+        const auto start = clock::now();
+        for (uint64_t i = 0; i < batch; i++) {
+            op();
+        }
+        const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        if (ns > 1e6 || batch >= (uint64_t(1) << 30)) {
+            break;
+        }
+        batch *= 2;
+    }
+
+    double best = -1;
+    for (int round = 0; round < 5; round++) {
+        uint64_t iterations = 0;
+        const auto start = clock::now();
+        double ns = 0;
+        do {
+            for (uint64_t i = 0; i < batch; i++) {
+                op();
+            }
+            iterations += batch;
+            ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        } while (ns < round_ns);
+        const double per_op = ns / double(iterations);
+        if (best < 0 || per_op < best) {
+            best = per_op;
+        }
+    }
+    return best;
+}
+
+}
+
+#endif /* HF705D06A_A4C9_467D_A02A_977EEFE39670 */
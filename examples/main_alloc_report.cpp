@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <mini_json/mini_json.h>
+
+// every heap allocation of the program: the blocks of the default memory resource and the characters of std::string
+static std::atomic<uint64_t> heap_allocations(0);
+static std::atomic<uint64_t> heap_bytes(0);
+
+void * operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+// used by std::pmr::new_delete_resource()
+void * operator new(size_t size, std::align_val_t alignment) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    const size_t a = static_cast<size_t>(alignment);
+    if (void *p = aligned_alloc(a, (size + a - 1) / a * a + (size == 0 ? a : 0))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+
+static std::string sample = R"MARKER({"id": 1234567, "user": {"name": "Jane Doe", "email": "jane.doe@example.com",
+    "roles": ["admin", "editor"], "active": true, "score": 98.5},
+    "items": [{"sku": "A-1", "qty": 2, "price": 9.99}, {"sku": "B-22", "qty": 1, "price": 149.0, "note": null}],
+    "comment": "a string long enough to be allocated outside of the small string buffer"})MARKER";
+
+struct Measure {
+    uint64_t m_heap_allocations;
+    uint64_t m_heap_bytes;
+
+    Measure() : m_heap_allocations(heap_allocations.load()), m_heap_bytes(heap_bytes.load()) {}
+};
+
+static uint64_t print_row(const char *name, const Measure &start, const MiniJSON::CountingResource &counter)
+{
+    const uint64_t allocations = heap_allocations.load() - start.m_heap_allocations;
+    fprintf(stdout, "%-22s %10llu %12llu %12llu %10llu %12llu\n", name,
+            (unsigned long long) counter.allocations(), (unsigned long long) counter.allocated_bytes(),
+            (unsigned long long) counter.peak_bytes(), (unsigned long long) allocations,
+            (unsigned long long) (heap_bytes.load() - start.m_heap_bytes));
+    return allocations;
+}
+
+int main(int argc, char **argv)
+{
+    using namespace MiniJSON;
+
+    long parse_budget = -1;
+    long generate_budget = -1;
+    const char *file = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            parse_budget = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            generate_budget = atol(argv[++i]);
+        }
+        else if (argv[i][0] != '-' && file == nullptr) {
+            file = argv[i];
+        }
+        else {
+            fprintf(stderr, "Usage: %s [-p PARSE_BUDGET] [-g GENERATE_BUDGET] [FILE]\n", argv[0]);
+            fprintf(stderr, "Print the allocations of parsing and generating FILE (or a sample document).\n");
+            fprintf(stderr, "Exit with status 1 if a call makes more heap allocations than its budget.\n");
+            return 2;
+        }
+    }
+
+    std::string document = sample;
+    if (file != nullptr) {
+        std::ifstream ifs(file, std::ios_base::in | std::ios_base::binary);
+        if (!ifs.good()) {
+            fprintf(stderr, "Can't open file %s\n", file);
+            return 200;
+        }
+        document.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    try {
+        Parser parser;
+        // a first parse warms up the parser and the iostreams
+        Value doc = parser.parse(document);
+
+        fprintf(stdout, "%-22s %10s %12s %12s %10s %12s\n", "operation", "res.allocs", "res.bytes", "res.peak", "heap.allocs", "heap.bytes");
+        uint64_t parse_allocations;
+        {
+            Measure start;
+            AllocationScope scope;
+            {
+                Value v = parser.parse(document);
+            }
+            parse_allocations = print_row("parse", start, scope.get_counter());
+        }
+        {
+            std::pmr::monotonic_buffer_resource pool;
+            Measure start;
+            CountingResource counter(&pool);
+            {
+                Value v = parser.parse(document, &counter);
+            }
+            print_row("parse (monotonic)", start, counter);
+        }
+        uint64_t generate_allocations;
+        {
+            Measure start;
+            AllocationScope scope;
+            {
+                std::string s = Generator::to_string(doc);
+            }
+            generate_allocations = print_row("to_string", start, scope.get_counter());
+        }
+        {
+            Measure start;
+            CountingResource counter;
+            {
+                std::pmr::string s = Generator::to_string(doc, &counter);
+            }
+            print_row("to_string (resource)", start, counter);
+        }
+        {
+            Measure start;
+            AllocationScope scope;
+            {
+                std::string s = Generator::to_string_pretty(doc);
+            }
+            print_row("to_string_pretty", start, scope.get_counter());
+        }
+
+        int ret = 0;
+        if (parse_budget >= 0 && parse_allocations > uint64_t(parse_budget)) {
+            fprintf(stderr, "parse: %llu heap allocations, budget %ld\n", (unsigned long long) parse_allocations, parse_budget);
+            ret = 1;
+        }
+        if (generate_budget >= 0 && generate_allocations > uint64_t(generate_budget)) {
+            fprintf(stderr, "to_string: %llu heap allocations, budget %ld\n", (unsigned long long) generate_allocations, generate_budget);
+            ret = 1;
+        }
+        return ret;
+    } catch (std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,229 @@
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include <mini_json/mini_json.h>
+
+#include "bench_common.h"
+
+// Synthetic corpora mimicking the shapes of the usual JSON benchmark files, generated with a fixed seed
+
+static const char *words[] = {"the", "json", "parser", "value", "quick", "brown", "fox", "jumps", "over", "lazy",
+    "dog", "stream", "river", "mountain", "coffee", "release", "build", "deploy", "night", "morning"};
+
+static std::string random_text(Bench::Rng &rng, size_t n_words)
+{
+    std::string s;
+    for (size_t i = 0; i < n_words; i++) {
+        if (i != 0) {
+            s += ' ';
+        }
+        s += words[rng.below(sizeof(words) / sizeof(words[0]))];
+        const uint64_t r = rng.below(40);
+        if (r == 0) {
+            s += " \\u00e9t\\u00e9";
+        }
+        else if (r == 1) {
+            s += " caf\xc3\xa9";
+        }
+        else if (r == 2) {
+            s += " \\\"quoted\\\"";
+        }
+        else if (r == 3) {
+            s += "\\n";
+        }
+    }
+    return s;
+}
+
+// string-heavy: statuses with texts, users and entities
+static std::string twitter_like()
+{
+    Bench::Rng rng(1);
+    std::string s = "{\"statuses\": [";
+    for (int i = 0; i < 1500; i++) {
+        if (i != 0) {
+            s += ", ";
+        }
+        const uint64_t id = 500000000000000000ULL + rng.below(100000000000000000ULL);
+        s += "{\"created_at\": \"Sun Aug 31 00:29:15 +0000 2014\", \"id\": " + std::to_string(id) +
+            ", \"id_str\": \"" + std::to_string(id) + "\", \"text\": \"" + random_text(rng, 8 + rng.below(16)) +
+            "\", \"source\": \"<a href=\\\"https://example.com/app\\\" rel=\\\"nofollow\\\">app</a>\", \"truncated\": false" +
+            ", \"in_reply_to_status_id\": null, \"user\": {\"id\": " + std::to_string(rng.below(1000000000)) +
+            ", \"name\": \"" + random_text(rng, 2) + "\", \"screen_name\": \"user" + std::to_string(rng.below(100000)) +
+            "\", \"location\": \"" + random_text(rng, 1) + "\", \"description\": \"" + random_text(rng, 10) +
+            "\", \"followers_count\": " + std::to_string(rng.below(100000)) + ", \"verified\": " +
+            (rng.below(10) == 0 ? "true" : "false") + ", \"lang\": \"en\"}, \"entities\": {\"hashtags\": [";
+        const uint64_t tags = rng.below(4);
+        for (uint64_t t = 0; t < tags; t++) {
+            s += (t != 0 ? ", " : "");
+            s += "{\"text\": \"" + std::string(words[rng.below(20)]) + "\", \"indices\": [" + std::to_string(t * 10) + ", " + std::to_string(t * 10 + 8) + "]}";
+        }
+        s += "], \"urls\": []}, \"retweet_count\": " + std::to_string(rng.below(1000)) + ", \"favorited\": false, \"lang\": \"en\"}";
+    }
+    s += "]}";
+    return s;
+}
+
+// float-heavy: a polygon of coordinates pairs
+static std::string canada_like()
+{
+    Bench::Rng rng(2);
+    std::string s = "{\"type\": \"FeatureCollection\", \"features\": [{\"type\": \"Feature\", \"properties\": {\"name\": \"Canada\"}, "
+        "\"geometry\": {\"type\": \"Polygon\", \"coordinates\": [";
+    char buf[64];
+    for (int ring = 0; ring < 50; ring++) {
+        s += (ring != 0 ? ", [" : "[");
+        double lon = -140.0 + rng.real() * 80.0;
+        double lat = 42.0 + rng.real() * 40.0;
+        for (int p = 0; p < 1000; p++) {
+            lon += (rng.real() - 0.5) * 0.01;
+            lat += (rng.real() - 0.5) * 0.01;
+            snprintf(buf, sizeof(buf), "%s[%.15g, %.15g]", p != 0 ? ", " : "", lon, lat);
+            s += buf;
+        }
+        s += "]";
+    }
+    s += "]}}]}";
+    return s;
+}
+
+// integer- and key-heavy: performances indexed by numeric ids, with price arrays
+static std::string citm_like()
+{
+    Bench::Rng rng(3);
+    std::string s = "{\"areaNames\": {";
+    for (int i = 0; i < 200; i++) {
+        s += (i != 0 ? ", " : "");
+        s += "\"" + std::to_string(205705993 + i) + "\": \"" + random_text(rng, 2) + "\"";
+    }
+    s += "}, \"events\": {";
+    for (int i = 0; i < 400; i++) {
+        const std::string id = std::to_string(138586341 + i * 7);
+        s += (i != 0 ? ", " : "");
+        s += "\"" + id + "\": {\"description\": null, \"id\": " + id + ", \"logo\": null, \"name\": \"" + random_text(rng, 3) +
+            "\", \"subTopicIds\": [" + std::to_string(337184269 + rng.below(100)) + ", " + std::to_string(337184283 + rng.below(100)) +
+            "], \"subjectCode\": null, \"subtitle\": null, \"topicIds\": [" + std::to_string(324846099 + rng.below(100)) + ", " +
+            std::to_string(107888604 + rng.below(100)) + "]}";
+    }
+    s += "}, \"performances\": [";
+    for (int i = 0; i < 2000; i++) {
+        s += (i != 0 ? ", " : "");
+        s += "{\"eventId\": " + std::to_string(138586341 + rng.below(400) * 7) + ", \"id\": " + std::to_string(339887544 + i) +
+            ", \"logo\": null, \"name\": null, \"prices\": [";
+        const uint64_t prices = 1 + rng.below(4);
+        for (uint64_t p = 0; p < prices; p++) {
+            s += (p != 0 ? ", " : "");
+            s += "{\"amount\": " + std::to_string(9000 + rng.below(200000)) + ", \"audienceSubCategoryId\": 337100890, \"seatCategoryId\": " +
+                std::to_string(338937295 + rng.below(50)) + "}";
+        }
+        s += "], \"seatCategories\": [{\"areas\": [{\"areaId\": " + std::to_string(205705993 + rng.below(200)) +
+            ", \"blockIds\": []}], \"seatCategoryId\": " + std::to_string(338937295 + rng.below(50)) + "}], \"seatMapImage\": null, \"start\": " +
+            std::to_string(1372701600000ULL + rng.below(100000000ULL)) + ", \"venueCode\": \"PLEYEL_PLEYEL\"}";
+    }
+    s += "]}";
+    return s;
+}
+
+// deep nesting: alternating objects and arrays, below the default maximum depth (the pretty output grows with the square of the depth)
+static std::string deep_nesting()
+{
+    std::string doc;
+    for (int d = 0; d < 10; d++) {
+        std::string s;
+        for (int i = 0; i < 500; i++) {
+            s += (i % 2 == 0) ? "{\"a\": " : "[";
+        }
+        s += std::to_string(d);
+        for (int i = 499; i >= 0; i--) {
+            s += (i % 2 == 0) ? "}" : "]";
+        }
+        doc += (d != 0 ? ", " : "[") + s;
+    }
+    return doc + "]";
+}
+
+// wide array: a flat array of small scalars
+static std::string wide_array()
+{
+    Bench::Rng rng(5);
+    std::string s = "[";
+    for (int i = 0; i < 200000; i++) {
+        s += (i != 0 ? ", " : "");
+        switch (rng.below(5)) {
+            case 0: s += std::to_string(rng.below(1000000)); break;
+            case 1: s += "-" + std::to_string(rng.below(1000)); break;
+            case 2: s += std::to_string(rng.below(1000)) + ".25"; break;
+            case 3: s += (rng.below(2) ? "true" : "false"); break;
+            default: s += "\"" + std::string(words[rng.below(20)]) + "\""; break;
+        }
+    }
+    s += "]";
+    return s;
+}
+
+static void report(const std::string &name, double ns, size_t bytes)
+{
+    fprintf(stdout, "%-28s %10.1f MB/s %12.1f docs/s %14.0f ns/doc\n", name.c_str(), double(bytes) / ns * 1e3, 1e9 / ns, ns);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    using namespace MiniJSON;
+
+    Bench::Options options;
+    options.parse(argc, argv, "Measure the parser and the generator on synthetic corpora.");
+
+    struct Corpus {
+        const char *m_name;
+        std::string m_text;
+    };
+    const std::vector<Corpus> corpora = {
+        {"twitter", twitter_like()},
+        {"canada", canada_like()},
+        {"citm", citm_like()},
+        {"deep", deep_nesting()},
+        {"wide", wide_array()},
+    };
+
+    try {
+        for (const auto &c : corpora) {
+            const std::string name(c.m_name);
+            if (!options.selected(name + "/parse") && !options.selected(name + "/to_string") && !options.selected(name + "/to_string_pretty")) {
+                continue;
+            }
+
+            Parser parser;
+            const Value doc = parser.parse(c.m_text);
+            const std::string compact = Generator::to_string(doc);
+            const std::string pretty = Generator::to_string_pretty(doc);
+            fprintf(stdout, "# %s: %zu bytes, %zu bytes compact, %zu bytes pretty\n", c.m_name, c.m_text.size(), compact.size(), pretty.size());
+
+            // the throughputs are computed on the size of the input, or of the output for the generator
+            if (options.selected(name + "/parse")) {
+                report(name + "/parse", Bench::measure(options.m_seconds, [&]() {
+                    Value v = parser.parse(c.m_text);
+                    Bench::keep(v);
+                }), c.m_text.size());
+            }
+            if (options.selected(name + "/to_string")) {
+                report(name + "/to_string", Bench::measure(options.m_seconds, [&]() {
+                    std::string s = Generator::to_string(doc);
+                    Bench::keep(s);
+                }), compact.size());
+            }
+            if (options.selected(name + "/to_string_pretty")) {
+                report(name + "/to_string_pretty", Bench::measure(options.m_seconds, [&]() {
+                    std::string s = Generator::to_string_pretty(doc);
+                    Bench::keep(s);
+                }), pretty.size());
+            }
+        }
+    } catch (std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <cstdio>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <mini_json/mini_json.h>
+
+#include "bench_common.h"
+
+static void report(const std::string &name, double ns)
+{
+    fprintf(stdout, "%-32s %10.2f ns/op\n", name.c_str(), ns);
+    fflush(stdout);
+}
+
+// a small document, similar to the records handled by the services
+static MiniJSON::Value record()
+{
+    return MiniJSON::Parser().parse(R"({"id": 339887544, "eventId": 138586341, "name": "Orchestre Philharmonique",
+        "start": 1372701600000, "venueCode": "PLEYEL_PLEYEL", "logo": null, "active": true, "rating": 4.5,
+        "prices": [{"amount": 90250, "seatCategoryId": 338937295}, {"amount": 66500, "seatCategoryId": 338937296}],
+        "topicIds": [324846099, 107888604, 324846100], "description": "a description long enough to be allocated"})");
+}
+
+// destruction can't be repeated on the same value: destroy a batch of copies and keep the fastest round
+static double measure_destroy(const MiniJSON::Value &v, size_t copies)
+{
+    double best = -1;
+    for (int round = 0; round < 10; round++) {
+        std::vector<MiniJSON::Value> pool(copies, v);
+        const auto start = std::chrono::steady_clock::now();
+        pool.clear();
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / double(copies);
+        if (best < 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    using namespace MiniJSON;
+
+    Bench::Options options;
+    options.parse(argc, argv, "Measure the operations of Value, in nanoseconds per operation.");
+    const double t = options.m_seconds;
+    auto run = [&](const std::string &name, auto &&op) {
+        if (options.selected(name)) {
+            report(name, Bench::measure(t, op));
+        }
+    };
+
+    try {
+        // construction, the destruction of the temporary is included
+        const std::string short_string("short");
+        const std::string long_string("a string too long for the small string buffer of std::string");
+        run("construct/null", [&]() { Value v; Bench::keep(v); });
+        run("construct/boolean", [&]() { Value v(true); Bench::keep(v); });
+        run("construct/uint64", [&]() { Value v(uint64_t(42)); Bench::keep(v); });
+        run("construct/int64", [&]() { Value v(int64_t(-42)); Bench::keep(v); });
+        run("construct/double", [&]() { Value v(3.25); Bench::keep(v); });
+        run("construct/string_short", [&]() { Value v(short_string); Bench::keep(v); });
+        run("construct/string_long", [&]() { Value v(long_string); Bench::keep(v); });
+        run("construct/object", [&]() { Value v = Value::new_object(); Bench::keep(v); });
+        run("construct/array", [&]() { Value v = Value::new_array(); Bench::keep(v); });
+
+        // typed access
+        const Value integer(uint64_t(42));
+        const Value string(long_string);
+        run("get/uint64", [&]() { Bench::keep(integer.get<Type::UInt64>()); });
+        run("get/string", [&]() { Bench::keep(string.get<Type::String>().size()); });
+        run("get_ptr/uint64", [&]() { Bench::keep(integer.get_ptr<Type::UInt64>()); });
+        run("get_ptr/string", [&]() { Bench::keep(string.get_ptr<Type::String>()); });
+        run("get_ptr/mismatch", [&]() { Bench::keep(integer.get_ptr<Type::String>()); });
+
+        // lookups by object size, cycling through the keys
+        for (size_t size : {1, 8, 64, 512, 4096}) {
+            Value object = Value::new_object();
+            std::vector<std::string> keys;
+            for (size_t i = 0; i < size; i++) {
+                keys.push_back("member_" + std::to_string(i * 7919 % 100003));
+                object[keys.back()] = Value(uint64_t(i));
+            }
+            const Value &o = object;
+            const std::string suffix = "/" + std::to_string(size);
+            size_t i = 0;
+            run("operator[]" + suffix, [&]() {
+                Bench::keep(o[keys[i]]);
+                i = (i + 1 == size) ? 0 : i + 1;
+            });
+            run("contains/hit" + suffix, [&]() {
+                Bench::keep(o.contains(keys[i]));
+                i = (i + 1 == size) ? 0 : i + 1;
+            });
+            const std::string missing("member_missing");
+            run("contains/miss" + suffix, [&]() { Bench::keep(o.contains(missing)); });
+        }
+
+        // copy, move and destruction of documents
+        const Value small = record();
+        Value large = Value::new_array();
+        for (int i = 0; i < 1000; i++) {
+            large.push_back(small);
+        }
+        run("copy/record", [&]() { Value v(small); Bench::keep(v); });
+        run("copy/1000_records", [&]() { Value v(large); Bench::keep(v); });
+        Value moved = small;
+        run("move/record", [&]() {
+            Value v(std::move(moved));
+            moved = std::move(v);
+            Bench::keep(moved);
+        });
+        if (options.selected("destroy/record")) {
+            report("destroy/record", measure_destroy(small, 10000));
+        }
+        if (options.selected("destroy/1000_records")) {
+            report("destroy/1000_records", measure_destroy(large, 10));
+        }
+
+        // comparisons, the mixed numeric types go through numeric_equal
+        const Value u(uint64_t(1) << 40);
+        const Value u2(uint64_t(1) << 40);
+        const Value i64(int64_t(-123456));
+        const Value d(double(uint64_t(1) << 40));
+        const Value d_neg(-123456.0);
+        const Value string_copy(long_string);
+        const Value small_copy(small);
+        const Value large_copy(large);
+        run("equal/uint64", [&]() { Bench::keep(u == u2); });
+        run("equal/uint64_double", [&]() { Bench::keep(u == d); });
+        run("equal/int64_double", [&]() { Bench::keep(i64 == d_neg); });
+        run("equal/uint64_int64", [&]() { Bench::keep(u == i64); });
+        run("equal/string", [&]() { Bench::keep(string == string_copy); });
+        run("equal/record", [&]() { Bench::keep(small == small_copy); });
+        run("equal/1000_records", [&]() { Bench::keep(large == large_copy); });
+    } catch (std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+    return 0;
+}
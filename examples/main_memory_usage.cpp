@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include <mini_json/mini_json.h>
+
+static void print_row(const char *name, uint64_t bytes, uint64_t total, uint64_t documents)
+{
+    fprintf(stdout, "%-16s %14llu  %5.1f%%  %12.1f\n", name, (unsigned long long) bytes,
+            total != 0 ? 100.0 * double(bytes) / double(total) : 0.0,
+            documents != 0 ? double(bytes) / double(documents) : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    using namespace MiniJSON;
+
+    bool lines = false;
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-l") == 0) {
+        lines = true;
+        arg++;
+    }
+    if (arg + 1 < argc || (arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0')) {
+        fprintf(stderr, "Usage: %s [-l] [FILE]\n", argv[0]);
+        fprintf(stderr, "Print the memory footprint of the parsed document, by category.\n");
+        fprintf(stderr, "With -l, FILE is a JSON Lines file and the footprints of its documents are summed.\n");
+        return 2;
+    }
+
+    std::ifstream ifs;
+    if (arg < argc) {
+        ifs.open(argv[arg], std::ios_base::in | std::ios_base::binary);
+        if (!ifs.good()) {
+            fprintf(stderr, "Can't open file %s\n", argv[arg]);
+            return 200;
+        }
+    }
+    std::istream &is = arg < argc ? static_cast<std::istream &>(ifs) : std::cin;
+
+    try {
+        Parser parser;
+        Value::MemoryUsage usage{};
+        uint64_t documents = 0;
+        uint64_t text_bytes = 0;
+        if (lines) {
+            std::string line;
+            while (std::getline(is, line)) {
+                if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;
+                }
+                usage += parser.parse(line).memory_usage();
+                documents++;
+                text_bytes += line.size();
+            }
+        }
+        else {
+            std::string document((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+            usage = parser.parse(document).memory_usage();
+            documents = 1;
+            text_bytes = document.size();
+        }
+
+        const uint64_t total = usage.total();
+        fprintf(stdout, "%llu documents, %llu values, %llu bytes of text\n",
+                (unsigned long long) documents, (unsigned long long) usage.m_values, (unsigned long long) text_bytes);
+        fprintf(stdout, "%-16s %14s  %6s  %12s\n", "category", "bytes", "share", "per document");
+        print_row("values", usage.m_value_bytes, total, documents);
+        print_row("positions", usage.m_position_bytes, total, documents);
+        print_row("payloads", usage.m_payload_bytes, total, documents);
+        print_row("container nodes", usage.m_node_bytes, total, documents);
+        print_row("string bytes", usage.m_string_bytes, total, documents);
+        print_row("key bytes", usage.m_key_bytes, total, documents);
+        print_row("total", total, total, documents);
+        if (text_bytes != 0) {
+            fprintf(stdout, "%.2f bytes of memory per byte of text\n", double(total) / double(text_bytes));
+        }
+        return 0;
+    } catch (std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include <iostream>
+#include <fstream>
+
+#include <mini_json/mini_json.h>
+
+int main(int argc, char **argv)
+{
+    using namespace MiniJSON;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s 'FILTER' [FILE]\n", argv[0]);
+        fprintf(stderr, "Print the lines of a JSON Lines file matching FILTER, for instance:\n");
+        fprintf(stderr, "    %s '.level == \"error\" and .http.status >= 500' events.ndjson\n", argv[0]);
+        return 2;
+    }
+
+    try {
+        StreamFilter filter(argv[1]);
+        Parser parser;
+        StreamFilter::Stats stats;
+        if (argc > 2) {
+            std::ifstream ifs(argv[2], std::ios_base::in | std::ios_base::binary);
+            if (!ifs.good()) {
+                fprintf(stderr, "Can't open file %s\n", argv[2]);
+                return 200;
+            }
+            stats = filter.filter_lines(ifs, std::cout, parser);
+        }
+        else {
+            stats = filter.filter_lines(std::cin, std::cout, parser);
+        }
+        fprintf(stderr, "%llu lines, %llu matches, %llu malformed, %llu skipped by the prefilter\n",
+                (unsigned long long) stats.m_lines, (unsigned long long) stats.m_matches, (unsigned long long) stats.m_malformed,
+                (unsigned long long) stats.m_skipped);
+        return stats.m_matches != 0 ? 0 : 1;
+    } catch (std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+}
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <list>
 #include <functional>
+#include <vector>
 
 #include <mini_json/mini_json.h>
 #include <mini_json/utf_conv.h>
@@ -10,6 +11,8 @@
 /*
  * This is a tester program for the generator and parser.
  * It generates random JSON documents, parses them and compare the trees.
+ * It also checks that the JSON Patches computed between a document and a modified copy
+ * transform the first into the second, and that a failing patch leaves the document unchanged.
  */
 
 
@@ -88,6 +91,48 @@ public:
         return root;
     }
     
+    /**
+     * @brief Returns a modified copy of a value
+     * 
+     * Members and elements are removed, added or replaced at every level.
+     * 
+     * @param v value
+     * @return modified value
+     */
+    MiniJSON::Value mutate(const MiniJSON::Value &v) {
+        MiniJSON::Value ret(v);
+        mutate_in_place(ret);
+        return ret;
+    }
+    
+    /**
+     * @brief List the JSON Pointers of all the values of a document
+     * 
+     * @param v value
+     * @param path pointer to v
+     * @param paths receives the pointers
+     */
+    void collect_paths(const MiniJSON::Value &v, const std::string &path, std::vector<std::string> &paths) {
+        paths.push_back(path);
+        if (v.get_type() == MiniJSON::Type::Object) {
+            for (const auto &m : v.get<MiniJSON::Type::Object>()) {
+                collect_paths(m.second, path + "/" + MiniJSON::Pointer::escape(m.first), paths);
+            }
+        }
+        else if (v.get_type() == MiniJSON::Type::Array) {
+            size_t i = 0;
+            for (const auto &e : v.get<MiniJSON::Type::Array>()) {
+                collect_paths(e, path + "/" + std::to_string(i++), paths);
+            }
+        }
+    }
+    
+    /**
+     * @brief Returns a value in [0, n)
+     */
+    size_t below(size_t n) {
+        return std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+    }
     
 private:
     /**
@@ -238,18 +283,165 @@ private:
     }
     
     std::mt19937 rng;
+    
+    /**
+     * @brief Modify a value in place, see mutate()
+     * 
+     * @param v value
+     */
+    void mutate_in_place(MiniJSON::Value &v) {
+        if (v.get_type() == MiniJSON::Type::Object) {
+            MiniJSON::ObjectValues &map = v.get<MiniJSON::Type::Object>();
+            for (auto it = map.begin(); it != map.end();) {
+                const size_t r = below(10);
+                if (r == 0) {
+                    it = map.erase(it);
+                    continue;
+                }
+                if (r == 1) {
+                    it->second = gen_something(false);
+                }
+                else if (r > 6) {
+                    mutate_in_place(it->second);
+                }
+                ++it;
+            }
+            if (below(4) == 0) {
+                map.emplace("new" + std::to_string(below(100)), gen_something(false));
+            }
+        }
+        else if (v.get_type() == MiniJSON::Type::Array) {
+            MiniJSON::ArrayValues &list = v.get<MiniJSON::Type::Array>();
+            for (auto it = list.begin(); it != list.end();) {
+                const size_t r = below(10);
+                if (r == 0) {
+                    it = list.erase(it);
+                    continue;
+                }
+                if (r == 1) {
+                    list.insert(it, gen_something(false));
+                }
+                else if (r == 2) {
+                    *it = gen_something(false);
+                }
+                else if (r > 6) {
+                    mutate_in_place(*it);
+                }
+                ++it;
+            }
+            if (below(4) == 0) {
+                list.push_back(gen_something(false));
+            }
+        }
+        else if (below(4) == 0) {
+            v = gen_something(false);
+        }
+    }
 };
 
+/**
+ * @brief Check the JSON Patches on a document
+ * 
+ * @return false on error
+ */
+static bool check_patches(RandomJsonGenerator &rng, MiniJSON::Parser &parser, const MiniJSON::Value &json) {
+    using namespace MiniJSON;
+    
+    const Value changed = rng.mutate(json);
+    for (ArrayDiff arrays : {ArrayDiff::Positional, ArrayDiff::LCS}) {
+        Value patch = Patch::diff(json, changed, arrays);
+        Value patched = json;
+        Patch::apply(patched, patch);
+        if (patched != changed) {
+            puts(json.to_string().c_str());
+            puts(changed.to_string().c_str());
+            puts(patch.to_string().c_str());
+            return false;
+        }
+        // the last operation fails, the document is restored
+        patch.push_back(parser.parse(R"({"op": "test", "path": "", "value": "not the document"})"));
+        patched = json;
+        try {
+            Patch::apply(patched, patch);
+        }
+        catch (const PatchException &) {
+        }
+        if (patched != json) {
+            puts(json.to_string().c_str());
+            puts(patch.to_string().c_str());
+            return false;
+        }
+    }
+    
+    // a move between random locations: when it fails, the document is unchanged
+    std::vector<std::string> paths;
+    rng.collect_paths(json, "", paths);
+    Value move = Value::new_object();
+    move["op"] = Value(std::string("move"));
+    move["from"] = Value(paths[rng.below(paths.size())]);
+    move["path"] = Value(paths[rng.below(paths.size())] + (rng.below(2) == 0 ? "/x" : "/1"));
+    Value patch = Value::new_array();
+    patch.push_back(move);
+    for (bool atomic : {true, false}) {
+        Value patched = json;
+        try {
+            Patch::apply(patched, patch, atomic);
+        }
+        catch (const PatchException &) {
+            if (patched != json) {
+                puts(json.to_string().c_str());
+                puts(patch.to_string().c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check that the equal numbers hash equally, and that Value and Snapshot agree on the equality
+ * 
+ * The integers are taken around the powers of 2 above 2^53, where a double can't hold every integer.
+ * 
+ * @return false on error
+ */
+static bool check_numbers(RandomJsonGenerator &rng) {
+    using namespace MiniJSON;
+    
+    const int shift = 53 + int(rng.below(11));
+    const uint64_t u = (uint64_t(1) << shift) + rng.below(5) - 2;
+    const std::vector<Value> numbers = {Value(u), Value(int64_t(u)), Value(-int64_t(u)), Value(double(u)), Value(-double(u)),
+        Value(double(u) + 1.0), Value(uint64_t(double(u)))};
+    for (const Value &a : numbers) {
+        for (const Value &b : numbers) {
+            const bool equal = (a == b);
+            if ((equal && a.hash() != b.hash()) || equal != (Snapshot(a) == Snapshot(b))) {
+                printf("%s %s\n", a.to_string().c_str(), b.to_string().c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 int main() {
     using namespace MiniJSON;
     
+    // 2^53 + 1 is not equal to the double 2^53, whatever the direction of the conversion
+    const Value big(uint64_t(9007199254740993ULL));
+    const Value rounded(9007199254740992.0);
+    if (big == rounded || Snapshot(big) == Snapshot(rounded) || Value(-int64_t(9007199254740993LL)) == Value(-9007199254740992.0)) {
+        puts("an integer above 2^53 is equal to a rounded double");
+        return 1;
+    }
+    
     RandomJsonGenerator rng;
     Parser parser;
     while (true) {
         Value json = rng.gen_json(500);
         std::string doc = Generator::to_string(json);
         Value o = parser.parse(doc);
-        if (json != o) {
+        if (json != o || json.hash() != o.hash()) {
             puts(json.to_string().c_str());
             puts(o.to_string().c_str());
             break;
@@ -261,6 +453,12 @@ int main() {
             puts(o.to_string().c_str());
             break;
         }
+        if (!check_patches(rng, parser, json)) {
+            break;
+        }
+        if (!check_numbers(rng)) {
+            break;
+        }
     }
 
 }
@@ -46,26 +46,28 @@ int main() {
         const Value &v = Parser().parse(document);
         
         
-        if (!v.contains("menu")) {
+        const Value *menu = v.find("menu");
+        if (menu == nullptr) {
             return 1;
         }
-        const Value &menu = v["menu"];
-        if (!(menu.contains("header") && menu.contains("items"))) {
+        const std::pmr::string *header = menu->get_ptr<Type::String>("header");
+        const ArrayValues *items = menu->get_ptr<Type::Array>("items");
+        if (header == nullptr || items == nullptr) {
             return 1;
         }
         
-        std::cout << "header=" << menu["header"].get<Type::String>() << std::endl;
+        std::cout << "header=" << *header << std::endl;
         
-        const Value &items = menu["items"];
-        for (const Value &item : items.get<Type::Array>()) {
+        for (const Value &item : *items) {
             if (item.get_type() == Type::Null) {
                 continue;
             }
-            if (item.contains("label")) {
-                std::cout << "- id=" << item["id"].get<Type::String>() << ", label=" << item["label"].get<Type::String>() << ", position=" + position_to_string(item.get_position()) << std::endl;
+            const std::pmr::string id = item.get_or<Type::String>("id", "");
+            if (const std::pmr::string *label = item.get_ptr<Type::String>("label")) {
+                std::cout << "- id=" << id << ", label=" << *label << ", position=" + position_to_string(item.get_position()) << std::endl;
             }
             else {
-                std::cout << "- id=" << item["id"].get<Type::String>() << ", position=" + position_to_string(item.get_position()) << std::endl;
+                std::cout << "- id=" << id << ", position=" + position_to_string(item.get_position()) << std::endl;
             }
         }
     }
@@ -1,11 +1,941 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include <mini_json/mini_json.h>
 
+// Regression checks, run when no file is given
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// destroyed at exit, after the documents of the checks: the epoch domain must still be alive
+static MiniJSON::SharedDocument static_document(MiniJSON::Snapshot(MiniJSON::Parser().parse(R"({"n": 0})")));
+
+// readers see complete versions while a writer publishes, the old versions are freed once the readers leave
+static void check_shared_document()
+{
+    using namespace MiniJSON;
+
+    SharedDocument doc(Snapshot(Parser().parse(R"({"n": 0, "copy": 0})")));
+    std::atomic<bool> stop(false);
+    std::atomic<int> torn(0), backwards(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            uint64_t last = 0;
+            while (!stop.load()) {
+                auto r = doc.read();
+                const uint64_t n = (*r)["n"].get<Type::UInt64>();
+                torn += (n != (*r)["copy"].get<Type::UInt64>());
+                backwards += (n < last);
+                last = n;
+            }
+        });
+    }
+    for (uint64_t n = 1; n <= 2000; n++) {
+        doc.update([n](const Snapshot &cur) { return cur.set("n", Snapshot(n)).set("copy", Snapshot(n)); });
+    }
+    stop = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+    check(torn == 0, "shared document: a reader saw a partial update");
+    check(backwards == 0, "shared document: a reader saw an older version after a newer one");
+    check(doc.load()["n"].get<Type::UInt64>() == 2000 && doc.version() == 2000, "shared document: no update lost");
+
+    // a reader holding the current version keeps it alive, leaving the critical section frees it
+    {
+        auto r = static_document.read();
+        static_document.store(Snapshot(Parser().parse(R"({"n": 1})")));
+        check((*r)["n"].get<Type::UInt64>() == 0, "shared document: the reader keeps its version");
+        check(EpochDomain::instance().pending() != 0, "shared document: the old version is retired");
+    }
+    check(EpochDomain::instance().pending() == 0, "shared document: the old version is freed when the reader leaves");
+}
+
+// number of elements of the array selected by a filter
+static size_t query_count(const char *filter, const char *document)
+{
+    return MiniJSON::Query(std::string("$[?") + filter + "]").select(MiniJSON::Parser().parse(document)).size();
+}
+
+// the comparisons are exact above 2^53 and consistent with each other
+static void check_query_compare()
+{
+    const char *doc = R"([{"a": 9007199254740993, "b": 9007199254740992.0}, {"a": -9007199254740993, "b": -9007199254740992.0},
+        {"a": 18446744073709551615, "b": 18446744073709551616.0}, {"a": 3, "b": 2.5}, {"a": 3, "b": 3.0}])";
+    check(query_count("@.a == @.b", doc) == 1, "query: == above 2^53");
+    check(query_count("@.a > @.b", doc) == 2, "query: > above 2^53");
+    check(query_count("@.a < @.b", doc) == 2, "query: < above 2^53");
+    check(query_count("@.a >= @.b", doc) == 3, "query: >= above 2^53");
+    check(query_count("@.a <= @.b", doc) == 3, "query: <= above 2^53");
+    check(query_count("@.a >= @.b && @.a <= @.b && @.a != @.b", doc) == 0, "query: >= and <= imply ==");
+    check(query_count("@.a <= \"x\"", doc) == 0, "query: <= between a number and a string");
+}
+
+static bool filter_matches(const char *expression, const char *document)
+{
+    MiniJSON::Parser parser;
+    return MiniJSON::StreamFilter(expression).evaluate(document, parser) == MiniJSON::StreamFilter::Match;
+}
+
+static void check_stream_filter()
+{
+    // the parser keeps the last occurrence of a repeated key
+    check(!filter_matches(".a == 2", R"({"a":1,"a":2})"), "filter: repeated key on a clause path, last occurrence true");
+    check(!filter_matches(".a == 1", R"({"a":1,"a":2})"), "filter: repeated key on a clause path, first occurrence true");
+    check(!filter_matches(".a.b == 1", R"({"a":{"b":1},"a":{"c":2}})"), "filter: repeated parent key of a clause path");
+    check(!filter_matches(".a.b == 1", R"({"a":{"b":1,"b":1}})"), "filter: repeated key with equal values");
+    check(filter_matches(".a == 1", R"({"a":1,"b":2,"b":3})"), "filter: repeated key outside of the clause paths");
+    check(filter_matches(".a.b == 1", R"({"a":{"b":1},"c":{"b":2,"b":3}})"), "filter: repeated key in a sibling object");
+    check(filter_matches(".a[1] == 2", R"({"a":[{"x":1,"x":1},2]})"), "filter: repeated key in another array element");
+}
+
+// random ECMAScript patterns over a small alphabet, the regex engine is compared with std::regex
+static std::string random_pattern(std::mt19937 &rng, int depth)
+{
+    static const char *const atoms[] = {"a", "b", "c", ".", "[ab]", "[^a]", "\\d", "\\w", "\\b"};
+    static const char *const quantifiers[] = {"*", "+", "?", "{1,2}", "{2}", "*?", "", ""};
+    std::string s;
+    const unsigned n = 1 + rng() % 3;
+    for (unsigned i = 0; i < n; i++) {
+        const unsigned a = rng() % (depth > 2 ? 9 : 11);
+        if (a < 9) {
+            s += atoms[a];
+        }
+        else {
+            s += (a == 9 ? "(" : "(?:") + random_pattern(rng, depth + 1) + ")";
+        }
+        s += quantifiers[rng() % 8];
+    }
+    if (rng() % 4 == 0) {
+        s += "|" + random_pattern(rng, depth + 1);
+    }
+    return s;
+}
+
+static void check_regex()
+{
+    using namespace MiniJSON;
+
+    std::mt19937 rng(7);
+    int mismatches = 0;
+    for (int t = 0; t < 500; t++) {
+        const std::string pattern = (rng() % 4 == 0 ? "^" : "") + random_pattern(rng, 0) + (rng() % 4 == 0 ? "$" : "");
+        std::regex reference;
+        try {
+            reference = std::regex(pattern, std::regex::ECMAScript);
+        }
+        catch (const std::regex_error &) {
+            // a quantified assertion, rejected by some implementations
+            continue;
+        }
+        const Regex regex(pattern);
+        for (int k = 0; k < 10; k++) {
+            std::string subject;
+            for (unsigned i = 0, len = rng() % 8; i < len; i++) {
+                subject += "abc1 _\n"[rng() % 7];
+            }
+            mismatches += (std::regex_search(subject, reference) != regex.search(subject));
+        }
+    }
+    check(mismatches == 0, "regex: same results as std::regex");
+
+    // the syntax of the schema patterns, matched on code points
+    static const struct {
+        const char *m_pattern;
+        const char *m_subject;
+        bool m_match;
+    } cases[] = {
+        {"^caf\\u00e9$", "caf\xc3\xa9", true}, {"^.$", "\xc3\xa9", true}, {"^\\uD83D\\uDE00$", "\xf0\x9f\x98\x80", true},
+        {"^a{2,3}$", "aaaa", false}, {"x{", "x{", true}, {"[\\d-z]", "-", true}, {"[]", "a", false}, {"[^]", "\n", true},
+        {"\\cJ", "\n", true}, {"(?<name>ab)+", "abab", true}, {"\\bfoo\\b", "afoo", false}, {"^.$", "\xff", true},
+    };
+    for (const auto &c : cases) {
+        const std::string name = std::string("regex: ") + c.m_pattern;
+        check(Regex(c.m_pattern).search(c.m_subject) == c.m_match, name.c_str());
+    }
+    for (const char *pattern : {"(", "a**", "(?=a)", "(?<=a)b", "(a)\\1", "[b-a]", "a{3,2}", "a{100000}", "\\k<n>"}) {
+        bool rejected = false;
+        try {
+            Regex r(pattern);
+        }
+        catch (const RegexException &) {
+            rejected = true;
+        }
+        const std::string name = std::string("regex: rejects ") + pattern;
+        check(rejected, name.c_str());
+    }
+}
+
+// validate a document with both entry points, returns -1 if they disagree
+static int schema_validates(const MiniJSON::Schema &schema, const std::string &document)
+{
+    MiniJSON::Parser parser;
+    const bool dom = schema.validate(parser.parse(document));
+    const bool events = schema.validate(document, parser);
+    return dom != events ? -1 : dom;
+}
+
+static void check_schema_pattern()
+{
+    using namespace MiniJSON;
+
+    // the search is linear, without recursion: no stack overflow nor exponential time
+    const Schema schema(Parser().parse(R"({"pattern": "^(a|b)*$"})"));
+    const std::string long_string(200000, 'a');
+    check(schema_validates(schema, "\"" + long_string + "\"") == 1, "schema: pattern on a long string");
+    check(schema_validates(schema, "\"" + long_string + "c\"") == 0, "schema: pattern on a long string, no match");
+    const Schema nested(Parser().parse(R"({"pattern": "^(a+)+$"})"));
+    check(schema_validates(nested, "\"" + std::string(10000, 'a') + "!\"") == 0, "schema: nested quantifiers");
+
+    // the pattern is matched on the code points
+    const Schema unicode(Parser().parse(R"({"pattern": "^.\\u00e9[\\u00e0-\\u00ff]$"})"));
+    check(schema_validates(unicode, "\"x\\u00e9\\u00e0\"") == 1, "schema: pattern on code points");
+
+    bool rejected = false;
+    try {
+        Schema(Parser().parse(R"({"pattern": "(a)\\1"})"));
+    }
+    catch (const SchemaException &) {
+        rejected = true;
+    }
+    check(rejected, "schema: backreferences are rejected");
+}
+
+static void check_schema_duplicates()
+{
+    using namespace MiniJSON;
+
+    // Parser keeps the last occurrence of a repeated key, both entry points must agree
+    const Schema schema(Parser().parse(R"({"properties": {"id": {"minimum": 1}}, "maxProperties": 1})"));
+    check(schema_validates(schema, R"({"id": 0, "id": 1})") == 1, "schema: repeated key, the last occurrence is valid");
+    check(schema_validates(schema, R"({"id": 1, "id": 0})") == 0, "schema: repeated key, the last occurrence is invalid");
+    check(schema_validates(schema, R"({"id": 1, "id": 2})") == 1, "schema: repeated key counted once");
+    const Schema min(Parser().parse(R"({"minProperties": 2})"));
+    check(schema_validates(min, R"({"a": 1, "a": 2})") == 0, "schema: repeated key counted once for minProperties");
+    const Schema nested(Parser().parse(R"({"items": {"properties": {"a": {"properties": {"b": {"type": "string"}}}}}})"));
+    check(schema_validates(nested, R"([{"a": {"b": 1}, "a": {"b": "x"}}])") == 1, "schema: repeated parent key");
+    check(schema_validates(nested, R"([{"a": {"b": 1, "c": 2}, "x": {"a": 1}}])") == 0, "schema: same key in another object");
+}
+
+// the pointer of the error reported by both entry points, "" if they disagree
+static std::string schema_error(const char *schema, const char *document)
+{
+    MiniJSON::Parser parser;
+    const MiniJSON::Schema compiled(parser.parse(schema));
+    MiniJSON::ValidationError dom, events;
+    compiled.validate(parser.parse(document), &dom);
+    compiled.validate(document, parser, &events);
+    return dom.m_pointer == events.m_pointer && dom.m_message == events.m_message ? dom.m_pointer : "";
+}
+
+static void check_schema_error_order()
+{
+    // both entry points report the first error in the order of the document, not of the keys
+    const char *schema = R"({"properties": {"a": {"type": "string"}, "b": {"type": "string"}, "c": {"items": {"maximum": 1}}}})";
+    check(schema_error(schema, R"({"b": 1, "a": 2})") == "/b", "schema: first error in document order");
+    check(schema_error(schema, R"({"a": 2, "b": 1})") == "/a", "schema: first error in document order, sorted keys");
+    check(schema_error(schema, R"({"c": [0, 2], "b": 1, "a": 2})") == "/c/1", "schema: first error in a nested value");
+    check(schema_error(R"({"properties": {"x": {"properties": {"b": {"type": "string"}, "a": {"type": "string"}}}}, "required": ["y"]})",
+        R"({"x": {"b": 0, "a": 0}})") == "/x/b", "schema: first error before the required properties");
+}
+
+// apply a patch, returns the document or "error"
+static std::string patched(const char *document, const char *patch, bool atomic = true)
+{
+    MiniJSON::Parser parser;
+    MiniJSON::Value doc = parser.parse(document);
+    try {
+        MiniJSON::Patch::apply(doc, parser.parse(patch), atomic);
+    }
+    catch (const MiniJSON::PatchException &) {
+        return "error";
+    }
+    return MiniJSON::Generator::to_string(doc);
+}
+
+static bool same_json(const std::string &a, const char *b)
+{
+    MiniJSON::Parser parser;
+    return a == b || (a != "error" && strcmp(b, "error") != 0 && parser.parse(a) == parser.parse(b));
+}
+
+static void check_patch()
+{
+    // the examples of the appendix A of RFC 6902
+    static const struct {
+        const char *m_name;
+        const char *m_doc;
+        const char *m_patch;
+        const char *m_result;
+    } examples[] = {
+        {"A.1", R"({"foo": "bar"})", R"([{"op": "add", "path": "/baz", "value": "qux"}])", R"({"baz": "qux", "foo": "bar"})"},
+        {"A.2", R"({"foo": ["bar", "baz"]})", R"([{"op": "add", "path": "/foo/1", "value": "qux"}])", R"({"foo": ["bar", "qux", "baz"]})"},
+        {"A.3", R"({"baz": "qux", "foo": "bar"})", R"([{"op": "remove", "path": "/baz"}])", R"({"foo": "bar"})"},
+        {"A.4", R"({"foo": ["bar", "qux", "baz"]})", R"([{"op": "remove", "path": "/foo/1"}])", R"({"foo": ["bar", "baz"]})"},
+        {"A.5", R"({"baz": "qux", "foo": "bar"})", R"([{"op": "replace", "path": "/baz", "value": "boo"}])", R"({"baz": "boo", "foo": "bar"})"},
+        {"A.6", R"({"foo": {"bar": "baz", "waldo": "fred"}, "qux": {"corge": "grault"}})",
+            R"([{"op": "move", "from": "/foo/waldo", "path": "/qux/thud"}])",
+            R"({"foo": {"bar": "baz"}, "qux": {"corge": "grault", "thud": "fred"}})"},
+        {"A.7", R"({"foo": ["all", "grass", "cows", "eat"]})", R"([{"op": "move", "from": "/foo/1", "path": "/foo/3"}])",
+            R"({"foo": ["all", "cows", "eat", "grass"]})"},
+        {"A.8", R"({"baz": "qux", "foo": ["a", 2, "c"]})",
+            R"([{"op": "test", "path": "/baz", "value": "qux"}, {"op": "test", "path": "/foo/1", "value": 2}])",
+            R"({"baz": "qux", "foo": ["a", 2, "c"]})"},
+        {"A.9", R"({"baz": "qux"})", R"([{"op": "test", "path": "/baz", "value": "bar"}])", "error"},
+        {"A.10", R"({"foo": "bar"})", R"([{"op": "add", "path": "/child", "value": {"grandchild": {}}}])",
+            R"({"foo": "bar", "child": {"grandchild": {}}})"},
+        {"A.11", R"({"foo": "bar"})", R"([{"op": "add", "path": "/baz", "value": "qux", "xyz": 123}])", R"({"foo": "bar", "baz": "qux"})"},
+        {"A.12", R"({"foo": "bar"})", R"([{"op": "add", "path": "/baz/bat", "value": "qux"}])", "error"},
+        {"A.14", R"({"/": 9, "~1": 10})", R"([{"op": "test", "path": "/~01", "value": 10}])", R"({"/": 9, "~1": 10})"},
+        {"A.15", R"({"/": 9, "~1": 10})", R"([{"op": "test", "path": "/~01", "value": "10"}])", "error"},
+        {"A.16", R"({"foo": ["bar"]})", R"([{"op": "add", "path": "/foo/-", "value": ["abc", "def"]}])", R"({"foo": ["bar", ["abc", "def"]]})"},
+    };
+    for (const auto &e : examples) {
+        const std::string name = std::string("patch: RFC 6902 ") + e.m_name;
+        check(same_json(patched(e.m_doc, e.m_patch), e.m_result), name.c_str());
+    }
+
+    // a move whose target is invalid leaves the document unchanged
+    const char *doc = R"({"a": {"big": [1, 2, 3]}, "b": 1})";
+    for (bool atomic : {true, false}) {
+        check(patched(doc, R"([{"op": "move", "from": "/a", "path": "/nope/x"}])", atomic) == "error", "patch: move to a missing parent");
+        check(same_json(patched(doc, R"([{"op": "move", "from": "/a", "path": "/nope/x"}, {"op": "test", "path": "/a/big/2", "value": 3}])", atomic), "error"),
+              "patch: move to a missing parent, then test");
+        MiniJSON::Parser parser;
+        MiniJSON::Value v = parser.parse(doc);
+        for (const char *target : {"/nope/x", "/b/5", "/a/big/7"}) {
+            const std::string patch = std::string(R"([{"op": "move", "from": "/a/big/0", "path": ")") + target + "\"}]";
+            MiniJSON::Value d = v;
+            try {
+                MiniJSON::Patch::apply(d, parser.parse(patch), atomic);
+            }
+            catch (const MiniJSON::PatchException &) {
+            }
+            check(d == v, "patch: a failed move leaves the document unchanged");
+        }
+        MiniJSON::Value d = v;
+        try {
+            MiniJSON::Patch::apply(d, parser.parse(R"([{"op": "move", "from": "/a", "path": "/b/5"}])"), atomic);
+        }
+        catch (const MiniJSON::PatchException &) {
+        }
+        check(d == v, "patch: move to a scalar parent");
+    }
+}
+
+// the floating point numbers of a static document are correctly rounded
+MINI_JSON_STATIC_DOCUMENT(static_numbers, R"([1.7976931348623157e308, 2.4703282292062328e-324, 2.4703282292062327e-324, 9007199254740993.0])");
+static_assert(static_numbers.root()[0].get<MiniJSON::Type::Double>() == 1.7976931348623157e308, "DBL_MAX");
+static_assert(static_numbers.root()[1].get<MiniJSON::Type::Double>() == 5e-324, "above the half of the smallest subnormal");
+static_assert(static_numbers.root()[2].get<MiniJSON::Type::Double>() == 0.0, "below the half of the smallest subnormal");
+static_assert(static_numbers.root()[3].get<MiniJSON::Type::Double>() == 9007199254740992.0, "tie to even");
+
+static void check_static_numbers()
+{
+    // the static parser agrees with strtod() and with Parser on the numbers far from the fast path
+    static const char *const literals[] = {"2e-310", "4.9e-324", "-2.4703282292062328e-324","2.2250738585072011e-308", "2.2250738585072012e-308", "4.9406564584124654e-324",
+        "8.98846567431158e307", "1e23", "7.2057594037927933e16", "3.141592653589793238462643383279502884197169399375105820974944",
+        "1.00000000000000011102230246251565404236316680908203125", "1.00000000000000011102230246251565404236316680908203124",
+        "0.000000000000000000000000000000000000000000000000000000000000000000000000000000000000001e-250",
+        "123456789012345678901234567890.5e-40", "1e-400"};
+    for (const char *l : literals) {
+        const std::string_view text(l);
+        const MiniJSON::StaticParser::Size size = MiniJSON::StaticParser::measure(text);
+        std::vector<MiniJSON::StaticNode> nodes(size.m_nodes);
+        std::vector<char> strings(size.m_bytes + 1);
+        MiniJSON::StaticParser(text, nodes.data(), strings.data()).parse();
+        const std::string name = std::string("static document: ") + l;
+        check(nodes[0].m_double == strtod(l, nullptr), name.c_str());
+        check(nodes[0].m_double == MiniJSON::Parser().parse(l).get<MiniJSON::Type::Double>(), name.c_str());
+    }
+
+    // both parsers reject the numbers too large for a double
+    for (const char *l : {"1e309", "-1.8e308", "[1, 1.7976931348623159e308]"}) {
+        bool static_rejected = false, parser_rejected = false;
+        const std::string_view text(l);
+        try {
+            MiniJSON::StaticParser::measure(text);
+        }
+        catch (const MiniJSON::MalFormedException &) {
+            static_rejected = true;
+        }
+        try {
+            MiniJSON::Parser().parse(l);
+        }
+        catch (const MiniJSON::MalFormedException &) {
+            parser_rejected = true;
+        }
+        const std::string name = std::string("static document: overflow of ") + std::string(text.substr(0, 16));
+        check(static_rejected && parser_rejected, name.c_str());
+    }
+}
+
+// the background deleter only frees on its thread the values of thread-safe resources
+static void check_background_deleter()
+{
+    const char *doc = R"({"a": [1, 2, {"b": "a string too long for the small string buffer"}], "c": {}})";
+    MiniJSON::BackgroundDeleter deleter;
+    std::pmr::unsynchronized_pool_resource pool;
+    for (int i = 0; i < 100; i++) {
+        MiniJSON::Value v = MiniJSON::Parser().parse(doc, &pool);
+        deleter.dispose(std::move(v));
+        check(deleter.pending() == 0, "background deleter: unsynchronized resource destroyed inline");
+    }
+    std::pmr::synchronized_pool_resource shared;
+    std::pmr::monotonic_buffer_resource declared;
+    deleter.add_thread_safe_resource(&declared);
+    for (int i = 0; i < 100; i++) {
+        deleter.dispose(MiniJSON::Parser().parse(doc, &shared));
+        deleter.dispose(MiniJSON::Parser().parse(doc, std::pmr::new_delete_resource()));
+    }
+    deleter.dispose(MiniJSON::Parser().parse(doc, &declared));
+    deleter.flush();
+    check(deleter.pending() == 0, "background deleter: flush");
+}
+
+// the long strings and keys are allocated from the resource of the document, and copied with it
+static void check_string_resource()
+{
+    using namespace MiniJSON;
+
+    static char buffer[1 << 16];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    auto in_arena = [](const std::pmr::string &s) {
+        return s.data() >= buffer && s.data() < buffer + sizeof(buffer);
+    };
+    const char *doc = R"({"a key too long for the small string buffer": ["a string too long for the small string buffer"]})";
+    try {
+        Value v = Parser().parse(doc, &arena);
+        const auto &map = v.get<Type::Object>();
+        check(in_arena(map.begin()->first), "string resource: key");
+        check(in_arena(map.begin()->second.get<Type::Array>().front().get<Type::String>()), "string resource: string");
+
+        std::pmr::monotonic_buffer_resource other;
+        Value copy(v, &other);
+        check(!in_arena(copy.get<Type::Object>().begin()->first), "string resource: copied key");
+        check(!in_arena(copy.get<Type::Object>().begin()->second.get<Type::Array>().front().get<Type::String>()), "string resource: copied string");
+        check(copy == v, "string resource: copy");
+    }
+    catch (const std::bad_alloc &) {
+        check(false, "string resource: allocation outside of the resource");
+    }
+}
+
+// the statistics policies count the parsed values, and take no room in a parser without statistics
+static void check_parser_stats()
+{
+    using namespace MiniJSON;
+
+    static_assert(std::is_empty_v<NoStats>, "NoStats has no storage");
+    static_assert(sizeof(Parser) < sizeof(BasicParser<CountStats>), "Parser has no statistics");
+
+    const char *doc = R"({"a": [1, -2, 3.5, "x\u00e9", true, null], "b": {"c": {}}})";
+    BasicParser<CountStats> counting;
+    counting.parse(doc);
+    const ParserStats &stats = counting.get_stats();
+    check(stats.m_documents == 1 && stats.m_bytes == strlen(doc), "parser stats: documents and bytes");
+    check(stats.m_uint64s == 1 && stats.m_int64s == 1 && stats.m_doubles == 1, "parser stats: numbers");
+    check(stats.m_strings == 1 && stats.m_booleans == 1 && stats.m_nulls == 1, "parser stats: scalars");
+    check(stats.m_objects == 3 && stats.m_arrays == 1 && stats.m_keys == 3, "parser stats: containers");
+    check(stats.m_escaped_strings == 1 && stats.m_non_ascii == 1, "parser stats: escapes");
+    check(stats.m_max_depth == 3, "parser stats: depth");
+    check(stats.m_container_ns == 0, "parser stats: no timings");
+
+    // the other users of a parser accept any policy
+    Schema schema(counting.parse(R"({"type": "object"})"));
+    check(schema.validate(doc, counting), "parser stats: schema");
+    check(counting.get_stats().m_documents == 3, "parser stats: accumulated");
+    counting.reset_stats();
+    check(counting.get_stats().m_documents == 0, "parser stats: reset");
+
+    BasicParser<TimedStats> timed;
+    for (int i = 0; i < 100; i++) {
+        timed.parse(doc);
+    }
+    const ParserStats &timings = timed.get_stats();
+    check(timings.m_documents == 100 && timings.m_keys == 300, "parser stats: timed counters");
+    check(timings.m_container_ns + timings.m_string_ns + timings.m_number_ns + timings.m_literal_ns + timings.m_whitespace_ns > 0,
+          "parser stats: timings");
+}
+
+// the modifications of a Snapshot return a new version, the original is unchanged and the untouched children are shared
+static void check_snapshot()
+{
+    using namespace MiniJSON;
+
+    const Snapshot doc(Parser().parse(R"({"a": {"x": 1}, "b": [1, 2, 3], "c": "s"})"));
+    const std::string before = doc.to_string();
+
+    const Snapshot set = doc.set("c", Snapshot(2));
+    check(doc.to_string() == before, "snapshot: set leaves the original unchanged");
+    check(same_json(set.to_string(), R"({"a": {"x": 1}, "b": [1, 2, 3], "c": 2})"), "snapshot: set");
+    check(set["a"].is_same(doc["a"]) && set["b"].is_same(doc["b"]), "snapshot: set shares the other members");
+
+    const Snapshot added = doc.set("d", Snapshot::new_array());
+    check(added.size() == 4 && doc.size() == 3 && !doc.contains("d"), "snapshot: set adds a member");
+
+    const Snapshot erased = doc.erase("a");
+    check(doc.contains("a") && !erased.contains("a"), "snapshot: erase");
+    check(erased["b"].is_same(doc["b"]), "snapshot: erase shares the other members");
+    check(doc.erase("missing").is_same(doc), "snapshot: erase of a missing key shares the node");
+
+    const Snapshot &list = doc["b"];
+    check(same_json(list.set(1, Snapshot("x")).to_string(), R"([1, "x", 3])"), "snapshot: array set");
+    check(same_json(list.insert(0, Snapshot(0)).to_string(), "[0, 1, 2, 3]"), "snapshot: array insert");
+    check(same_json(list.push_back(Snapshot(4)).to_string(), "[1, 2, 3, 4]"), "snapshot: array push_back");
+    check(same_json(list.erase(2).to_string(), "[1, 2]"), "snapshot: array erase");
+    check(same_json(list.to_string(), "[1, 2, 3]"), "snapshot: array unchanged");
+
+    // a nested modification copies the path to the root only
+    const Snapshot nested = doc.set("a", doc["a"].set("x", Snapshot(2)));
+    check(doc["a"]["x"] == Snapshot(1) && nested["a"]["x"] == Snapshot(2), "snapshot: nested set");
+    check(nested["b"].is_same(doc["b"]) && nested["c"].is_same(doc["c"]), "snapshot: nested set shares the siblings");
+
+    check(Snapshot(doc.to_value()) == doc && doc.hash() == Snapshot(doc.to_value()).hash(), "snapshot: round trip");
+    check(set != doc, "snapshot: inequality");
+}
+
+// the identical subtrees of the interned documents share a single node, only if they are strictly identical
+static void check_interner()
+{
+    using namespace MiniJSON;
+
+    Interner interner;
+    Parser parser;
+    const Snapshot a = interner.intern(parser.parse(R"({"address": {"city": "Paris", "zip": "75001"}, "id": 1})"));
+    const Snapshot b = interner.parse(R"({"id": 2, "address": {"zip": "75001", "city": "Paris"}})", parser);
+    check(a["address"].is_same(b["address"]), "interner: shared subtree");
+    check(!a["id"].is_same(b["id"]), "interner: distinct values");
+
+    // the types must be the same, the positions are ignored
+    const Snapshot c = interner.parse(R"([1, 1.0, 1, "1"])", parser);
+    check(c[0].is_same(c[2]) && c[0].is_same(a["id"]), "interner: identical scalars");
+    check(!c[0].is_same(c[1]) && !c[0].is_same(c[3]), "interner: different types");
+
+    // interning again returns the canonical nodes, a copy of a document is canonical
+    check(interner.intern(Snapshot(parser.parse(R"({"zip": "75001", "city": "Paris"})"))).is_same(a["address"]),
+          "interner: canonical node");
+    const size_t size = interner.size();
+    check(interner.intern(a).is_same(a) && interner.size() == size, "interner: interned document");
+
+    // the nodes referenced only by the table are collected
+    interner.parse(R"({"unused": [true, false]})", parser);
+    check(interner.collect() > 0 && interner.size() == size, "interner: collect");
+    check(interner.intern(b).is_same(b), "interner: collect keeps the referenced nodes");
+}
+
+// the keys interned in the same table share their entry, in the documents of all the interners using it
+static void check_key_table()
+{
+    using namespace MiniJSON;
+
+    KeyTable keys;
+    check(keys.intern("name").is_same(keys.intern(std::string("name"))) && keys.size() == 1, "key table: same entry");
+    check(keys.intern("name") == Key("name") && !keys.intern("name").is_same(Key("name")), "key table: equality");
+    check(Key("name").hash() == std::hash<std::string_view>()("name"), "key table: hash");
+
+    Parser parser;
+    const Value v = parser.parse(R"({"name": "a", "tags": [{"name": "b"}]})");
+    const Snapshot a(v, keys);
+    Interner first(&keys), second(&keys);
+    const Snapshot b = first.parse(R"({"name": "c"})", parser);
+    const Snapshot c = second.intern(parser.parse(R"({"other": {"name": "d"}})"));
+    const Key &key = a.get<Type::Object>().front().first;
+    check(key.is_same(a["tags"][0].get<Type::Object>().front().first), "key table: shared in a document");
+    check(key.is_same(b.get<Type::Object>().front().first), "key table: shared with an interner");
+    check(key.is_same(c["other"].get<Type::Object>().front().first), "key table: shared between interners");
+    check(a[key] == Snapshot("a") && c["other"][keys.intern("name")] == Snapshot("d"), "key table: lookup by key");
+    check(keys.size() == 3, "key table: size");
+}
+
+static bool pointer_rejected(const char *text)
+{
+    try {
+        MiniJSON::Pointer p(text);
+        return false;
+    }
+    catch (const MiniJSON::PointerSyntaxException &) {
+        return true;
+    }
+}
+
+// the pointers unescape their tokens, "~1" before "~0", and resolve them in Values and Snapshots
+static void check_pointer()
+{
+    using namespace MiniJSON;
+
+    check(Pointer::escape("a/b~c") == "a~1b~0c" && Pointer::escape("~1") == "~01", "pointer: escape");
+    const Pointer p("/a~1b/m~0n/~01/1");
+    check(p.size() == 4 && p.tokens()[0].key().view() == "a/b" && p.tokens()[1].key().view() == "m~n", "pointer: unescape");
+    check(p.tokens()[2].key().view() == "~1", "pointer: ~01 is ~1, not /");
+    check(p.tokens()[3].index() == 1 && p.tokens()[0].index() == Pointer::Token::NOT_AN_INDEX, "pointer: index");
+    check(Pointer("/01").tokens()[0].index() == Pointer::Token::NOT_AN_INDEX && Pointer("/-").tokens()[0].is_end(),
+          "pointer: leading zero and end");
+    check(p.to_string() == "/a~1b/m~0n/~01/1" && Pointer(p.to_string()) == p, "pointer: round trip");
+    check(Pointer("").empty() && Pointer("/").tokens()[0].key().view().empty(), "pointer: empty pointer and key");
+    check(p.parent().child(1) == p && Pointer().child("a/b").to_string() == "/a~1b", "pointer: parent and child");
+    check(pointer_rejected("a") && pointer_rejected("/~") && pointer_rejected("/~2"), "pointer: syntax errors");
+
+    const Value doc = Parser().parse(R"({"a/b": {"m~n": {"~1": [10, 20]}}, "": 0})");
+    const Value *v = p.resolve(doc);
+    check(v != nullptr && v->get<Type::UInt64>() == 20, "pointer: resolve a Value");
+    const Snapshot snap(doc);
+    const Snapshot *s = p.resolve(snap);
+    check(s != nullptr && *s == Snapshot(20), "pointer: resolve a Snapshot");
+    check(Pointer("/").resolve(doc) != nullptr && Pointer("").resolve(doc) == &doc, "pointer: resolve the empty key and the root");
+    check(Pointer("/a~1b/m~0n/~01/2").resolve(doc) == nullptr && Pointer("/a~1b/m~0n/~01/-").resolve(doc) == nullptr,
+          "pointer: out of range");
+    check(Pointer("/x").resolve(doc) == nullptr && Pointer("/a~1b/m~0n/~01/0/x").resolve(snap) == nullptr, "pointer: missing");
+}
+
+// bound types of the binding checks
+struct TestAddress {
+    std::string city;
+    uint16_t zip = 0;
+};
+
+struct TestPerson {
+    std::string name;
+    std::optional<int32_t> age;
+    std::vector<std::string> tags;
+    TestAddress address;
+    std::map<std::string, double> scores;
+    bool active = false;
+};
+
+template<> struct MiniJSON::Binding<TestAddress> {
+    static constexpr auto fields = std::make_tuple(
+        MINI_JSON_FIELD(TestAddress, city),
+        MINI_JSON_FIELD(TestAddress, zip));
+};
+
+template<> struct MiniJSON::Binding<TestPerson> {
+    static constexpr auto fields = std::make_tuple(
+        MINI_JSON_FIELD(TestPerson, name),
+        MiniJSON::field("age_years", &TestPerson::age),
+        MINI_JSON_FIELD(TestPerson, tags),
+        MINI_JSON_FIELD(TestPerson, address),
+        MINI_JSON_FIELD(TestPerson, scores),
+        MINI_JSON_FIELD(TestPerson, active));
+};
+
+static bool same_person(const TestPerson &a, const TestPerson &b)
+{
+    return a.name == b.name && a.age == b.age && a.tags == b.tags && a.address.city == b.address.city &&
+        a.address.zip == b.address.zip && a.scores == b.scores && a.active == b.active;
+}
+
+static bool binding_rejected(const char *document)
+{
+    try {
+        MiniJSON::Parser parser;
+        MiniJSON::Binder::decode<TestPerson>(document, parser);
+        return false;
+    }
+    catch (const MiniJSON::BindingException &) {
+        return true;
+    }
+}
+
+// the documents are decoded into the bound members, the encoding is the reverse
+static void check_binder()
+{
+    using namespace MiniJSON;
+
+    Parser parser;
+    const TestPerson p = Binder::decode<TestPerson>(R"({"name": "Ann", "age_years": 41, "tags": ["a", "b"], "unknown": {"x": [1]},
+        "address": {"zip": 7500, "city": "Paris"}, "scores": {"x": 1.5, "y": 2}, "active": true})", parser);
+    check(p.name == "Ann" && p.age == 41 && p.tags == std::vector<std::string>{"a", "b"}, "binder: members");
+    check(p.address.city == "Paris" && p.address.zip == 7500, "binder: nested struct");
+    check(p.scores.size() == 2 && p.scores.at("y") == 2.0 && p.active, "binder: map and bool");
+
+    // the missing members keep their value, null resets an optional, the containers are cleared
+    TestPerson q = p;
+    Binder::decode(R"({"age_years": null, "tags": ["c"]})", parser, q);
+    check(q.name == "Ann" && !q.age && q.tags == std::vector<std::string>{"c"} && q.address.zip == 7500, "binder: partial decode");
+
+    const Value encoded = Binder::encode(p);
+    check(!encoded.contains("age") && encoded["age_years"].get<Type::Int64>() == 41, "binder: encoded key");
+    check(same_person(Binder::decode<TestPerson>(Binder::to_string(p), parser), p), "binder: round trip");
+    check(!Binder::encode(q).contains("age_years"), "binder: empty optional not encoded");
+
+    check(binding_rejected(R"({"name": 1})"), "binder: type mismatch");
+    check(binding_rejected(R"({"address": {"zip": 70000}})"), "binder: integer out of range");
+    check(binding_rejected(R"({"address": {"zip": -1}})"), "binder: negative unsigned");
+    check(binding_rejected(R"({"tags": ["a", 2]})"), "binder: element type mismatch");
+    check(binding_rejected(R"([])"), "binder: not an object");
+}
+
+// decodes a document with both paths: the results, or the kinds of failure, must be the same
+static bool same_decoding(MiniJSON::ShapeParser<TestPerson> &shape, const std::string &document)
+{
+    MiniJSON::Parser parser;
+    TestPerson fast, generic;
+    int fast_error = 0, generic_error = 0;
+    try {
+        shape.decode(document, fast);
+    }
+    catch (const MiniJSON::BindingException &) {
+        fast_error = 1;
+    }
+    catch (const std::exception &) {
+        fast_error = 2;
+    }
+    try {
+        MiniJSON::Binder::decode(document, parser, generic);
+    }
+    catch (const MiniJSON::BindingException &) {
+        generic_error = 1;
+    }
+    catch (const std::exception &) {
+        generic_error = 2;
+    }
+    return fast_error == generic_error && (fast_error != 0 || same_person(fast, generic));
+}
+
+// the parser specialized for a bound type decodes as Binder::decode, on its fast path or not
+static void check_shape_parser()
+{
+    MiniJSON::ShapeParser<TestPerson> shape;
+    const char *documents[] = {
+        R"({"name": "Ann", "age_years": 41, "tags": ["a", "b"], "address": {"city": "Paris", "zip": 7500}, "scores": {"x": 1.5}, "active": true})",
+        R"({"active": false, "name": "out of order", "age_years": -3})",
+        R"({"name": "unknown key", "other": [1, {"a": null}], "age_years": 1})",
+        R"({"name": "escaped \" \u00e9", "tags": ["\n"]})",
+        "{\"name\": \"non ASCII \xc3\xa9\"}",
+        R"({"scores": {"a": 0.1, "b": 1e300, "c": 123456789012345678901234567890, "d": -0.0, "e": 5e-324}})",
+        R"({"age_years": null, "address": {}})",
+        R"({"age_years": 2147483648})",
+        R"({"address": {"zip": 65536}})",
+        R"({"name": 1})",
+        R"({"name": "malformed")",
+        R"({"name": "trailing"} x)",
+        R"([])",
+        "  {  }  ",
+    };
+    for (const char *document : documents) {
+        check(same_decoding(shape, document), document);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint64_t> bits;
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    for (int i = 0; i < 1000; i++) {
+        char number[64];
+        double d;
+        do {
+            const uint64_t b = bits(rng);
+            std::memcpy(&d, &b, sizeof(d));
+        } while (!std::isfinite(d));
+        if (i % 2) {
+            snprintf(number, sizeof(number), "%.17g", d);
+        }
+        else {
+            snprintf(number, sizeof(number), "%.*e", i % 20, d);
+        }
+        const std::string document = std::string(R"({"name": "n", "scores": {"x": )") + number + ", \"y\": " +
+            std::to_string(bits(rng) >> (i % 64)) + "e" + std::to_string(exponent(rng)) + "}}";
+        check(same_decoding(shape, document), "shape parser: random numbers");
+    }
+    const uint64_t fallbacks = shape.get_fallbacks();
+    shape.decode(documents[0]);
+    check(shape.get_fallbacks() == fallbacks, "shape parser: fast path");
+}
+
+// the blocks freed by another thread go back to the heap of the owner of their slab, which reuses them
+static void check_slab_resource()
+{
+    using namespace MiniJSON;
+
+    SlabResource slab;
+    std::vector<void *> blocks;
+    for (int i = 0; i < 5000; i++) {
+        blocks.push_back(slab.allocate(32, 8));
+    }
+    const size_t reserved = slab.slab_bytes();
+    std::thread([&slab, &blocks]() {
+        for (void *b : blocks) {
+            slab.deallocate(b, 32, 8);
+        }
+    }).join();
+    std::vector<void *> reused;
+    for (int i = 0; i < 5000; i++) {
+        reused.push_back(slab.allocate(32, 8));
+    }
+    check(slab.slab_bytes() == reserved, "slab resource: remote frees reused by the owner");
+    std::sort(blocks.begin(), blocks.end());
+    std::sort(reused.begin(), reused.end());
+    check(blocks == reused, "slab resource: same blocks");
+    for (void *b : reused) {
+        slab.deallocate(b, 32, 8);
+    }
+
+    // documents built by some threads and destroyed by others, while the owners keep allocating
+    const std::string text = R"({"id": 12, "tags": ["a", "b", "c"], "nested": {"k": [1.5, null, true, "a longer string value"]}})";
+    const Value expected = Parser().parse(text);
+    std::mutex mutex;
+    std::vector<Value> queue;
+    std::atomic<int> producing(2), corrupted(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; t++) {
+        threads.emplace_back([&]() {
+            Parser parser;
+            for (int i = 0; i < 2000; i++) {
+                Value v = parser.parse(text, &slab);
+                for (;;) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    // bounded, so that the blocks must be reused
+                    if (queue.size() < 64) {
+                        queue.push_back(std::move(v));
+                        break;
+                    }
+                }
+            }
+            --producing;
+        });
+        threads.emplace_back([&]() {
+            for (;;) {
+                std::vector<Value> taken;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    taken.swap(queue);
+                }
+                for (const Value &v : taken) {
+                    corrupted += !(v == expected);
+                }
+                if (taken.empty() && producing == 0) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (queue.empty()) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    check(corrupted == 0, "slab resource: documents freed by other threads");
+    // without the reuse, the 4000 documents need more than 80 slabs
+    check(slab.slab_bytes() <= 40 * SlabResource::SLAB_SIZE, "slab resource: the freed blocks are reused");
+}
+
+// the footprint of a document is what its resource holds, plus the root Value object
+static void check_memory_usage()
+{
+    using namespace MiniJSON;
+
+    const char *documents[] = {
+        "null",
+        R"("short")",
+        R"("a string too long for the small string buffer")",
+        R"({"a key too long for the small string buffer": [1, "x", {"k": null}], "b": {}, "c": []})",
+        R"([[[[]]], {"a": {"b": {"c": 1.5}}}, true, -1])",
+    };
+    for (const char *document : documents) {
+        CountingResource counter;
+        const Value v = Parser().parse(document, &counter);
+        const Value::MemoryUsage usage = v.memory_usage();
+        check(usage.total() <= counter.bytes_in_use() + sizeof(Value), "memory usage: lower bound");
+#ifdef __GLIBCXX__
+        // exact with the layout of the nodes of libstdc++
+        check(usage.total() == counter.bytes_in_use() + sizeof(Value), "memory usage: exact");
+#endif
+    }
+
+    const Value v = Parser().parse(R"({"k": ["short", "a string too long for the small string buffer"], "a key too long for the small string buffer": 1})");
+    const Value::MemoryUsage usage = v.memory_usage();
+    check(usage.m_values == 5 && usage.m_value_bytes + usage.m_position_bytes == 5 * sizeof(Value), "memory usage: values");
+    check(usage.m_string_bytes > 40 && usage.m_key_bytes > 2 * sizeof(std::pmr::string) + 40, "memory usage: long strings and keys");
+    check(Value("short").memory_usage().m_string_bytes == 0, "memory usage: short string");
+    Value::MemoryUsage sum = v["k"].memory_usage();
+    sum += v["a key too long for the small string buffer"].memory_usage();
+    check(sum.m_values == 4 && sum.total() < usage.total(), "memory usage: accumulate");
+}
+
+// the counters see every block of a parse and of a generation, and balance once the results are destroyed
+static void check_counting_resource()
+{
+    using namespace MiniJSON;
+
+    const char *document = R"({"a key too long for the small string buffer": ["a string too long for the small string buffer", 1, {}]})";
+    CountingResource counter;
+    {
+        const Value v = Parser().parse(document, &counter);
+        check(counter.allocations() > 0 && counter.bytes_in_use() > 0, "counting resource: parse");
+        check(counter.peak_bytes() >= counter.bytes_in_use() && counter.allocated_bytes() >= counter.bytes_in_use(),
+              "counting resource: peak");
+        const uint64_t in_use = counter.bytes_in_use();
+        counter.reset();
+        check(counter.allocations() == 0 && counter.allocated_bytes() == 0 && counter.peak_bytes() == in_use,
+              "counting resource: reset");
+        {
+            const std::pmr::string out = Generator::to_string(v, &counter);
+            check(counter.allocations() > 0 && counter.bytes_in_use() > in_use, "counting resource: generate");
+        }
+        check(counter.bytes_in_use() == in_use, "counting resource: generated string freed");
+    }
+    check(counter.bytes_in_use() == 0, "counting resource: document freed");
+
+    // the scopes count the default resource, nested in each other
+    std::pmr::memory_resource *previous = std::pmr::get_default_resource();
+    {
+        AllocationScope outer;
+        {
+            AllocationScope inner;
+            {
+                const Value v = Parser().parse(document);
+            }
+            check(inner.get_counter().allocations() > 0 && inner.get_counter().bytes_in_use() == 0, "counting resource: scope");
+            check(outer.get_counter().allocations() == inner.get_counter().allocations(), "counting resource: nested scopes");
+        }
+        check(std::pmr::get_default_resource() == &outer.get_counter(), "counting resource: inner scope restored");
+    }
+    check(std::pmr::get_default_resource() == previous, "counting resource: outer scope restored");
+
+    // shared by several threads
+    CountingResource shared(std::pmr::new_delete_resource());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&shared, document]() {
+            Parser parser;
+            for (int i = 0; i < 500; i++) {
+                const Value v = parser.parse(document, &shared);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    check(shared.bytes_in_use() == 0 && shared.allocations() == shared.deallocations() && shared.allocations() >= 4 * 500,
+          "counting resource: threads");
+}
+
 int main(int argc, char **argv)
 {
     using namespace MiniJSON;
@@ -28,5 +958,31 @@ int main(int argc, char **argv)
         }
     }
 
+    check_shared_document();
+    check_snapshot();
+    check_interner();
+    check_key_table();
+    check_pointer();
+    check_binder();
+    check_shape_parser();
+    check_query_compare();
+    check_stream_filter();
+    check_regex();
+    check_schema_pattern();
+    check_schema_duplicates();
+    check_schema_error_order();
+    check_patch();
+    check_static_numbers();
+    check_background_deleter();
+    check_slab_resource();
+    check_memory_usage();
+    check_counting_resource();
+    check_string_resource();
+    check_parser_stats();
+    if (failures != 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    puts("All checks passed");
     return 0;
 }
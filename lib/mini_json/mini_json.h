@@ -20,5 +20,22 @@
 #include <mini_json/mini_json_value.h>
 #include <mini_json/mini_json_generator.h>
 #include <mini_json/mini_json_parser.h>
+#include <mini_json/mini_json_key.h>
+#include <mini_json/mini_json_snapshot.h>
+#include <mini_json/mini_json_shared_document.h>
+#include <mini_json/mini_json_interner.h>
+#include <mini_json/mini_json_pointer.h>
+#include <mini_json/mini_json_query.h>
+#include <mini_json/mini_json_byte_search.h>
+#include <mini_json/mini_json_regex.h>
+#include <mini_json/mini_json_stream_filter.h>
+#include <mini_json/mini_json_schema.h>
+#include <mini_json/mini_json_patch.h>
+#include <mini_json/mini_json_deleter.h>
+#include <mini_json/mini_json_static_document.h>
+#include <mini_json/mini_json_binding.h>
+#include <mini_json/mini_json_shape_parser.h>
+#include <mini_json/mini_json_slab.h>
+#include <mini_json/mini_json_counting.h>
 
 #endif /* HC5652518_9A10_4AC2_9CAA_8AA2C066E922 */
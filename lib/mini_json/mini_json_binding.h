@@ -0,0 +1,259 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HFFE7041A_53C6_4788_9A68_C4DDED5EB4AA
+#define HFFE7041A_53C6_4788_9A68_C4DDED5EB4AA
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_parser.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Thrown when a document does not match the bound type
+ *
+ */
+class BindingException : public std::exception {
+    std::string m_msg;
+public:
+    /**
+     * @brief Build a new BindingException
+     *
+     * @param p position of the value in the document
+     * @param pointer JSON Pointer to the value
+     * @param info message
+     */
+    BindingException(Position p, const std::string &pointer, const std::string &info) : m_msg() {
+        m_msg = std::string("Binding error line ") + std::to_string(p.m_line_number) + " at position " + std::to_string(p.m_line_pos) + ", offset " + std::to_string(p.m_offset) +
+            " (\"" + pointer + "\"): " + info;
+    }
+
+    /**
+     * @brief returns an explanatory string
+     *
+     * @return message
+     */
+    const virtual char* what() const noexcept override {
+        return m_msg.c_str();
+    }
+};
+
+/**
+ * @brief Descriptor of a member of a bound struct
+ *
+ * @tparam T struct type
+ * @tparam M member type
+ */
+template<typename T, typename M>
+struct Field {
+    std::string_view m_key; ///< key of the member in the JSON object
+    M T::*m_member;         ///< pointer to the member
+};
+
+/**
+ * @brief Build the descriptor of a member of a bound struct
+ *
+ * @tparam T struct type
+ * @tparam M member type
+ * @param key key of the member in the JSON object
+ * @param member pointer to the member
+ * @return descriptor
+ */
+template<typename T, typename M>
+constexpr Field<T, M> field(std::string_view key, M T::*member) {
+    return Field<T, M>{key, member};
+}
+
+/**
+ * @brief Build the descriptor of a member whose key is the name of the member
+ */
+#define MINI_JSON_FIELD(type, member) ::MiniJSON::field(#member, &type::member)
+
+/**
+ * @brief Binding trait, to be specialized for each bound struct
+ *
+ * A specialization lists the descriptors of the bound members in a constexpr tuple:
+ * @code
+ * struct Person {
+ *     std::string name;
+ *     std::optional<uint32_t> age;
+ *     std::vector<std::string> tags;
+ * };
+ * template<> struct MiniJSON::Binding<Person> {
+ *     static constexpr auto fields = std::make_tuple(
+ *         MINI_JSON_FIELD(Person, name),
+ *         MiniJSON::field("age_years", &Person::age),
+ *         MINI_JSON_FIELD(Person, tags));
+ * };
+ * @endcode
+ *
+ * The members may be bool, integers, floating point numbers, std::string, std::optional,
+ * std::vector, std::map or std::unordered_map with string keys, or other bound structs.
+ *
+ * @tparam T struct type
+ */
+template<typename T>
+struct Binding;
+
+/**
+ * @brief Decode documents into bound structs and encode bound structs, through their Binding
+ *
+ * The documents are decoded from the events of the Parser, without building a Value: each
+ * key of an object is dispatched to its member with a perfect hash of the keys of the struct,
+ * computed at compile time. The unknown keys are skipped and the missing members keep their
+ * value. A null resets an optional, the empty optional members are not encoded.
+ *
+ * This class has no state, so all methods are static.
+ */
+class Binder {
+public:
+    /**
+     * @brief Decode a document
+     *
+     * @tparam T bound type, default constructible
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param document document, UTF-8 encoded
+     * @param parser parser
+     * @return decoded value
+     * @throws BindingException if the document does not match the type
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    template<typename T, typename StatsPolicy>
+    static T decode(std::string_view document, BasicParser<StatsPolicy> &parser) {
+        T out{};
+        decode(document, parser, out);
+        return out;
+    }
+
+    /**
+     * @brief Decode a document into an existing value
+     *
+     * The members of the structs which are missing from the document are left unchanged,
+     * the containers are cleared before being filled.
+     *
+     * @tparam T bound type
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param document document, UTF-8 encoded
+     * @param parser parser
+     * @param out decoded value
+     * @throws BindingException if the document does not match the type
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    template<typename T, typename StatsPolicy>
+    static void decode(std::string_view document, BasicParser<StatsPolicy> &parser, T &out);
+
+    /**
+     * @brief Encode a value
+     *
+     * @tparam T bound type
+     * @param v value
+     * @return JSON value
+     * @throws BadValueException for non-finite floating point numbers
+     */
+    template<typename T>
+    static Value encode(const T &v) {
+        return Codec<T>::encode(v);
+    }
+
+    /**
+     * @brief Encode a value as a compact document
+     *
+     * @tparam T bound type
+     * @param v value
+     * @return document
+     * @throws BadValueException for non-finite floating point numbers
+     */
+    template<typename T>
+    static std::string to_string(const T &v);
+
+private:
+    template<typename T> friend class ShapeParser;
+
+    struct Ops;
+    class Cursor;
+
+    /**
+     * @brief A type-erased decoding destination
+     */
+    struct Target {
+        void *m_object;     ///< destination, nullptr to skip the value
+        const Ops *m_ops;   ///< operations of the type of the destination
+    };
+
+    /**
+     * @brief Decoding operations of a type
+     *
+     * Each operation is nullptr when the type does not accept the corresponding event.
+     * The scalar operations return false when the value is out of range.
+     */
+    struct Ops {
+        const char *m_expected;                         ///< description of the accepted values, for the errors
+        bool (*m_null)(void *);                         ///< set from null
+        bool (*m_boolean)(void *, bool);                ///< set from a boolean
+        bool (*m_uint64)(void *, uint64_t);             ///< set from an unsigned integer
+        bool (*m_int64)(void *, int64_t);               ///< set from a negative integer
+        bool (*m_double)(void *, double);               ///< set from a floating point number
+        bool (*m_string)(void *, std::string &&);       ///< set from a string
+        void (*m_begin)(void *);                        ///< prepare the destination of an object or array
+        Target (*m_member)(void *, std::string_view);   ///< destination of a member, m_object is nullptr to skip it
+        Target (*m_element)(void *);                    ///< destination of a new element
+        Target (*m_engage)(void *);                     ///< engage an optional, returns the destination of its value
+    };
+
+    /**
+     * @brief Returns the smallest power of two not lower than n, at least 1
+     *
+     * @param n minimum size
+     * @return size
+     */
+    static constexpr size_t table_size(size_t n) noexcept {
+        size_t size = 1;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    template<size_t N> class PerfectHash;
+    template<typename T, typename Enable = void> struct Codec;
+    template<typename T, typename Enable = void> struct IsBound : std::false_type {};
+    template<typename T> struct IsBound<T, std::void_t<decltype(Binding<T>::fields)>> : std::true_type {};
+    template<typename Map> struct MapCodec;
+    template<typename T> struct StructCodec;
+    class Decoder;
+};
+
+}
+
+#include <mini_json/mini_json_binding_impl.h>
+
+#endif /* HFFE7041A_53C6_4788_9A68_C4DDED5EB4AA */
@@ -0,0 +1,965 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HA1CED0E8_3512_4B78_98B1_F2E0E3DFE9A4
+#define HA1CED0E8_3512_4B78_98B1_F2E0E3DFE9A4
+
+#include <cerrno>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <mini_json/mini_json_binding.h>
+#include <mini_json/mini_json_generator.h>
+#include <mini_json/mini_json_pointer.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Perfect hash of a set of keys, computed at compile time
+ *
+ * The keys are hashed with a seeded FNV-1a into a power of two table, large enough for a
+ * collision-free seed to be found after a few attempts. A lookup hashes the key once and
+ * compares it to the single candidate of its slot.
+ *
+ * @tparam N number of keys
+ */
+template<size_t N>
+class Binder::PerfectHash {
+public:
+    static constexpr size_t SIZE = table_size(N * 4 > N * N / 8 ? N * 4 : N * N / 8); ///< number of slots
+    static constexpr uint16_t EMPTY = uint16_t(N); ///< empty slot
+
+    static_assert(N < 0xFFFF, "too many keys");
+
+    /**
+     * @brief Find a collision-free seed for a set of keys
+     *
+     * @param keys distinct keys
+     * @throws std::logic_error if two keys are equal (a compilation error in a constant expression)
+     */
+    constexpr explicit PerfectHash(const std::array<std::string_view, N> &keys) : m_seed(0), m_slots() {
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = i + 1; j < N; ++j) {
+                if (keys[i] == keys[j]) {
+                    throw std::logic_error("duplicate key in a binding");
+                }
+            }
+        }
+        for (;; ++m_seed) {
+            for (size_t s = 0; s < SIZE; ++s) {
+                m_slots[s] = EMPTY;
+            }
+            bool collision = false;
+            for (size_t i = 0; i < N && !collision; ++i) {
+                size_t s = hash(keys[i], m_seed) & (SIZE - 1);
+                collision = m_slots[s] != EMPTY;
+                m_slots[s] = uint16_t(i);
+            }
+            if (!collision) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the only key index which may be equal to a key
+     *
+     * @param key key
+     * @return candidate index, or N
+     */
+    constexpr size_t candidate(std::string_view key) const noexcept {
+        return m_slots[hash(key, m_seed) & (SIZE - 1)];
+    }
+
+private:
+    /**
+     * @brief Seeded FNV-1a hash
+     *
+     * @param key key
+     * @param seed seed
+     * @return hash
+     */
+    static constexpr uint64_t hash(std::string_view key, uint64_t seed) noexcept {
+        uint64_t h = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+        for (char c : key) {
+            h ^= uint8_t(c);
+            h *= 1099511628211ULL;
+        }
+        return h ^ (h >> 29);
+    }
+
+    uint64_t m_seed;                        ///< collision-free seed
+    std::array<uint16_t, SIZE> m_slots;     ///< key index of each slot, or EMPTY
+};
+
+/**
+ * @brief Reader of the fast path of ShapeParser
+ *
+ * The cursor reads the common forms of the values directly from the bytes of the document:
+ * strings without escape sequences or non-ASCII characters, integers fitting in 64 bits and
+ * numbers exactly convertible to double. Each method returns false on any other input, and
+ * the document is then decoded by the generic Parser, which handles or reports it.
+ */
+class Binder::Cursor {
+public:
+    /**
+     * @brief Prepare the reading of a document
+     *
+     * @param document document
+     * @param max_depth maximum nesting of the containers
+     */
+    Cursor(std::string_view document, uint64_t max_depth) :
+        m_pos(document.data()), m_end(document.data() + document.size()), m_depth(0), m_max_depth(max_depth) {}
+
+    /**
+     * @brief Skip the whitespaces
+     */
+    void skip_ws() noexcept {
+        while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t')) {
+            ++m_pos;
+        }
+    }
+
+    /**
+     * @brief Skip the whitespaces and consume a character
+     *
+     * @param c expected character
+     * @return true if the next character was c
+     */
+    bool consume(char c) noexcept {
+        skip_ws();
+        if (m_pos != m_end && *m_pos == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Skip the whitespaces and consume a literal
+     *
+     * @param literal expected literal, "true", "false" or "null"
+     * @return true if the next characters were the literal
+     */
+    bool literal(std::string_view literal) noexcept {
+        skip_ws();
+        if (size_t(m_end - m_pos) >= literal.size() && std::memcmp(m_pos, literal.data(), literal.size()) == 0) {
+            m_pos += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Returns true if the whole document has been read
+     *
+     * @return true at the end of the document
+     */
+    bool at_end() noexcept {
+        skip_ws();
+        return m_pos == m_end;
+    }
+
+    /**
+     * @brief Enter a container
+     *
+     * @return false if the maximum depth is reached
+     */
+    bool enter() noexcept {
+        return ++m_depth < m_max_depth;
+    }
+
+    /**
+     * @brief Leave a container
+     */
+    void leave() noexcept {
+        --m_depth;
+    }
+
+    /**
+     * @brief Read a string made of printable ASCII characters only
+     *
+     * @param s view on the characters of the string, in the document
+     * @return false for other strings
+     */
+    bool string(std::string_view &s) noexcept {
+        if (!consume('"')) {
+            return false;
+        }
+        const char *begin = m_pos;
+        while (m_pos != m_end) {
+            uint8_t c = uint8_t(*m_pos);
+            if (c == '"') {
+                s = std::string_view(begin, size_t(m_pos - begin));
+                ++m_pos;
+                return true;
+            }
+            if (c == '\\' || c < 0x20 || c >= 0x80) {
+                return false;
+            }
+            ++m_pos;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Read an integer number
+     *
+     * @param magnitude absolute value
+     * @param negative sign
+     * @return false if the number is not an integer or doesn't fit in 64 bits
+     */
+    bool integer(uint64_t &magnitude, bool &negative) noexcept {
+        skip_ws();
+        negative = m_pos != m_end && *m_pos == '-';
+        if (negative) {
+            ++m_pos;
+        }
+        if (!digits(magnitude)) {
+            return false;
+        }
+        if (m_pos != m_end && (*m_pos == '.' || *m_pos == 'e' || *m_pos == 'E')) {
+            return false;
+        }
+        return !negative || magnitude <= uint64_t(1) << 63;
+    }
+
+    /**
+     * @brief Read a number as a double
+     *
+     * The integers are converted like the values reported by the generic Parser. A decimal
+     * number with at most 19 significant digits, a mantissa lower than 2^53 and a power of ten
+     * within 10^22 is converted exactly with a single multiplication or division. The other
+     * numbers are converted with strtod, an underflow is rounded and an overflow is out of range.
+     *
+     * @param d value
+     * @return false if the number is malformed or out of range
+     */
+    bool real(double &d) {
+        skip_ws();
+        const char *begin = m_pos;
+        bool negative = m_pos != m_end && *m_pos == '-';
+        if (negative) {
+            ++m_pos;
+        }
+        uint64_t mantissa = 0;
+        if (!digits(mantissa)) {
+            return false;
+        }
+        if (m_pos == m_end || (*m_pos != '.' && *m_pos != 'e' && *m_pos != 'E')) {
+            if (negative) {
+                if (mantissa > uint64_t(1) << 63) {
+                    return false;
+                }
+                d = double(int64_t(0 - mantissa));
+            }
+            else {
+                d = double(mantissa);
+            }
+            return true;
+        }
+
+        int64_t exponent = 0;
+        bool exact = true;
+        if (*m_pos == '.') {
+            ++m_pos;
+            const char *frac = m_pos;
+            for (; m_pos != m_end && *m_pos >= '0' && *m_pos <= '9'; ++m_pos) {
+                if (mantissa < 100000000000000000ULL) {
+                    mantissa = mantissa * 10 + uint64_t(*m_pos - '0');
+                    --exponent;
+                }
+                else if (*m_pos != '0') {
+                    exact = false;
+                }
+            }
+            if (m_pos == frac) {
+                return false;
+            }
+        }
+        if (m_pos != m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+            ++m_pos;
+            bool negative_exponent = false;
+            if (m_pos != m_end && (*m_pos == '+' || *m_pos == '-')) {
+                negative_exponent = *m_pos == '-';
+                ++m_pos;
+            }
+            const char *exp = m_pos;
+            int64_t e = 0;
+            for (; m_pos != m_end && *m_pos >= '0' && *m_pos <= '9'; ++m_pos) {
+                if (e < 100000) {
+                    e = e * 10 + (*m_pos - '0');
+                }
+            }
+            if (m_pos == exp) {
+                return false;
+            }
+            exponent += negative_exponent ? -e : e;
+        }
+
+        static constexpr double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        if (exact && mantissa < uint64_t(1) << 53 && exponent >= -22 && exponent <= 22) {
+            d = exponent < 0 ? double(mantissa) / POW10[-exponent] : double(mantissa) * POW10[exponent];
+            if (negative) {
+                d = -d;
+            }
+            return true;
+        }
+
+        std::string txt(begin, size_t(m_pos - begin));
+        char *endptr = nullptr;
+        errno = 0;
+        d = strtod(txt.c_str(), &endptr);
+        // an underflow is accepted, as by Parser
+        return (errno == 0 || (errno == ERANGE && std::fabs(d) <= DBL_MIN)) && endptr == txt.data() + txt.size();
+    }
+
+private:
+    /**
+     * @brief Read the digits of the integer part of a number
+     *
+     * @param v value
+     * @return false if there is no digit, a leading zero, or if the value doesn't fit in 64 bits
+     */
+    bool digits(uint64_t &v) noexcept {
+        const char *begin = m_pos;
+        v = 0;
+        for (; m_pos != m_end && *m_pos >= '0' && *m_pos <= '9'; ++m_pos) {
+            uint64_t digit = uint64_t(*m_pos - '0');
+            if (v > (UINT64_MAX - digit) / 10) {
+                return false;
+            }
+            v = v * 10 + digit;
+        }
+        return m_pos != begin && (*begin != '0' || m_pos == begin + 1);
+    }
+
+    const char *m_pos;      ///< current position
+    const char *m_end;      ///< end of the document
+    uint64_t m_depth;       ///< current nesting of the containers
+    uint64_t m_max_depth;   ///< maximum nesting of the containers
+};
+
+/**
+ * @brief Codec of a bool
+ */
+template<>
+struct Binder::Codec<bool> {
+    static bool boolean(void *o, bool v) {
+        *static_cast<bool *>(o) = v;
+        return true;
+    }
+    static constexpr Ops OPS = {"a boolean", nullptr, &boolean, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    static Value encode(bool v) {
+        return Value(v);
+    }
+
+    static bool read(Cursor &c, bool &v) {
+        if (c.literal("true")) {
+            v = true;
+            return true;
+        }
+        if (c.literal("false")) {
+            v = false;
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Codec of an integer, the values out of the range of the type are rejected
+ */
+template<typename T>
+struct Binder::Codec<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static bool uint64(void *o, uint64_t v) {
+        if (v > uint64_t(std::numeric_limits<T>::max())) {
+            return false;
+        }
+        *static_cast<T *>(o) = T(v);
+        return true;
+    }
+    static bool int64(void *o, int64_t v) {
+        if constexpr (std::is_unsigned_v<T>) {
+            return false;
+        }
+        else {
+            if (v < int64_t(std::numeric_limits<T>::min())) {
+                return false;
+            }
+            *static_cast<T *>(o) = T(v);
+            return true;
+        }
+    }
+    static constexpr Ops OPS = {std::is_unsigned_v<T> ? "an unsigned integer in the range of the type" : "an integer in the range of the type",
+        nullptr, nullptr, &uint64, &int64, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    static Value encode(T v) {
+        if constexpr (std::is_unsigned_v<T>) {
+            return Value(uint64_t(v));
+        }
+        else {
+            return Value(int64_t(v));
+        }
+    }
+
+    static bool read(Cursor &c, T &v) {
+        uint64_t magnitude;
+        bool negative;
+        if (!c.integer(magnitude, negative)) {
+            return false;
+        }
+        if (negative) {
+            return magnitude == 0 ? int64(&v, 0) : int64(&v, int64_t(0 - magnitude));
+        }
+        return uint64(&v, magnitude);
+    }
+};
+
+/**
+ * @brief Codec of a floating point number, integers are converted
+ */
+template<typename T>
+struct Binder::Codec<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static bool uint64(void *o, uint64_t v) {
+        *static_cast<T *>(o) = T(v);
+        return true;
+    }
+    static bool int64(void *o, int64_t v) {
+        *static_cast<T *>(o) = T(v);
+        return true;
+    }
+    static bool real(void *o, double v) {
+        *static_cast<T *>(o) = T(v);
+        return true;
+    }
+    static constexpr Ops OPS = {"a number", nullptr, nullptr, &uint64, &int64, &real, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    static Value encode(T v) {
+        return Value(double(v));
+    }
+
+    static bool read(Cursor &c, T &v) {
+        double d;
+        if (!c.real(d)) {
+            return false;
+        }
+        v = T(d);
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a string
+ */
+template<>
+struct Binder::Codec<std::string> {
+    static bool string(void *o, std::string &&v) {
+        *static_cast<std::string *>(o) = std::move(v);
+        return true;
+    }
+    static constexpr Ops OPS = {"a string", nullptr, nullptr, nullptr, nullptr, nullptr, &string, nullptr, nullptr, nullptr, nullptr};
+
+    static Value encode(const std::string &v) {
+        return Value(v);
+    }
+
+    static bool read(Cursor &c, std::string &v) {
+        std::string_view s;
+        if (!c.string(s)) {
+            return false;
+        }
+        v.assign(s.data(), s.size());
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of an optional, null resets it
+ */
+template<typename T>
+struct Binder::Codec<std::optional<T>> {
+    static bool null(void *o) {
+        static_cast<std::optional<T> *>(o)->reset();
+        return true;
+    }
+    static Target engage(void *o) {
+        auto &opt = *static_cast<std::optional<T> *>(o);
+        if (!opt) {
+            opt.emplace();
+        }
+        return Target{&*opt, &Codec<T>::OPS};
+    }
+    static constexpr Ops OPS = {Codec<T>::OPS.m_expected, &null, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &engage};
+
+    static Value encode(const std::optional<T> &v) {
+        return v ? Codec<T>::encode(*v) : Value();
+    }
+
+    static bool read(Cursor &c, std::optional<T> &v) {
+        if (c.literal("null")) {
+            v.reset();
+            return true;
+        }
+        if (!v) {
+            v.emplace();
+        }
+        return Codec<T>::read(c, *v);
+    }
+};
+
+/**
+ * @brief Codec of a vector, from an array
+ */
+template<typename T, typename A>
+struct Binder::Codec<std::vector<T, A>> {
+    static void begin(void *o) {
+        static_cast<std::vector<T, A> *>(o)->clear();
+    }
+    static Target element(void *o) {
+        return Target{&static_cast<std::vector<T, A> *>(o)->emplace_back(), &Codec<T>::OPS};
+    }
+    static constexpr Ops OPS = {"an array", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &begin, nullptr, &element, nullptr};
+
+    static Value encode(const std::vector<T, A> &v) {
+        Value array = Value::new_array();
+        for (const auto &e : v) {
+            array.push_back(Codec<T>::encode(e));
+        }
+        return array;
+    }
+
+    static bool read(Cursor &c, std::vector<T, A> &v) {
+        if (!c.consume('[') || !c.enter()) {
+            return false;
+        }
+        v.clear();
+        if (!c.consume(']')) {
+            do {
+                if (!Codec<T>::read(c, v.emplace_back())) {
+                    return false;
+                }
+            } while (c.consume(','));
+            if (!c.consume(']')) {
+                return false;
+            }
+        }
+        c.leave();
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a map with string keys, from an object
+ *
+ * @tparam Map std::map or std::unordered_map
+ */
+template<typename Map>
+struct Binder::MapCodec {
+    using T = typename Map::mapped_type;
+
+    static void begin(void *o) {
+        static_cast<Map *>(o)->clear();
+    }
+    static Target member(void *o, std::string_view key) {
+        auto &map = *static_cast<Map *>(o);
+        T &v = map[std::string(key)];
+        v = T();
+        return Target{&v, &Codec<T>::OPS};
+    }
+    static constexpr Ops OPS = {"an object", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &begin, &member, nullptr, nullptr};
+
+    static Value encode(const Map &v) {
+        Value object = Value::new_object();
+        for (const auto &e : v) {
+            object.insert_or_assign(e.first, Codec<T>::encode(e.second));
+        }
+        return object;
+    }
+
+    static bool read(Cursor &c, Map &v) {
+        if (!c.consume('{') || !c.enter()) {
+            return false;
+        }
+        v.clear();
+        if (!c.consume('}')) {
+            do {
+                std::string_view key;
+                if (!c.string(key) || !c.consume(':')) {
+                    return false;
+                }
+                T &e = v[std::string(key)];
+                e = T();
+                if (!Codec<T>::read(c, e)) {
+                    return false;
+                }
+            } while (c.consume(','));
+            if (!c.consume('}')) {
+                return false;
+            }
+        }
+        c.leave();
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a std::map with string keys
+ */
+template<typename T, typename C, typename A>
+struct Binder::Codec<std::map<std::string, T, C, A>> : MapCodec<std::map<std::string, T, C, A>> {};
+
+/**
+ * @brief Codec of a std::unordered_map with string keys
+ */
+template<typename T, typename H, typename E, typename A>
+struct Binder::Codec<std::unordered_map<std::string, T, H, E, A>> : MapCodec<std::unordered_map<std::string, T, H, E, A>> {};
+
+/**
+ * @brief Codec of a bound struct, from an object
+ *
+ * The keys are dispatched to the members with a perfect hash of the keys of the binding.
+ *
+ * @tparam T struct type
+ */
+template<typename T>
+struct Binder::StructCodec {
+    using Fields = std::decay_t<decltype(Binding<T>::fields)>;
+    static constexpr size_t N = std::tuple_size_v<Fields>;
+
+    template<size_t... I>
+    static constexpr std::array<std::string_view, N> make_keys(std::index_sequence<I...>) {
+        return {{std::get<I>(Binding<T>::fields).m_key...}};
+    }
+    static constexpr std::array<std::string_view, N> KEYS = make_keys(std::make_index_sequence<N>());
+    static constexpr PerfectHash<N> HASH = PerfectHash<N>(KEYS);
+
+    template<size_t I>
+    static Target target(void *o) {
+        constexpr auto f = std::get<I>(Binding<T>::fields);
+        using M = std::decay_t<decltype(static_cast<T *>(o)->*(f.m_member))>;
+        return Target{&(static_cast<T *>(o)->*(f.m_member)), &Codec<M>::OPS};
+    }
+    template<size_t... I>
+    static constexpr std::array<Target (*)(void *), N> make_targets(std::index_sequence<I...>) {
+        return {{&target<I>...}};
+    }
+    static constexpr std::array<Target (*)(void *), N> TARGETS = make_targets(std::make_index_sequence<N>());
+
+    static Target member(void *o, std::string_view key) {
+        size_t i = HASH.candidate(key);
+        if (i == N || KEYS[i] != key) {
+            return Target{nullptr, nullptr};
+        }
+        return TARGETS[i](o);
+    }
+
+    template<size_t... I>
+    static Value encode(const T &v, std::index_sequence<I...>) {
+        Value object = Value::new_object();
+        (encode_member(object, v, std::get<I>(Binding<T>::fields)), ...);
+        return object;
+    }
+    template<typename M>
+    static void encode_member(Value &object, const T &v, const Field<T, M> &f) {
+        if constexpr (IsOptional<M>::value) {
+            if (!(v.*(f.m_member))) {
+                return;
+            }
+        }
+        object.insert_or_assign(std::string(f.m_key), Codec<M>::encode(v.*(f.m_member)));
+    }
+    template<typename M> struct IsOptional : std::false_type {};
+    template<typename M> struct IsOptional<std::optional<M>> : std::true_type {};
+
+    template<size_t I>
+    static bool read_member(Cursor &c, T &o) {
+        constexpr auto f = std::get<I>(Binding<T>::fields);
+        return Codec<std::decay_t<decltype(o.*(f.m_member))>>::read(c, o.*(f.m_member));
+    }
+    template<size_t... I>
+    static constexpr std::array<bool (*)(Cursor &, T &), N> make_readers(std::index_sequence<I...>) {
+        return {{&read_member<I>...}};
+    }
+    static constexpr std::array<bool (*)(Cursor &, T &), N> READERS = make_readers(std::make_index_sequence<N>());
+
+    /**
+     * @brief Read an object, expecting its keys in the order of the binding
+     *
+     * The key following a member is first compared to the key of the next member of the
+     * binding, then looked up with the perfect hash.
+     *
+     * @param c cursor
+     * @param o struct
+     * @return false on an unknown key or on any value the cursor does not read
+     */
+    static bool read(Cursor &c, T &o) {
+        if (!c.consume('{') || !c.enter()) {
+            return false;
+        }
+        if (!c.consume('}')) {
+            size_t expected = 0;
+            do {
+                std::string_view key;
+                if (!c.string(key)) {
+                    return false;
+                }
+                size_t i = expected;
+                if (i == N || KEYS[i] != key) {
+                    i = HASH.candidate(key);
+                    if (i == N || KEYS[i] != key) {
+                        return false;
+                    }
+                }
+                if (!c.consume(':') || !READERS[i](c, o)) {
+                    return false;
+                }
+                expected = i + 1;
+            } while (c.consume(','));
+            if (!c.consume('}')) {
+                return false;
+            }
+        }
+        c.leave();
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a bound struct
+ */
+template<typename T>
+struct Binder::Codec<T, std::enable_if_t<Binder::IsBound<T>::value>> {
+    static constexpr Ops OPS = {"an object", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &StructCodec<T>::member, nullptr, nullptr};
+
+    static Value encode(const T &v) {
+        return StructCodec<T>::encode(v, std::make_index_sequence<StructCodec<T>::N>());
+    }
+
+    static bool read(Cursor &c, T &v) {
+        return StructCodec<T>::read(c, v);
+    }
+};
+
+/**
+ * @brief Parser handler writing the events into their destinations
+ */
+class Binder::Decoder {
+public:
+    /**
+     * @brief Prepare the decoding of a document
+     *
+     * @param root destination of the document
+     */
+    explicit Decoder(Target root) : m_root(root), m_stack(), m_skip(0) {}
+
+    bool null_value(Position p) {
+        Target t = next();
+        if (t.m_object && !(t.m_ops->m_null && t.m_ops->m_null(t.m_object))) {
+            fail(p, t);
+        }
+        return true;
+    }
+    bool boolean_value(bool v, Position p) {
+        Target t = engage(next());
+        if (t.m_object && !(t.m_ops->m_boolean && t.m_ops->m_boolean(t.m_object, v))) {
+            fail(p, t);
+        }
+        return true;
+    }
+    bool uint64_value(uint64_t v, Position p) {
+        Target t = engage(next());
+        if (t.m_object && !(t.m_ops->m_uint64 && t.m_ops->m_uint64(t.m_object, v))) {
+            fail(p, t);
+        }
+        return true;
+    }
+    bool int64_value(int64_t v, Position p) {
+        Target t = engage(next());
+        if (t.m_object && !(t.m_ops->m_int64 && t.m_ops->m_int64(t.m_object, v))) {
+            fail(p, t);
+        }
+        return true;
+    }
+    bool double_value(double v, Position p) {
+        Target t = engage(next());
+        if (t.m_object && !(t.m_ops->m_double && t.m_ops->m_double(t.m_object, v))) {
+            fail(p, t);
+        }
+        return true;
+    }
+    bool string_value(std::string &&v, Position p) {
+        Target t = engage(next());
+        if (t.m_object && !(t.m_ops->m_string && t.m_ops->m_string(t.m_object, std::move(v)))) {
+            fail(p, t);
+        }
+        return true;
+    }
+    bool begin_object(Position p) {
+        Target t = engage(next());
+        if (t.m_object && !t.m_ops->m_member) {
+            fail(p, t);
+        }
+        open(t);
+        return true;
+    }
+    bool key(std::string &&k, Position) {
+        if (m_skip == 0) {
+            Frame &f = m_stack.back();
+            f.m_next = f.m_target.m_ops->m_member(f.m_target.m_object, k);
+            f.m_key = std::move(k);
+        }
+        return true;
+    }
+    bool end_object() {
+        close();
+        return true;
+    }
+    bool begin_array(Position p) {
+        Target t = engage(next());
+        if (t.m_object && !t.m_ops->m_element) {
+            fail(p, t);
+        }
+        open(t);
+        return true;
+    }
+    bool end_array() {
+        close();
+        return true;
+    }
+
+private:
+    /**
+     * @brief An object or array being decoded
+     */
+    struct Frame {
+        Target m_target;    ///< destination of the container
+        size_t m_index;     ///< number of elements of an array
+        std::string m_key;  ///< current key of an object
+        Target m_next;      ///< destination of the current member of an object
+    };
+
+    /**
+     * @brief Returns the destination of the next value, m_object is nullptr to skip it
+     *
+     * @return destination
+     */
+    Target next() {
+        if (m_skip > 0) {
+            return Target{nullptr, nullptr};
+        }
+        if (m_stack.empty()) {
+            return m_root;
+        }
+        Frame &f = m_stack.back();
+        if (f.m_target.m_ops->m_element) {
+            ++f.m_index;
+            return f.m_target.m_ops->m_element(f.m_target.m_object);
+        }
+        return f.m_next;
+    }
+
+    /**
+     * @brief Engage the optionals receiving a value which is not null
+     *
+     * @param t destination
+     * @return destination of the value
+     */
+    static Target engage(Target t) {
+        while (t.m_object && t.m_ops->m_engage) {
+            t = t.m_ops->m_engage(t.m_object);
+        }
+        return t;
+    }
+
+    /**
+     * @brief Enter a container, which is skipped if its destination is nullptr
+     *
+     * @param t destination
+     */
+    void open(Target t) {
+        if (m_skip > 0 || !t.m_object) {
+            ++m_skip;
+            return;
+        }
+        if (t.m_ops->m_begin) {
+            t.m_ops->m_begin(t.m_object);
+        }
+        m_stack.push_back(Frame{t, 0, std::string(), Target{nullptr, nullptr}});
+    }
+
+    /**
+     * @brief Leave a container
+     */
+    void close() {
+        if (m_skip > 0) {
+            --m_skip;
+        }
+        else {
+            m_stack.pop_back();
+        }
+    }
+
+    /**
+     * @brief Report a value which does not match its destination
+     *
+     * @param p position of the value
+     * @param t destination
+     * @throws BindingException
+     */
+    [[noreturn]] void fail(Position p, Target t) const {
+        std::string pointer;
+        for (const Frame &f : m_stack) {
+            pointer += '/';
+            if (f.m_target.m_ops->m_element) {
+                pointer += std::to_string(f.m_index - 1);
+            }
+            else {
+                pointer += Pointer::escape(f.m_key);
+            }
+        }
+        throw BindingException(p, pointer, std::string("expected ") + t.m_ops->m_expected);
+    }
+
+    Target m_root;              ///< destination of the document
+    std::vector<Frame> m_stack; ///< open containers
+    size_t m_skip;              ///< depth in a skipped value
+};
+
+template<typename T, typename StatsPolicy>
+inline void Binder::decode(std::string_view document, BasicParser<StatsPolicy> &parser, T &out) {
+    Decoder decoder(Target{&out, &Codec<T>::OPS});
+    parser.parse(document, decoder);
+}
+
+template<typename T>
+inline std::string Binder::to_string(const T &v) {
+    return Generator::to_string(encode(v));
+}
+
+}
+
+#endif /* HA1CED0E8_3512_4B78_98B1_F2E0E3DFE9A4 */
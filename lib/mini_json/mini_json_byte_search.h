@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H98702CD6_D9EF_4AC6_85B7_A2B8F11F4A65
+#define H98702CD6_D9EF_4AC6_85B7_A2B8F11F4A65
+
+#include <cstddef>
+
+#include <string_view>
+
+namespace MiniJSON {
+
+/**
+ * @brief Substring search on raw bytes
+ *
+ * When the target supports SSE2 (and the compiler is GCC or Clang), the candidate positions
+ * are found 16 bytes at a time by comparing the first and the last byte of the needle.
+ * Otherwise, the search falls back to std::string_view::find().
+ *
+ * This class has no state, so all methods are static.
+ */
+class ByteSearch {
+public:
+    /**
+     * @brief Find the first occurrence of a substring
+     *
+     * @param haystack bytes to search
+     * @param needle bytes to find
+     * @return offset of the first occurrence or std::string_view::npos
+     */
+    static size_t find(std::string_view haystack, std::string_view needle) noexcept;
+
+    /**
+     * @brief Test whether a string contains a substring
+     *
+     * @param haystack bytes to search
+     * @param needle bytes to find
+     * @return true if needle is found in haystack
+     */
+    static bool contains(std::string_view haystack, std::string_view needle) noexcept {
+        return find(haystack, needle) != std::string_view::npos;
+    }
+
+    /**
+     * @brief Test whether a string contains a byte
+     *
+     * @param haystack bytes to search
+     * @param c byte to find
+     * @return true if c is found in haystack
+     */
+    static bool contains(std::string_view haystack, char c) noexcept;
+};
+
+}
+
+#include <mini_json/mini_json_byte_search_impl.h>
+
+#endif /* H98702CD6_D9EF_4AC6_85B7_A2B8F11F4A65 */
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDC80DBEF_00CC_4F0D_B556_47CC79EDD50C
+#define HDC80DBEF_00CC_4F0D_B556_47CC79EDD50C
+
+#include <cstring>
+#include <mini_json/mini_json_byte_search.h>
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define MINI_JSON_BYTE_SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace MiniJSON {
+
+inline size_t ByteSearch::find(std::string_view haystack, std::string_view needle) noexcept {
+    const size_t k = needle.size();
+    if (k == 0) {
+        return 0;
+    }
+    if (k > haystack.size()) {
+        return std::string_view::npos;
+    }
+    if (k == 1) {
+        const void *p = std::memchr(haystack.data(), needle[0], haystack.size());
+        return p != nullptr ? static_cast<size_t>(static_cast<const char *>(p) - haystack.data()) : std::string_view::npos;
+    }
+
+    size_t i = 0;
+#ifdef MINI_JSON_BYTE_SEARCH_SSE2
+    // number of possible start positions
+    const size_t n = haystack.size() - k + 1;
+    const char *h = haystack.data();
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[k - 1]);
+    for (; i + 16 <= n; i += 16) {
+        // block_last reads up to h[i + 15 + k - 1] < h[n + k - 1] = h[haystack.size()]
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i));
+        const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i + k - 1));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+        while (mask != 0) {
+            const unsigned int bit = static_cast<unsigned int>(__builtin_ctz(mask));
+            if (std::memcmp(h + i + bit + 1, needle.data() + 1, k - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    const size_t r = haystack.substr(i).find(needle);
+    return r != std::string_view::npos ? i + r : r;
+}
+
+inline bool ByteSearch::contains(std::string_view haystack, char c) noexcept {
+    return !haystack.empty() && std::memchr(haystack.data(), c, haystack.size()) != nullptr;
+}
+
+}
+
+#endif /* HDC80DBEF_00CC_4F0D_B556_47CC79EDD50C */
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HF4EEDDF0_E060_476C_94DD_31E08803BA13
+#define HF4EEDDF0_E060_476C_94DD_31E08803BA13
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <memory_resource>
+
+namespace MiniJSON {
+
+/**
+ * @brief A memory resource counting the allocations forwarded to an upstream resource
+ *
+ * The resource counts the allocations, the deallocations and the allocated bytes, and tracks
+ * the bytes in use and their peak. It measures the allocations of a parse or of a generation:
+ * @code
+ * MiniJSON::CountingResource counter;
+ * MiniJSON::Value doc = parser.parse(text, &counter);
+ * std::pmr::string out = MiniJSON::Generator::to_string(doc, &counter);
+ * // counter.allocations(), counter.peak_bytes()...
+ * @endcode
+ * Only the blocks requested from the resource are seen. They include the characters of the strings
+ * and keys of the document, but not the scratch buffers of the parser, which are std::string.
+ *
+ * The counters are atomic, the resource can be shared by several threads.
+ * The resource must outlive the values allocated from it.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Build a new resource
+     *
+     * @param upstream resource serving the allocations
+     */
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) :
+        m_upstream(upstream), m_allocations(0), m_deallocations(0), m_allocated_bytes(0), m_bytes_in_use(0), m_peak_bytes(0) {}
+
+    CountingResource(const CountingResource &) = delete;
+    CountingResource & operator=(const CountingResource &) = delete;
+
+    /**
+     * @brief Returns the upstream resource
+     *
+     * @return upstream resource
+     */
+    std::pmr::memory_resource * upstream_resource() const noexcept {
+        return m_upstream;
+    }
+
+    /**
+     * @brief Returns the number of allocations
+     *
+     * @return count
+     */
+    uint64_t allocations() const noexcept {
+        return m_allocations.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of deallocations
+     *
+     * @return count
+     */
+    uint64_t deallocations() const noexcept {
+        return m_deallocations.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the total number of bytes allocated, including the freed blocks
+     *
+     * @return bytes
+     */
+    uint64_t allocated_bytes() const noexcept {
+        return m_allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of bytes currently allocated
+     *
+     * @return bytes
+     */
+    uint64_t bytes_in_use() const noexcept {
+        return m_bytes_in_use.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the highest number of bytes allocated at the same time
+     *
+     * @return bytes
+     */
+    uint64_t peak_bytes() const noexcept {
+        return m_peak_bytes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Reset the counters, to measure the next operation
+     *
+     * The bytes in use are kept, they become the peak.
+     */
+    void reset() noexcept;
+
+protected:
+    void * do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource *m_upstream;      ///< upstream resource
+    std::atomic<uint64_t> m_allocations;        ///< number of allocations
+    std::atomic<uint64_t> m_deallocations;      ///< number of deallocations
+    std::atomic<uint64_t> m_allocated_bytes;    ///< bytes allocated, including the freed blocks
+    std::atomic<uint64_t> m_bytes_in_use;       ///< bytes currently allocated
+    std::atomic<uint64_t> m_peak_bytes;         ///< highest value of m_bytes_in_use
+};
+
+/**
+ * @brief Counts the allocations made through the default memory resource during its lifetime
+ *
+ * The scope installs a CountingResource forwarding to the current default resource with
+ * std::pmr::set_default_resource(), and restores the previous default resource when destroyed.
+ * It measures the operations which don't take a resource, such as Parser::parse(input):
+ * @code
+ * {
+ *     MiniJSON::AllocationScope scope;
+ *     MiniJSON::Value doc = parser.parse(text);
+ *     // scope.get_counter().allocations()...
+ * }
+ * @endcode
+ * The default resource is global to the process: the allocations of the other threads are
+ * counted too, and the scopes must be nested, not interleaved. The values allocated during the
+ * scope must be destroyed before the scope ends.
+ */
+class AllocationScope {
+public:
+    /**
+     * @brief Begin counting
+     */
+    AllocationScope() : m_previous(std::pmr::get_default_resource()), m_counter(m_previous) {
+        std::pmr::set_default_resource(&m_counter);
+    }
+
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope & operator=(const AllocationScope &) = delete;
+
+    /**
+     * @brief Restore the previous default resource
+     */
+    ~AllocationScope() {
+        std::pmr::set_default_resource(m_previous);
+    }
+
+    /**
+     * @brief Returns the counters of the scope
+     *
+     * @return counting resource
+     */
+    CountingResource & get_counter() noexcept {
+        return m_counter;
+    }
+
+private:
+    std::pmr::memory_resource *m_previous;  ///< default resource before the scope
+    CountingResource m_counter;             ///< default resource during the scope
+};
+
+}
+
+#include <mini_json/mini_json_counting_impl.h>
+
+#endif /* HF4EEDDF0_E060_476C_94DD_31E08803BA13 */
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H149A3489_C1C2_49BD_AEBA_D4818FB3E387
+#define H149A3489_C1C2_49BD_AEBA_D4818FB3E387
+
+#include <mini_json/mini_json_counting.h>
+
+namespace MiniJSON {
+
+inline void CountingResource::reset() noexcept {
+    m_allocations.store(0, std::memory_order_relaxed);
+    m_deallocations.store(0, std::memory_order_relaxed);
+    m_allocated_bytes.store(0, std::memory_order_relaxed);
+    m_peak_bytes.store(m_bytes_in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+inline void * CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void *p = m_upstream->allocate(bytes, alignment);
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+    m_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    const uint64_t in_use = m_bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t peak = m_peak_bytes.load(std::memory_order_relaxed);
+    while (in_use > peak && !m_peak_bytes.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    return p;
+}
+
+inline void CountingResource::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    m_upstream->deallocate(p, bytes, alignment);
+    m_deallocations.fetch_add(1, std::memory_order_relaxed);
+    m_bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+}
+
+#endif /* H149A3489_C1C2_49BD_AEBA_D4818FB3E387 */
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HD5427CD3_A279_40D5_9323_A2533D2382C6
+#define HD5427CD3_A279_40D5_9323_A2533D2382C6
+
+#include <cstddef>
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory_resource>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_snapshot.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Destroys documents on a background thread
+ *
+ * Freeing a large document takes time proportional to its number of nodes. dispose() moves the
+ * document to a queue and returns immediately, a worker thread owned by the deleter destroys
+ * the queued documents. The scalars are destroyed immediately, they are cheap to free.
+ *
+ * The destructor of the deleter destroys the documents still queued and joins the worker.
+ * All methods can be called from several threads.
+ *
+ * A Value is freed on the worker thread only if the memory resource of its root is safe to use
+ * from another thread: std::pmr::new_delete_resource(), a std::pmr::synchronized_pool_resource or a
+ * resource declared with add_thread_safe_resource(). The other values, for instance the ones allocated
+ * from a std::pmr::unsynchronized_pool_resource or a std::pmr::monotonic_buffer_resource, are destroyed
+ * by dispose() on the calling thread. The nested values are assumed to use the resource of the root, as
+ * the documents built by Parser and ValueBuilder do. A resource must outlive the destruction of the
+ * values queued with it: call flush() before releasing it.
+ */
+class BackgroundDeleter {
+public:
+    /**
+     * @brief Start the worker thread
+     */
+    BackgroundDeleter();
+
+    BackgroundDeleter(const BackgroundDeleter &) = delete;
+    BackgroundDeleter & operator=(const BackgroundDeleter &) = delete;
+
+    /**
+     * @brief Destroy the queued documents and stop the worker thread
+     */
+    ~BackgroundDeleter();
+
+    /**
+     * @brief Declare a memory resource safe to use from the worker thread
+     *
+     * The values allocated from this resource are then destroyed on the worker thread. The resource
+     * must be thread-safe and must outlive the destruction of these values (see flush()).
+     *
+     * @param resource memory resource
+     */
+    void add_thread_safe_resource(std::pmr::memory_resource *resource);
+
+    /**
+     * @brief Queue a document for destruction
+     *
+     * The document is destroyed immediately if its memory resource is not known to be thread-safe.
+     *
+     * @param v document, left null
+     */
+    void dispose(Value &&v);
+
+    /**
+     * @brief Queue a reference to a document for destruction
+     *
+     * The nodes are only freed if this was the last reference to them.
+     *
+     * @param s document, left null
+     */
+    void dispose(Snapshot &&s);
+
+    /**
+     * @brief Wait until all the documents queued so far are destroyed
+     */
+    void flush();
+
+    /**
+     * @brief Returns the number of documents waiting to be destroyed
+     *
+     * @return number of queued documents, including the ones being destroyed
+     */
+    size_t pending() const;
+
+private:
+    mutable std::mutex m_mutex;         ///< protects the queues and the counters
+    std::condition_variable m_wake;     ///< signaled when documents are queued or on stop
+    std::condition_variable m_idle;     ///< signaled when a batch of documents is destroyed
+    std::vector<Value> m_values;        ///< queued values
+    std::vector<Snapshot> m_snapshots;  ///< queued snapshots
+    std::vector<std::pmr::memory_resource *> m_resources;  ///< resources declared thread-safe
+    size_t m_in_progress;               ///< number of documents being destroyed by the worker
+    bool m_stop;                        ///< the worker must exit once the queues are empty
+    std::thread m_worker;               ///< worker thread, started last
+
+    /**
+     * @brief Returns true if the values of a resource can be freed by the worker thread
+     *
+     * The caller must hold m_mutex.
+     *
+     * @param resource memory resource of a value
+     * @return true for the standard thread-safe resources and the declared ones
+     */
+    bool is_thread_safe(std::pmr::memory_resource *resource) const;
+
+    /**
+     * @brief Main loop of the worker thread
+     */
+    void run();
+};
+
+}
+
+#include <mini_json/mini_json_deleter_impl.h>
+
+#endif /* HD5427CD3_A279_40D5_9323_A2533D2382C6 */
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HE0FB7A15_5CA9_4665_BD56_24C40D22975B
+#define HE0FB7A15_5CA9_4665_BD56_24C40D22975B
+
+#include <algorithm>
+
+#include <mini_json/mini_json_deleter.h>
+
+namespace MiniJSON {
+
+inline BackgroundDeleter::BackgroundDeleter() :
+    m_mutex(), m_wake(), m_idle(), m_values(), m_snapshots(), m_resources(), m_in_progress(0), m_stop(false),
+    m_worker(&BackgroundDeleter::run, this) {}
+
+inline BackgroundDeleter::~BackgroundDeleter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+inline void BackgroundDeleter::add_thread_safe_resource(std::pmr::memory_resource *resource) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!is_thread_safe(resource)) {
+        m_resources.push_back(resource);
+    }
+}
+
+inline void BackgroundDeleter::dispose(Value &&v) {
+    if (!(v.get_type() & MASK_TYPE_IS_CONTAINER)) {
+        v = Value();
+        return;
+    }
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (is_thread_safe(v.get_resource())) {
+            m_values.push_back(std::move(v));
+            queued = true;
+        }
+    }
+    if (!queued) {
+        // the resource can't be used from the worker thread
+        v = Value();
+        return;
+    }
+    m_wake.notify_one();
+}
+
+inline void BackgroundDeleter::dispose(Snapshot &&s) {
+    if (!(s.get_type() & MASK_TYPE_IS_CONTAINER)) {
+        s = Snapshot();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshots.push_back(std::move(s));
+    }
+    m_wake.notify_one();
+}
+
+inline void BackgroundDeleter::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_values.empty() && m_snapshots.empty() && m_in_progress == 0; });
+}
+
+inline size_t BackgroundDeleter::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_values.size() + m_snapshots.size() + m_in_progress;
+}
+
+inline bool BackgroundDeleter::is_thread_safe(std::pmr::memory_resource *resource) const {
+    if (resource == std::pmr::new_delete_resource() || dynamic_cast<std::pmr::synchronized_pool_resource *>(resource) != nullptr) {
+        return true;
+    }
+    return std::find(m_resources.begin(), m_resources.end(), resource) != m_resources.end();
+}
+
+inline void BackgroundDeleter::run() {
+    std::vector<Value> values;
+    std::vector<Snapshot> snapshots;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stop || !m_values.empty() || !m_snapshots.empty(); });
+        if (m_values.empty() && m_snapshots.empty()) {
+            // m_stop is set and there is nothing left
+            return;
+        }
+        // take the whole batch and destroy it without holding the lock
+        values.swap(m_values);
+        snapshots.swap(m_snapshots);
+        m_in_progress = values.size() + snapshots.size();
+        lock.unlock();
+        values.clear();
+        snapshots.clear();
+        lock.lock();
+        m_in_progress = 0;
+        m_idle.notify_all();
+    }
+}
+
+}
+
+#endif /* HE0FB7A15_5CA9_4665_BD56_24C40D22975B */
@@ -18,7 +18,9 @@
 #define HF5BCC136_DBD1_4CBB_BE1D_7A78F6921BEE
 
 #include <string>
+#include <string_view>
 #include <exception>
+#include <memory_resource>
 
 namespace MiniJSON {
     
@@ -50,6 +52,9 @@ class Value;
  * 
  * Floating points values are encoded with enough decimals to preserve the value.S
  * 
+ * The document is appended to a single output string, which is the only memory allocated by
+ * the generator. The output can be allocated from a memory resource.
+ * 
  * This class has no state, so all methods are static.
  */
 class Generator {
@@ -61,6 +66,14 @@ public:
      * @return JSON document
      */
     static std::string to_string(const Value &value);
+    /**
+     * @brief Produce a compact document from the value, allocated from a memory resource
+     * 
+     * @param value JSON value
+     * @param resource memory resource of the document
+     * @return JSON document
+     */
+    static std::pmr::string to_string(const Value &value, std::pmr::memory_resource *resource);
     /* Produce an intended document from the value */
     /**
      * @brief Produce an indented document from the value
@@ -70,6 +83,15 @@ public:
      * @return JSON document
      */
     static std::string to_string_pretty(const Value &value, unsigned int indent = 4);
+    /**
+     * @brief Produce an indented document from the value, allocated from a memory resource
+     * 
+     * @param value JSON value
+     * @param indent Number of spaces for the indentation
+     * @param resource memory resource of the document
+     * @return JSON document
+     */
+    static std::pmr::string to_string_pretty(const Value &value, unsigned int indent, std::pmr::memory_resource *resource);
 
 private:
     /**
@@ -82,21 +104,33 @@ private:
      * The use of the UTF-16 surrogate pair is not mandatory in the JSON specifications,
      * so it may be incompatible with other implementations.
      * 
+     * @tparam String std::string or std::pmr::string
      * @param in string value or object key
-     * @return Escaped string, ready to print
+     * @param out output, the escaped string is appended
      */
-    static std::string escape_string(const std::string &in);
+    template<typename String> static void write_escaped(std::string_view in, String &out);
     
     /**
-     * @brief Recursive implementation of to_string_pretty
+     * @brief Append the compact representation of a value
      * 
+     * @tparam String std::string or std::pmr::string
      * @param value Value to encode
-     * @param space A string containing spaces for the current indentation level
-     * @param add_space A string containing spaces added at each new level
-     * @param prefix A prefix to output between "spacee" and the value. This argument is used to hold an object key representation
-     * @return String representation of value
+     * @param out output
+     */
+    template<typename String> static void write(const Value &value, String &out);
+    
+    /**
+     * @brief Append the indented representation of a value
+     * 
+     * The indentation of the first line has already been written.
+     * 
+     * @tparam String std::string or std::pmr::string
+     * @param value Value to encode
+     * @param indent Number of spaces for the indentation
+     * @param level nesting level of the value
+     * @param out output
      */
-    static std::string to_string_pretty_priv(const Value &value, const std::string &space, const std::string &add_space, const std::string &prefix);
+    template<typename String> static void write_pretty(const Value &value, unsigned int indent, size_t level, String &out);
 };
 
 }
@@ -18,13 +18,15 @@
 #define H8006C5C1_21F1_4E29_A6B9_91A74F1FB5C4
 
 #include <cfloat>
-#include <numeric>
+#include <cstdio>
+#include <charconv>
+#include <iterator>
 #include <mini_json/mini_json_generator.h>
 #include <mini_json/mini_json_value.h>
 
 namespace MiniJSON {
 
-inline std::string Generator::to_string_pretty_priv(const Value &value, const std::string &space, const std::string &add_space, const std::string &prefix) {
+template<typename String> inline void Generator::write_pretty(const Value &value, unsigned int indent, size_t level, String &out) {
     switch (value.get_type()) {
     case Type::Null:
     case Type::Boolean:
@@ -32,48 +34,61 @@ inline std::string Generator::to_string_pretty_priv(const Value &value, const st
     case Type::Int64:
     case Type::Double:
     case Type::String:
-        return space + prefix + to_string(value);
+        write(value, out);
+        return;
     case Type::Array:
     {
         const auto &list = value.get<Type::Array>();
-        if (list.size() == 0) {
-            return space + prefix + "[]";
+        if (list.empty()) {
+            out.append("[]");
+            return;
         }
-        const std::string next_space = add_space + space;
-
-        auto tf = [&next_space, &add_space](const Value &v) {return to_string_pretty_priv(v, next_space, add_space, {});};
-        auto binop = [](const std::string &s1, const std::string &s2) {return s1 + ",\n" + s2;};
-        auto it = list.begin();
-        auto ret = std::transform_reduce(std::next(it), list.end(), tf(*it), binop, tf);
-        ret = space + prefix + "[\n" + ret + "\n" + space + "]";
-        return ret;
+        out.append("[\n");
+        bool first = true;
+        for (const auto &e : list) {
+            if (!first) {
+                out.append(",\n");
+            }
+            first = false;
+            out.append(indent * (level + 1), ' ');
+            write_pretty(e, indent, level + 1, out);
+        }
+        out.push_back('\n');
+        out.append(indent * level, ' ');
+        out.push_back(']');
+        return;
     }
     case Type::Object:
     {
         const auto &map = value.get<Type::Object>();
-        if (map.size() == 0) {
-            return space + prefix + "{}";
-        }
-        const std::string next_space = add_space + space;
-
-        typedef ObjectValues::value_type value_type;
-        auto tf = [&next_space, &add_space](const value_type &p) {
-            return to_string_pretty_priv(p.second, next_space, add_space, escape_string(p.first) + std::string(" : "));
-        };
-        auto binop = [](const std::string &s1, const std::string &s2) {return s1 + ",\n" + s2;};
-        auto it = map.begin();
-        auto ret = std::transform_reduce(std::next(it), map.end(), tf(*it), binop, tf);
-        ret = space + prefix + "{\n" + ret + "\n" + space + "}";
-        return ret;
+        if (map.empty()) {
+            out.append("{}");
+            return;
+        }
+        out.append("{\n");
+        bool first = true;
+        for (const auto &m : map) {
+            if (!first) {
+                out.append(",\n");
+            }
+            first = false;
+            out.append(indent * (level + 1), ' ');
+            write_escaped(m.first, out);
+            out.append(" : ");
+            write_pretty(m.second, indent, level + 1, out);
+        }
+        out.push_back('\n');
+        out.append(indent * level, ' ');
+        out.push_back('}');
+        return;
     }
     }
     throw std::exception();
 }
 
-inline std::string Generator::escape_string(const std::string &in) {
+template<typename String> inline void Generator::write_escaped(std::string_view in, String &out) {
     static const char *hex_encode = "0123456789ABCDEF";
-    std::string out;
-    out.reserve(in.size() + 2);
+    out.reserve(out.size() + in.size() + 2);
     out.push_back('"');
 
     size_t rem = in.size();
@@ -138,9 +153,7 @@ inline std::string Generator::escape_string(const std::string &in) {
         }
 
         if (escape_len > 0) {
-            for (int i = 0; i < escape_len; ++i) {
-                out.push_back(escape_seq[i]);
-            }
+            out.append(escape_seq, size_t(escape_len));
         }
         else {
             UTF::encode_utf8(&cp, 1, std::back_inserter(out), NULL, NULL);
@@ -150,68 +163,95 @@ inline std::string Generator::escape_string(const std::string &in) {
         rem -= consumed;
     }
     out.push_back('"');
-    return out;
 }
 
-/*This is a simpler version of escape_string_pretty_priv */
-inline std::string Generator::to_string(const Value &value) {
+/*This is a simpler version of write_pretty */
+template<typename String> inline void Generator::write(const Value &value, String &out) {
     switch (value.get_type()) {
     case Type::Null:
-        return "null";
+        out.append("null");
+        return;
     case Type::Boolean:
-        return value.get<Type::Boolean>() ? "true" : "false";
+        out.append(value.get<Type::Boolean>() ? "true" : "false");
+        return;
     case Type::UInt64:
-        return std::to_string(value.get<Type::UInt64>());
+    {
+        char buf[32];
+        out.append(buf, size_t(std::to_chars(buf, buf + sizeof(buf), value.get<Type::UInt64>()).ptr - buf));
+        return;
+    }
     case Type::Int64:
-        return std::to_string(value.get<Type::Int64>());
+    {
+        char buf[32];
+        out.append(buf, size_t(std::to_chars(buf, buf + sizeof(buf), value.get<Type::Int64>()).ptr - buf));
+        return;
+    }
     case Type::Double:
     {
         char buf[128];
-        snprintf(buf, sizeof(buf), "%.*g", DBL_DECIMAL_DIG, value.get<Type::Double>());
-        return buf;
+        int len = snprintf(buf, sizeof(buf), "%.*g", DBL_DECIMAL_DIG, value.get<Type::Double>());
+        out.append(buf, size_t(len));
+        return;
     }
     case Type::String:
-        return escape_string(value.get<Type::String>());
+        write_escaped(value.get<Type::String>(), out);
+        return;
     case Type::Array:
     {
-        const auto &list = value.get<Type::Array>();
-        if (list.size() == 0) {
-            return "[]";
+        out.push_back('[');
+        bool first = true;
+        for (const auto &e : value.get<Type::Array>()) {
+            if (!first) {
+                out.append(", ");
+            }
+            first = false;
+            write(e, out);
         }
-
-        auto tf = [](const Value &v) {return to_string(v);};
-        auto binop = [](const std::string &s1, const std::string &s2) {return s1 + ", " + s2;};
-        auto it = list.begin();
-        auto ret = std::transform_reduce(std::next(it), list.end(), tf(*it), binop, tf);
-        ret.insert(ret.begin(), '[');
-        ret.push_back(']');
-        return ret;
+        out.push_back(']');
+        return;
     }
     case Type::Object:
     {
-        const auto &map = value.get<Type::Object>();
-        if (map.size() == 0) {
-            return "{}";
-        }
-
-        typedef ObjectValues::value_type value_type;
-        auto tf = [](const value_type &p) {
-            return escape_string(p.first) + std::string(": ") + to_string(p.second);
-        };
-        auto binop = [](const std::string &s1, const std::string &s2) {return s1 + ", " + s2;};
-        auto it = map.begin();
-        auto ret = std::transform_reduce(std::next(it), map.end(), tf(*it), binop, tf);
-        ret.insert(ret.begin(), '{');
-        ret.push_back('}');
-        return ret;
+        out.push_back('{');
+        bool first = true;
+        for (const auto &m : value.get<Type::Object>()) {
+            if (!first) {
+                out.append(", ");
+            }
+            first = false;
+            write_escaped(m.first, out);
+            out.append(": ");
+            write(m.second, out);
+        }
+        out.push_back('}');
+        return;
     }
     }
     throw std::exception();
 }
 
+inline std::string Generator::to_string(const Value &value) {
+    std::string out;
+    write(value, out);
+    return out;
+}
+
+inline std::pmr::string Generator::to_string(const Value &value, std::pmr::memory_resource *resource) {
+    std::pmr::string out(resource);
+    write(value, out);
+    return out;
+}
+
 inline std::string Generator::to_string_pretty(const Value &value, unsigned int indent) {
-    std::string add_space(indent, char(' '));
-    return to_string_pretty_priv(value, {}, add_space, {});
+    std::string out;
+    write_pretty(value, indent, 0, out);
+    return out;
+}
+
+inline std::pmr::string Generator::to_string_pretty(const Value &value, unsigned int indent, std::pmr::memory_resource *resource) {
+    std::pmr::string out(resource);
+    write_pretty(value, indent, 0, out);
+    return out;
 }
 
 }
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC481B6B4_B691_4591_B1E3_AB9CBD9C47DD
+#define HC481B6B4_B691_4591_B1E3_AB9CBD9C47DD
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_set>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_snapshot.h>
+#include <mini_json/mini_json_key.h>
+#include <mini_json/mini_json_parser.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief A hash-consing table for Snapshot nodes
+ *
+ * The Interner stores a single node for each distinct subtree, strings included. Interning a
+ * document returns an equivalent Snapshot whose subtrees are shared with all the documents
+ * previously interned: the same address blocks or default settings repeated in many documents
+ * are stored once.
+ *
+ * Two subtrees are merged only if they are strictly identical: same data types (1 and 1.0
+ * are not merged), same values and same keys. The positions are ignored, the merged node keeps
+ * the position of the first occurrence.
+ *
+ * If a KeyTable is given, the object keys are interned too, and the documents interned with
+ * different Interners sharing the same KeyTable share their keys.
+ *
+ * The interner keeps a reference on all its nodes, they live until clear() or collect() is called.
+ * This class is not thread-safe, but the Snapshots it returns can be shared between threads.
+ */
+class Interner {
+public:
+    /**
+     * @brief Construct an empty table
+     *
+     * @param keys optional table used to intern the object keys, must outlive the interner
+     */
+    explicit Interner(KeyTable *keys = nullptr) : m_keys(keys), m_nodes() {}
+
+    /**
+     * @brief Returns the table used to intern the object keys
+     *
+     * @return table or nullptr
+     */
+    KeyTable * key_table() const noexcept {
+        return m_keys;
+    }
+
+    /**
+     * @brief Compaction pass, returns the canonical version of a document
+     *
+     * The nodes of s which are already canonical are reused, the others are rebuilt.
+     *
+     * @param s document
+     * @return equivalent document made of interned nodes
+     */
+    Snapshot intern(const Snapshot &s);
+
+    /**
+     * @brief Build the canonical version of a Value
+     *
+     * @param v document
+     * @return equivalent document made of interned nodes
+     */
+    Snapshot intern(const Value &v);
+
+    /**
+     * @brief Parse a document, interning the nodes as they are parsed
+     *
+     * No intermediate Value is built.
+     *
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param input document, UTF-8 encoded
+     * @param parser parser to use
+     * @return document made of interned nodes
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    template<typename StatsPolicy> Snapshot parse(std::string_view input, BasicParser<StatsPolicy> &parser);
+
+    /**
+     * @brief Returns the canonical node for a value whose children are already interned
+     *
+     * @param s value
+     * @return interned value
+     */
+    Snapshot canonical(const Snapshot &s) {
+        return *m_nodes.insert(s).first;
+    }
+
+    /**
+     * @brief Returns the number of distinct nodes
+     *
+     * @return number of nodes
+     */
+    size_t size() const noexcept {
+        return m_nodes.size();
+    }
+
+    /**
+     * @brief Forget all the nodes
+     *
+     * The documents already interned stay valid, but they won't be shared with the next ones.
+     */
+    void clear() {
+        m_nodes.clear();
+    }
+
+    /**
+     * @brief Forget the nodes which are not referenced outside of the table
+     *
+     * @return number of nodes removed
+     */
+    size_t collect();
+
+private:
+    /**
+     * @brief Hash function of the table, Snapshot::hash()
+     */
+    struct Hash {
+        size_t operator()(const Snapshot &s) const noexcept {
+            return s.hash();
+        }
+    };
+    /**
+     * @brief Equality of the table, the children are expected to be interned
+     */
+    struct Identical {
+        bool operator()(const Snapshot &a, const Snapshot &b) const;
+    };
+
+    KeyTable *m_keys;                                       ///< optional table of the keys
+    std::unordered_set<Snapshot, Hash, Identical> m_nodes;   ///< interned nodes
+
+    /**
+     * @brief Returns the key to use in an interned node
+     *
+     * @param k key
+     * @return k, or its interned version if a KeyTable is used
+     */
+    Key key(const Key &k) {
+        return m_keys != nullptr ? m_keys->intern(k.view()) : k;
+    }
+};
+
+/**
+ * @brief A parser event handler building a Snapshot
+ *
+ * See Parser::parse(std::string_view, Handler &). If an Interner is given, the nodes are
+ * interned as soon as they are complete. If a KeyTable is given, or if the Interner uses one,
+ * the object keys are interned while they are parsed.
+ *
+ * As with the ValueBuilder, if a key is repeated in an object, the last value is kept.
+ */
+class SnapshotBuilder {
+public:
+    /**
+     * @brief Construct a new builder
+     *
+     * @param interner optional hash-consing table
+     * @param keys optional table of the keys, defaults to the table of the interner
+     */
+    explicit SnapshotBuilder(Interner *interner = nullptr, KeyTable *keys = nullptr) :
+        m_interner(interner),
+        m_keys(keys != nullptr || interner == nullptr ? keys : interner->key_table()),
+        m_root(), m_stack(), m_key() {}
+
+    /**
+     * @brief Handle a null value
+     *
+     * @param p position
+     * @return true
+     */
+    bool null_value(Position p) {
+        add(Snapshot(nullptr, p));
+        return true;
+    }
+    /**
+     * @brief Handle a boolean value
+     *
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool boolean_value(bool v, Position p) {
+        add(Snapshot(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a positive integer
+     *
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool uint64_value(uint64_t v, Position p) {
+        add(Snapshot(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a negative integer
+     *
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool int64_value(int64_t v, Position p) {
+        add(Snapshot(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a floating point number
+     *
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool double_value(double v, Position p) {
+        add(Snapshot(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a string
+     *
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool string_value(std::string &&v, Position p) {
+        add(Snapshot(std::move(v), p));
+        return true;
+    }
+    /**
+     * @brief Handle the begining of an object
+     *
+     * @param p position
+     * @return true
+     */
+    bool begin_object(Position p) {
+        m_stack.push_back({Object, p, {}, {}, std::move(m_key)});
+        return true;
+    }
+    /**
+     * @brief Handle an object key, the next event is its value
+     *
+     * @param k key
+     * @param p position
+     * @return true
+     */
+    bool key(std::string &&k, Position p) {
+        (void) p;
+        m_key = m_keys != nullptr ? m_keys->intern(k) : Key(std::move(k));
+        return true;
+    }
+    /**
+     * @brief Handle the end of an object
+     *
+     * @return true
+     */
+    bool end_object();
+    /**
+     * @brief Handle the begining of an array
+     *
+     * @param p position
+     * @return true
+     */
+    bool begin_array(Position p) {
+        m_stack.push_back({Array, p, {}, {}, std::move(m_key)});
+        return true;
+    }
+    /**
+     * @brief Handle the end of an array
+     *
+     * @return true
+     */
+    bool end_array();
+
+    /**
+     * @brief Returns the document built so far
+     *
+     * @return document
+     */
+    const Snapshot & get() const noexcept {
+        return m_root;
+    }
+
+private:
+    /**
+     * @brief An array or an object being built
+     */
+    struct Frame {
+        Type m_type;                ///< Array or Object
+        Position m_position;        ///< position of the container
+        ObjectSnapshots m_members;  ///< members of an object, in the document order
+        ArraySnapshots m_elements;  ///< elements of an array
+        Key m_key;                  ///< key of this container in its parent object
+    };
+
+    Interner *m_interner;           ///< optional hash-consing table
+    KeyTable *m_keys;               ///< optional table of the keys
+    Snapshot m_root;                ///< document
+    std::vector<Frame> m_stack;     ///< open arrays and objects
+    Key m_key;                      ///< key of the next member of the current object
+
+    /**
+     * @brief Insert a complete value in the current container, or set the document
+     *
+     * @param s value
+     */
+    void add(Snapshot &&s);
+};
+
+}
+
+#include <mini_json/mini_json_interner_impl.h>
+
+#endif /* HC481B6B4_B691_4591_B1E3_AB9CBD9C47DD */
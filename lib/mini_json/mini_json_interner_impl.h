@@ -0,0 +1,224 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC0BB9748_E6C9_4178_AE5E_DB7483B410B3
+#define HC0BB9748_E6C9_4178_AE5E_DB7483B410B3
+
+#include <cstring>
+#include <algorithm>
+#include <mini_json/mini_json_interner.h>
+
+namespace MiniJSON {
+
+inline bool Interner::Identical::operator()(const Snapshot &a, const Snapshot &b) const {
+    if (a.is_same(b)) {
+        return true;
+    }
+    if (a.get_type() != b.get_type()) {
+        return false;
+    }
+    switch (a.get_type()) {
+    case Type::Null:
+        return true;
+    case Type::Boolean:
+        return a.get<Type::Boolean>() == b.get<Type::Boolean>();
+    case Type::UInt64:
+        return a.get<Type::UInt64>() == b.get<Type::UInt64>();
+    case Type::Int64:
+        return a.get<Type::Int64>() == b.get<Type::Int64>();
+    case Type::Double:
+    {
+        // 0.0 and -0.0 are equal but are not printed the same way
+        const double da = a.get<Type::Double>();
+        const double db = b.get<Type::Double>();
+        return std::memcmp(&da, &db, sizeof(double)) == 0;
+    }
+    case Type::String:
+        return a.get<Type::String>() == b.get<Type::String>();
+    case Type::Object:
+    {
+        const auto &ma = a.get<Type::Object>();
+        const auto &mb = b.get<Type::Object>();
+        if (ma.size() != mb.size()) {
+            return false;
+        }
+        // the children are interned, they are identical only if they are the same nodes
+        for (size_t i = 0; i < ma.size(); ++i) {
+            // with a KeyTable, the keys are compared by address
+            if (!ma[i].second.is_same(mb[i].second) || ma[i].first != mb[i].first) {
+                return false;
+            }
+        }
+        return true;
+    }
+    case Type::Array:
+    {
+        const auto &ea = a.get<Type::Array>();
+        const auto &eb = b.get<Type::Array>();
+        if (ea.size() != eb.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < ea.size(); ++i) {
+            if (!ea[i].is_same(eb[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+inline Snapshot Interner::intern(const Snapshot &s) {
+    switch (s.get_type()) {
+    case Type::Object:
+    {
+        const auto &members = s.get<Type::Object>();
+        ObjectSnapshots interned;
+        interned.reserve(members.size());
+        bool changed = false;
+        for (const auto &m : members) {
+            interned.emplace_back(key(m.first), intern(m.second));
+            changed = changed || !interned.back().second.is_same(m.second) || !interned.back().first.is_same(m.first);
+        }
+        return canonical(changed ? Snapshot(std::move(interned), s.get_position()) : s);
+    }
+    case Type::Array:
+    {
+        const auto &elements = s.get<Type::Array>();
+        ArraySnapshots interned;
+        interned.reserve(elements.size());
+        bool changed = false;
+        for (const auto &e : elements) {
+            interned.push_back(intern(e));
+            changed = changed || !interned.back().is_same(e);
+        }
+        return canonical(changed ? Snapshot(std::move(interned), s.get_position()) : s);
+    }
+    default:
+        return canonical(s);
+    }
+}
+
+inline Snapshot Interner::intern(const Value &v) {
+    switch (v.get_type()) {
+    case Type::Object:
+    {
+        const auto &map = v.get<Type::Object>();
+        ObjectSnapshots interned;
+        interned.reserve(map.size());
+        for (const auto &m : map) {
+            interned.emplace_back(m_keys != nullptr ? m_keys->intern(m.first) : Key(m.first), intern(m.second));
+        }
+        return canonical(Snapshot(std::move(interned), v.get_position()));
+    }
+    case Type::Array:
+    {
+        const auto &list = v.get<Type::Array>();
+        ArraySnapshots interned;
+        interned.reserve(list.size());
+        for (const auto &e : list) {
+            interned.push_back(intern(e));
+        }
+        return canonical(Snapshot(std::move(interned), v.get_position()));
+    }
+    default:
+        return canonical(Snapshot(v));
+    }
+}
+
+template<typename StatsPolicy> inline Snapshot Interner::parse(std::string_view input, BasicParser<StatsPolicy> &parser) {
+    SnapshotBuilder builder(this);
+    parser.parse(input, builder);
+    return builder.get();
+}
+
+inline size_t Interner::collect() {
+    size_t removed = 0;
+    // removing a parent releases its children, loop until nothing changes
+    while (true) {
+        size_t n = 0;
+        for (auto it = m_nodes.begin(); it != m_nodes.end(); ) {
+            if (it->m_node && it->m_node.use_count() == 1) {
+                it = m_nodes.erase(it);
+                ++n;
+            }
+            else {
+                ++it;
+            }
+        }
+        if (n == 0) {
+            return removed;
+        }
+        removed += n;
+    }
+}
+
+inline void SnapshotBuilder::add(Snapshot &&s) {
+    if (m_interner != nullptr) {
+        s = m_interner->canonical(s);
+    }
+    if (m_stack.empty()) {
+        m_root = std::move(s);
+        return;
+    }
+    Frame &parent = m_stack.back();
+    if (parent.m_type == Type::Array) {
+        parent.m_elements.push_back(std::move(s));
+    }
+    else {
+        parent.m_members.emplace_back(std::move(m_key), std::move(s));
+    }
+}
+
+inline bool SnapshotBuilder::end_object() {
+    Frame f = std::move(m_stack.back());
+    m_stack.pop_back();
+
+    auto &members = f.m_members;
+    std::stable_sort(members.begin(), members.end(),
+        [](const ObjectSnapshots::value_type &a, const ObjectSnapshots::value_type &b) { return a.first < b.first; });
+    // remove the repeated keys, keeping the last value
+    auto out = members.begin();
+    for (auto it = members.begin(); it != members.end(); ++it) {
+        if (out != members.begin() && std::prev(out)->first == it->first) {
+            std::prev(out)->second = std::move(it->second);
+        }
+        else {
+            if (out != it) {
+                *out = std::move(*it);
+            }
+            ++out;
+        }
+    }
+    members.erase(out, members.end());
+
+    m_key = std::move(f.m_key);
+    add(Snapshot(std::move(members), f.m_position));
+    return true;
+}
+
+inline bool SnapshotBuilder::end_array() {
+    Frame f = std::move(m_stack.back());
+    m_stack.pop_back();
+    m_key = std::move(f.m_key);
+    add(Snapshot(std::move(f.m_elements), f.m_position));
+    return true;
+}
+
+}
+
+#endif /* HC0BB9748_E6C9_4178_AE5E_DB7483B410B3 */
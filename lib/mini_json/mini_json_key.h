@@ -0,0 +1,253 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H77FB2EBF_6863_4924_8E01_76EDE2C46C76
+#define H77FB2EBF_6863_4924_8E01_76EDE2C46C76
+
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <shared_mutex>
+
+namespace MiniJSON {
+
+/**
+ * @brief An immutable object key with a precomputed hash
+ *
+ * A Key is a reference-counted handle on its text. The keys returned by a KeyTable for the
+ * same text share the same entry, so comparing them is a pointer comparison and storing them
+ * costs a single pointer per use.
+ *
+ * The hash is std::hash<std::string_view> of the text, as used by Value::hash().
+ */
+class Key {
+public:
+    /**
+     * @brief Constructs an empty key
+     */
+    Key() : m_entry(empty_entry()) {}
+    /**
+     * @brief Constructs a key which is not interned
+     *
+     * @param text key, UTF-8 encoded
+     */
+    explicit Key(std::string_view text) : m_entry(std::make_shared<const Entry>(std::string(text))) {}
+    /**
+     * @brief Constructs a key which is not interned
+     *
+     * @param text key, UTF-8 encoded
+     */
+    explicit Key(std::string &&text) : m_entry(std::make_shared<const Entry>(std::move(text))) {}
+    /**
+     * @brief Constructs a key which is not interned
+     *
+     * @param text key, UTF-8 encoded
+     */
+    explicit Key(const char *text) : Key(std::string_view(text)) {}
+
+    Key(const Key &) = default;
+    Key & operator=(const Key &) = default;
+    /**
+     * @brief Move constructor, o becomes the empty key
+     *
+     * @param o other key
+     */
+    Key(Key &&o) noexcept : m_entry(std::move(o.m_entry)) {
+        o.m_entry = empty_entry();
+    }
+    /**
+     * @brief Move assignment, the keys are swapped
+     *
+     * @param o other key
+     * @return this key
+     */
+    Key & operator=(Key &&o) noexcept {
+        m_entry.swap(o.m_entry);
+        return *this;
+    }
+
+    /**
+     * @brief Returns the text of the key
+     *
+     * @return text
+     */
+    const std::string & str() const noexcept {
+        return m_entry->m_text;
+    }
+
+    /**
+     * @brief Returns the text of the key
+     *
+     * @return text
+     */
+    std::string_view view() const noexcept {
+        return m_entry->m_text;
+    }
+
+    /**
+     * @brief Returns the precomputed hash of the key
+     *
+     * @return hash
+     */
+    size_t hash() const noexcept {
+        return m_entry->m_hash;
+    }
+
+    /**
+     * @brief Test whether two keys share the same entry
+     *
+     * @param o other key
+     * @return true if the keys share their entry, which implies they are equal
+     */
+    bool is_same(const Key &o) const noexcept {
+        return m_entry == o.m_entry;
+    }
+
+    /**
+     * @brief equal operator
+     *
+     * O(1) if the keys share their entry or have different hashes.
+     *
+     * @param o other key
+     * @return true if the texts are equal
+     */
+    bool operator==(const Key &o) const noexcept {
+        return m_entry == o.m_entry || (hash() == o.hash() && view() == o.view());
+    }
+    /**
+     * @brief != operator
+     *
+     * @param o other key
+     * @return true if the texts are different
+     */
+    bool operator!=(const Key &o) const noexcept {
+        return !operator==(o);
+    }
+    /**
+     * @brief Lexicographic order of the texts, as for the keys of ObjectValues
+     *
+     * @param o other key
+     * @return true if this key is before o
+     */
+    bool operator<(const Key &o) const noexcept {
+        return m_entry != o.m_entry && view() < o.view();
+    }
+
+private:
+    /**
+     * @brief Shared text and hash
+     */
+    struct Entry {
+        std::string m_text;     ///< text of the key
+        size_t m_hash;          ///< hash of m_text
+
+        explicit Entry(std::string &&text) : m_text(std::move(text)), m_hash(std::hash<std::string_view>()(m_text)) {}
+    };
+
+    std::shared_ptr<const Entry> m_entry;   ///< shared entry, never null
+
+    /**
+     * @brief Returns the entry shared by all the default constructed keys
+     *
+     * @return entry
+     */
+    static const std::shared_ptr<const Entry> & empty_entry() {
+        static const std::shared_ptr<const Entry> entry = std::make_shared<const Entry>(std::string());
+        return entry;
+    }
+
+    friend class KeyTable;
+};
+
+/**
+ * @brief A table of interned keys
+ *
+ * Interning the same text twice returns two keys sharing the same entry. A table can be used
+ * per arena, or process-wide with global(). The table keeps its keys alive until it is destroyed.
+ *
+ * The methods of this class are thread-safe.
+ */
+class KeyTable {
+public:
+    /**
+     * @brief Construct an empty table
+     */
+    KeyTable() : m_mutex(), m_keys() {}
+
+    KeyTable(const KeyTable &) = delete;
+    KeyTable & operator=(const KeyTable &) = delete;
+
+    /**
+     * @brief Returns the process-wide table
+     *
+     * @return table
+     */
+    static KeyTable & global() {
+        static KeyTable table;
+        return table;
+    }
+
+    /**
+     * @brief Returns the interned key for a text
+     *
+     * @param text key, UTF-8 encoded
+     * @return key
+     */
+    Key intern(std::string_view text);
+
+    /**
+     * @brief Returns the number of keys in the table
+     *
+     * @return number of keys
+     */
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_keys.size();
+    }
+
+private:
+    mutable std::shared_mutex m_mutex;                  ///< protects m_keys
+    std::unordered_map<std::string_view, Key> m_keys;   ///< keys, indexed by their text (owned by the key)
+};
+
+}
+
+namespace std {
+
+/**
+ * @brief Specialization of std::hash for MiniJSON::Key, see Key::hash()
+ */
+template<> struct hash<MiniJSON::Key> {
+    /**
+     * @brief Hash a key
+     *
+     * @param k key
+     * @return hash
+     */
+    size_t operator()(const MiniJSON::Key &k) const noexcept {
+        return k.hash();
+    }
+};
+
+}
+
+#include <mini_json/mini_json_key_impl.h>
+
+#endif /* H77FB2EBF_6863_4924_8E01_76EDE2C46C76 */
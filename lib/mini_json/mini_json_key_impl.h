@@ -0,0 +1,42 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HF65BC642_2D8B_4AA5_AF0C_853886CADB08
+#define HF65BC642_2D8B_4AA5_AF0C_853886CADB08
+
+#include <mutex>
+#include <mini_json/mini_json_key.h>
+
+namespace MiniJSON {
+
+inline Key KeyTable::intern(std::string_view text) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_keys.find(text);
+        if (it != m_keys.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Key k(text);
+    // another thread may have inserted the same key in the meantime
+    auto r = m_keys.emplace(k.view(), k);
+    return r.first->second;
+}
+
+}
+
+#endif /* HF65BC642_2D8B_4AA5_AF0C_853886CADB08 */
@@ -19,8 +19,14 @@
 
 #include <cstdlib>
 #include <cerrno>
+#include <cfloat>
+#include <cmath>
 #include <string_view>
 #include <exception>
+#include <vector>
+#include <memory_resource>
+
+#include <chrono>
 
 #include "mini_json_value.h"
 
@@ -89,6 +95,388 @@ public:
     }
 };
 
+/**
+ * @brief A parser event handler building a Value
+ * 
+ * This is the handler used by Parser::parse(const std::string &). It can also be used
+ * directly with Parser::parse(std::string_view, Handler &).
+ * 
+ * As with the ObjectValues::operator[], if a key is repeated in an object, the last value is kept.
+ *
+ * The strings and keys of the document are copied into the resource of the builder (see Value): the
+ * events only lend their characters.
+ */
+class ValueBuilder {
+public:
+    /**
+     * @brief Construct a new builder
+     * 
+     * @param resource memory resource of the strings, objects and arrays of the document, and of the builder
+     */
+    explicit ValueBuilder(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_resource(resource), m_root(), m_stack(resource), m_key() {}
+    
+    /**
+     * @brief Handle a null value
+     * 
+     * @param p position
+     * @return true
+     */
+    bool null_value(Position p) {
+        add(Value(p));
+        return true;
+    }
+    /**
+     * @brief Handle a boolean value
+     * 
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool boolean_value(bool v, Position p) {
+        add(Value(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a positive integer
+     * 
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool uint64_value(uint64_t v, Position p) {
+        add(Value(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a negative integer
+     * 
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool int64_value(int64_t v, Position p) {
+        add(Value(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a floating point number
+     * 
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool double_value(double v, Position p) {
+        add(Value(v, p));
+        return true;
+    }
+    /**
+     * @brief Handle a string
+     * 
+     * @param v value
+     * @param p position
+     * @return true
+     */
+    bool string_value(std::string &&v, Position p) {
+        add(Value(std::move(v), p, m_resource));
+        return true;
+    }
+    /**
+     * @brief Handle the begining of an object
+     * 
+     * @param p position
+     * @return true
+     */
+    bool begin_object(Position p) {
+        m_stack.push_back(&add(Value(ObjectValues(m_resource), p)));
+        return true;
+    }
+    /**
+     * @brief Handle an object key, the next event is its value
+     * 
+     * @param k key
+     * @param p position
+     * @return true
+     */
+    bool key(std::string &&k, Position p) {
+        (void) p;
+        m_key = std::move(k);
+        return true;
+    }
+    /**
+     * @brief Handle the end of an object
+     * 
+     * @return true
+     */
+    bool end_object() {
+        m_stack.pop_back();
+        return true;
+    }
+    /**
+     * @brief Handle the begining of an array
+     * 
+     * @param p position
+     * @return true
+     */
+    bool begin_array(Position p) {
+        m_stack.push_back(&add(Value(ArrayValues(m_resource), p)));
+        return true;
+    }
+    /**
+     * @brief Handle the end of an array
+     * 
+     * @return true
+     */
+    bool end_array() {
+        m_stack.pop_back();
+        return true;
+    }
+    
+    /**
+     * @brief Returns the document built so far
+     * 
+     * @return JSON Value
+     */
+    Value & get() {
+        return m_root;
+    }
+    
+private:
+    std::pmr::memory_resource *m_resource;  ///< memory resource of the document
+    Value m_root;                           ///< document
+    std::pmr::vector<Value *> m_stack;      ///< open arrays and objects, the values are never moved once inserted
+    std::string m_key;              ///< key of the next member of the current object
+    
+    /**
+     * @brief Insert a value in the current container, or set the document
+     * 
+     * @param v value
+     * @return reference on the inserted value
+     */
+    Value & add(Value &&v) {
+        if (m_stack.empty()) {
+            m_root = std::move(v);
+            return m_root;
+        }
+        Value &parent = *m_stack.back();
+        if (parent.get_type() == Type::Array) {
+            auto &list = parent.get<Type::Array>();
+            list.push_back(std::move(v));
+            return list.back();
+        }
+        // the key is copied into the resource of the object
+        auto &map = parent.get<Type::Object>();
+        std::string_view key(m_key);
+        auto it = map.lower_bound(key);
+        if (it != map.end() && it->first == key) {
+            it->second = std::move(v);
+            return it->second;
+        }
+        return map.emplace_hint(it, key, std::move(v))->second;
+    }
+};
+
+/**
+ * @brief Statistics of the documents parsed by a BasicParser, accumulated since its construction or reset_stats()
+ * 
+ * The counters are updated by the CountStats and TimedStats policies, the timings only by TimedStats.
+ * Each timing excludes the nested phases, so their sum is the parsing time, including the time spent
+ * in the handler.
+ */
+struct ParserStats {
+    uint64_t m_documents = 0;       ///< number of parsed documents, including the malformed ones
+    uint64_t m_bytes = 0;           ///< number of bytes consumed
+    uint64_t m_nulls = 0;           ///< number of null values
+    uint64_t m_booleans = 0;        ///< number of boolean values
+    uint64_t m_uint64s = 0;         ///< number of UInt64 values
+    uint64_t m_int64s = 0;          ///< number of Int64 values
+    uint64_t m_doubles = 0;         ///< number of Double values
+    uint64_t m_strings = 0;         ///< number of String values
+    uint64_t m_objects = 0;         ///< number of Object values
+    uint64_t m_arrays = 0;          ///< number of Array values
+    uint64_t m_keys = 0;            ///< number of object keys
+    uint64_t m_escaped_strings = 0; ///< number of strings and keys holding at least one escaped sequence
+    uint64_t m_non_ascii = 0;       ///< number of non ASCII codepoints in the strings and keys, escaped or not
+    uint64_t m_max_depth = 0;       ///< maximum nesting depth reached, 1 for a scalar document
+    uint64_t m_allocations = 0;     ///< heap allocations made while growing the scratch buffers of the strings, keys and numbers
+    uint64_t m_whitespace_ns = 0;   ///< time spent skipping white spaces, in nanoseconds
+    uint64_t m_string_ns = 0;       ///< time spent reading the strings and keys, in nanoseconds
+    uint64_t m_number_ns = 0;       ///< time spent reading the numbers, in nanoseconds
+    uint64_t m_literal_ns = 0;      ///< time spent reading true, false and null, in nanoseconds
+    uint64_t m_container_ns = 0;    ///< time spent on the structure of the objects and arrays, in nanoseconds
+};
+
+/**
+ * @brief Statistics policy of a BasicParser counting nothing
+ * 
+ * The class is empty and its hooks do nothing: a parser using it has no storage for the
+ * statistics and no counting code.
+ */
+class NoStats {
+protected:
+    /**
+     * @brief Add to a statistics counter
+     * 
+     * @param counter counter
+     * @param n increment
+     */
+    void count(uint64_t ParserStats::*counter, uint64_t n = 1) {
+        (void) counter;
+        (void) n;
+    }
+
+    /**
+     * @brief Count an allocation of a scratch buffer after an append
+     * 
+     * @param buf buffer
+     * @param capacity capacity of the buffer before the append, updated
+     */
+    void count_allocation(const std::string &buf, size_t &capacity) {
+        (void) buf;
+        (void) capacity;
+    }
+
+    /**
+     * @brief Record the current nesting depth
+     * 
+     * @param depth depth
+     */
+    void count_depth(uint64_t depth) {
+        (void) depth;
+    }
+
+    /**
+     * @brief Begin a phase of the parsing
+     * 
+     * @param phase timing of the phase
+     * @return timing of the enclosing phase, to give back to end_phase()
+     */
+    uint64_t * begin_phase(uint64_t ParserStats::*phase) {
+        (void) phase;
+        return nullptr;
+    }
+
+    /**
+     * @brief End the current phase and resume the enclosing one
+     * 
+     * @param enclosing timing of the enclosing phase, as returned by begin_phase()
+     */
+    void end_phase(uint64_t *enclosing) {
+        (void) enclosing;
+    }
+};
+
+/**
+ * @brief Statistics policy of a BasicParser counting the characteristics of the parsed documents
+ * 
+ * The timings of ParserStats stay zero.
+ */
+class CountStats : public NoStats {
+public:
+    /**
+     * @brief Get the statistics of the documents parsed since the construction or the last reset
+     * 
+     * The allocations of the documents are made by their memory resource and are not counted here.
+     * 
+     * @return statistics
+     */
+    const ParserStats & get_stats() const {
+        return m_stats;
+    }
+
+    /**
+     * @brief Reset the statistics
+     */
+    void reset_stats() {
+        m_stats = ParserStats();
+    }
+
+protected:
+    ParserStats m_stats;    ///< statistics of the parsed documents
+
+    /**
+     * @brief Add to a statistics counter
+     * 
+     * @param counter counter
+     * @param n increment
+     */
+    void count(uint64_t ParserStats::*counter, uint64_t n = 1) {
+        m_stats.*counter += n;
+    }
+
+    /**
+     * @brief Count an allocation of a scratch buffer after an append
+     * 
+     * An append of a few characters reallocates the buffer at most once, which changes its capacity.
+     * 
+     * @param buf buffer
+     * @param capacity capacity of the buffer before the append, updated
+     */
+    void count_allocation(const std::string &buf, size_t &capacity) {
+        if (buf.capacity() != capacity) {
+            capacity = buf.capacity();
+            ++m_stats.m_allocations;
+        }
+    }
+
+    /**
+     * @brief Record the current nesting depth
+     * 
+     * @param depth depth
+     */
+    void count_depth(uint64_t depth) {
+        if (depth > m_stats.m_max_depth) {
+            m_stats.m_max_depth = depth;
+        }
+    }
+};
+
+/**
+ * @brief Statistics policy of a BasicParser counting the characteristics of the parsed documents and
+ * measuring the time spent in each phase of the parsing
+ * 
+ * The timings cost a few clock reads per value.
+ */
+class TimedStats : public CountStats {
+protected:
+    /**
+     * @brief Begin a phase of the parsing
+     * 
+     * The elapsed time is charged to the enclosing phase.
+     * 
+     * @param phase timing of the phase
+     * @return timing of the enclosing phase, to give back to end_phase()
+     */
+    uint64_t * begin_phase(uint64_t ParserStats::*phase) {
+        uint64_t *enclosing = m_phase;
+        const auto now = std::chrono::steady_clock::now();
+        if (enclosing != nullptr) {
+            *enclosing += std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_mark).count();
+        }
+        m_mark = now;
+        m_phase = &(m_stats.*phase);
+        return enclosing;
+    }
+
+    /**
+     * @brief End the current phase and resume the enclosing one
+     * 
+     * The elapsed time is charged to the current phase.
+     * 
+     * @param enclosing timing of the enclosing phase, as returned by begin_phase()
+     */
+    void end_phase(uint64_t *enclosing) {
+        const auto now = std::chrono::steady_clock::now();
+        *m_phase += std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_mark).count();
+        m_mark = now;
+        m_phase = enclosing;
+    }
+
+private:
+    uint64_t *m_phase = nullptr;                    ///< timing of the current phase
+    std::chrono::steady_clock::time_point m_mark;   ///< start of the current phase
+};
+
 /**
  * @brief A JSON Parser
  * 
@@ -97,14 +485,24 @@ public:
  * When parsing numbers, integer numbers will be parsed as an Int64 or UInt64 depending
  * on the sign. Unsigned integers will allways use either UInt64.
  * 
- * For floating point values, the parser always use a double representation.
+ * For floating point values, the parser always use a double representation. A number too small
+ * for a double is rounded to a subnormal value or to zero, a number too large is malformed.
+ * 
+ * The parser can either build a Value or report parsing events to a handler.
+ * 
+ * The statistics policy is a base class of the parser. NoStats, used by Parser, is empty and
+ * counts nothing. CountStats counts the characteristics of the parsed documents and TimedStats
+ * also measures the time spent in each phase of the parsing; both provide get_stats() and
+ * reset_stats().
+ * 
+ * @tparam StatsPolicy NoStats, CountStats or TimedStats
  */
-class Parser {
+template<typename StatsPolicy> class BasicParser : public StatsPolicy {
     public:
         /**
          * @brief Construct a new parser
          */
-        Parser() : m_sv(), m_position(), m_depth(0), m_max_depth(1024) {
+        BasicParser() : m_sv(), m_position(), m_depth(0), m_max_depth(1024) {
     }
 
 
@@ -112,9 +510,45 @@ class Parser {
      * @brief Parse a document
      * 
      * @param input document, UTF-8 encoded
+     * @param resource memory resource of the strings, objects and arrays of the document,
+     *        and of the scratch memory of the parsing
      * @return JSON Value
      */
-    Value parse (const std::string &input);
+    Value parse (const std::string &input, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Parse a document and report the parsing events to a handler
+     * 
+     * The handler must provide the following methods. The positions are the positions
+     * of the first character of each value or key. Each method returns true to continue
+     * or false to stop the parsing.
+     * 
+     * @code
+     * bool null_value(Position p);
+     * bool boolean_value(bool v, Position p);
+     * bool uint64_value(uint64_t v, Position p);
+     * bool int64_value(int64_t v, Position p);
+     * bool double_value(double v, Position p);
+     * bool string_value(std::string &&v, Position p);
+     * bool begin_object(Position p);
+     * bool key(std::string &&k, Position p);   // followed by the events of the member value
+     * bool end_object();
+     * bool begin_array(Position p);
+     * bool end_array();
+     * @endcode
+     * 
+     * The events are reported as soon as they are parsed: the end of the document
+     * may still be malformed after a handler received some events.
+     * 
+     * @tparam Handler handler type
+     * @param input document, UTF-8 encoded
+     * @param handler event handler
+     * @return true if the whole document has been parsed, false if the handler stopped the parsing
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    template<typename Handler> bool parse(std::string_view input, Handler &handler);
 
     /**
      * @brief Get the maximum recursion depth
@@ -137,20 +571,51 @@ class Parser {
     void setMaxDepth(uint64_t maxDepth) {
         m_max_depth = maxDepth;
     }
-    
+
 private:
     std::string_view m_sv;      ///< remaining input data
     Position m_position;        ///< current position in the stream
     uint64_t m_depth;           ///< current recursion depth
     uint64_t m_max_depth;       ///< configured maximum recursion depth
 
+    /**
+     * @brief Time a phase of the parsing until the end of the scope, with the hooks of the statistics policy
+     * 
+     * The elapsed time is charged to the enclosing phase when the scope begins,
+     * and to this phase when it ends.
+     */
+    class PhaseScope {
+    public:
+        /**
+         * @brief Begin a phase
+         * 
+         * @param parser parser
+         * @param phase timing of the phase
+         */
+        PhaseScope(BasicParser &parser, uint64_t ParserStats::*phase) : m_parser(parser), m_enclosing(parser.begin_phase(phase)) {}
+
+        /**
+         * @brief End the phase and resume the enclosing one
+         */
+        ~PhaseScope() {
+            m_parser.end_phase(m_enclosing);
+        }
+
+        PhaseScope(const PhaseScope &) = delete;
+        PhaseScope & operator=(const PhaseScope &) = delete;
+
+    private:
+        BasicParser &m_parser;  ///< parser
+        uint64_t *m_enclosing;  ///< timing of the enclosing phase
+    };
+
     /**
      * @brief Initialize the parser for a new input
      * 
      * @param input input data
      */
-    void init(const std::string &input) {
-        m_sv = std::string_view{input};
+    void init(std::string_view input) {
+        m_sv = input;
         m_position = {1, 1, 0};
         m_depth = 0;
     }
@@ -206,61 +671,69 @@ private:
     /**
      * @brief Read a boolean "true" value from the stream
      * 
-     * @return Value (boolean true)
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_boolean_true();
+    template<typename Handler> bool read_boolean_true(Handler &h);
 
     /**
      * @brief Read a boolean "false" value from the stream
      * 
-     * @return Value (boolean false)
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_boolean_false();
+    template<typename Handler> bool read_boolean_false(Handler &h);
 
     /**
      * @brief Read a "null" value from the stream
      * 
-     * @return Value (null)
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_null();
+    template<typename Handler> bool read_null(Handler &h);
 
     
     /**
      * @brief Parse an integer number
      * 
      * @param txt the text representation of the number, assumed to be valid
-     * @return Value (UInt64 or Int64)
+     * @param p position of the number
+     * @param h event handler, receives an UInt64 or Int64
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_number_integer(const std::string &txt);
+    template<typename Handler> bool read_number_integer(const std::string &txt, Position p, Handler &h);
     
     /**
      * @brief Parse an floating point number
      * 
      * @param txt the text representation of the number, assumed to be valid
-     * @return Value (Double)
+     * @param p position of the number
+     * @param h event handler, receives a Double
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_number_floatingpoint(const std::string &txt);
+    template<typename Handler> bool read_number_floatingpoint(const std::string &txt, Position p, Handler &h);
 
     /**
      * @brief Parse a JSON number
      * 
      * This method checks the syntax of the number and call either read_number_integer or read_number_floatingpoint.
      * 
-     * @return Value (UInt64, Int64 or Double)
+     * @param h event handler, receives an UInt64, Int64 or Double
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_number();
+    template<typename Handler> bool read_number(Handler &h);
 
     /**
      * @brief Read a string from the string and unescape its content
@@ -274,41 +747,50 @@ private:
     /**
      * @brief Read a string value from the stream
      * 
-     * @return Value (String)
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_string();
+    template<typename Handler> bool read_string(Handler &h);
 
     /**
      * @brief Read a JSON array value from the stream
      * 
-     * @return Value (Array)
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_array();
+    template<typename Handler> bool read_array(Handler &h);
 
     /**
      * @brief Read a JSON obejct value from the stream
      * 
-     * @return Value (Object)
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws UTF8Exception
      */
-    Value read_object();
+    template<typename Handler> bool read_object(Handler &h);
 
     /**
      * @brief Read a JSON value from the stream
      * 
-     * @return Value
+     * @param h event handler
+     * @return false if the handler stopped the parsing
      * @throws MalFormedException
      * @throws MaximumDepthException
      * @throws UTF8Exception
      */
-    Value read_value();
+    template<typename Handler> bool read_value(Handler &h);
 };
 
+/**
+ * @brief A JSON Parser without statistics
+ */
+using Parser = BasicParser<NoStats>;
+
 }
 
 #include <mini_json/mini_json_parser_impl.h>
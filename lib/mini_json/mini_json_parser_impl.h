@@ -22,8 +22,16 @@
 
 namespace MiniJSON {
     
-inline Value Parser::parse (const std::string &input) {
+template<typename StatsPolicy> inline Value BasicParser<StatsPolicy>::parse (const std::string &input, std::pmr::memory_resource *resource) {
+    ValueBuilder builder(resource);
+    parse(input, builder);
+    return std::move(builder.get());
+}
+
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::parse(std::string_view input, Handler &handler) {
     init(input);
+    this->count(&ParserStats::m_documents);
+    PhaseScope phase(*this, &ParserStats::m_container_ns);
 
     /* eat a BOM */
     {
@@ -35,7 +43,9 @@ inline Value Parser::parse (const std::string &input) {
     }
 
     eat_ws();
-    Value v = read_value();
+    if (!read_value(handler)) {
+        return false;
+    }
     eat_ws();
 
     // if it's not the end of the document, then is malformed (only one top level value per doc)
@@ -43,10 +53,10 @@ inline Value Parser::parse (const std::string &input) {
         malformed_exception("incorrect value (more than one top level value ?)");
     }
 
-    return v;
+    return true;
 }
 
-inline bool Parser::pick_codepoint(uint32_t &cp, size_t &consumed) {
+template<typename StatsPolicy> inline bool BasicParser<StatsPolicy>::pick_codepoint(uint32_t &cp, size_t &consumed) {
     if (m_sv.size() == 0) {
         return false;
     }
@@ -58,8 +68,9 @@ inline bool Parser::pick_codepoint(uint32_t &cp, size_t &consumed) {
     return true;
 }
 
-inline void Parser::advance_codepoint(uint32_t cp, size_t consumed) {
+template<typename StatsPolicy> inline void BasicParser<StatsPolicy>::advance_codepoint(uint32_t cp, size_t consumed) {
     m_sv.remove_prefix(consumed);
+    this->count(&ParserStats::m_bytes, consumed);
     if (cp == '\n') {
         ++m_position.m_line_number;
         m_position.m_line_pos = 1;
@@ -70,7 +81,7 @@ inline void Parser::advance_codepoint(uint32_t cp, size_t consumed) {
     ++m_position.m_offset;
 }
 
-inline bool Parser::read_codepoint(uint32_t &cp) {
+template<typename StatsPolicy> inline bool BasicParser<StatsPolicy>::read_codepoint(uint32_t &cp) {
     size_t consumed;
     if (!pick_codepoint(cp, consumed)) {
         return false;
@@ -79,14 +90,15 @@ inline bool Parser::read_codepoint(uint32_t &cp) {
     return true;
 }
 
-[[ noreturn ]] inline void Parser::malformed_exception(const std::string &info) {
+template<typename StatsPolicy> [[ noreturn ]] inline void BasicParser<StatsPolicy>::malformed_exception(const std::string &info) {
     throw MalFormedException(m_position, info);
 }
 
-inline size_t Parser::eat_ws() {
+template<typename StatsPolicy> inline size_t BasicParser<StatsPolicy>::eat_ws() {
     uint32_t cp;
     size_t consumed;
     size_t n_spaces = 0;
+    PhaseScope phase(*this, &ParserStats::m_whitespace_ns);
     while (true) {
         if (!pick_codepoint(cp, consumed)) {
             return n_spaces;
@@ -101,9 +113,11 @@ inline size_t Parser::eat_ws() {
     }
 }
 
-inline Value Parser::read_boolean_true() {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_boolean_true(Handler &h) {
     uint32_t cp;
     const Position p = m_position;
+    PhaseScope phase(*this, &ParserStats::m_literal_ns);
+    this->count(&ParserStats::m_booleans);
     if (!read_codepoint(cp) || cp != 't') {
         malformed_exception("expected \"true\"");
     }
@@ -116,12 +130,14 @@ inline Value Parser::read_boolean_true() {
     if (!read_codepoint(cp) || cp != 'e') {
         malformed_exception("expected \"true\"");
     }
-    return Value(true, p);
+    return h.boolean_value(true, p);
 }
 
-inline Value Parser::read_boolean_false() {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_boolean_false(Handler &h) {
     uint32_t cp;
     const Position p = m_position;
+    PhaseScope phase(*this, &ParserStats::m_literal_ns);
+    this->count(&ParserStats::m_booleans);
     if (!read_codepoint(cp) || cp != 'f') {
         malformed_exception("expected \"false\"");
     }
@@ -137,12 +153,14 @@ inline Value Parser::read_boolean_false() {
     if (!read_codepoint(cp) || cp != 'e') {
         malformed_exception("expected \"false\"");
     }
-    return Value(false, p);
+    return h.boolean_value(false, p);
 }
 
-inline Value Parser::read_null() {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_null(Handler &h) {
     uint32_t cp;
     const Position p = m_position;
+    PhaseScope phase(*this, &ParserStats::m_literal_ns);
+    this->count(&ParserStats::m_nulls);
     if (!read_codepoint(cp) || cp != 'n') {
         malformed_exception("expected \"null\"");
     }
@@ -155,13 +173,12 @@ inline Value Parser::read_null() {
     if (!read_codepoint(cp) || cp != 'l') {
         malformed_exception("expected \"null\"");
     }
-    return Value(p);
+    return h.null_value(p);
 }
 
 
-inline Value Parser::read_number_integer(const std::string &txt) {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_number_integer(const std::string &txt, Position p, Handler &h) {
     char *endptr = NULL;
-    const Position p = m_position;
 
     if (txt.front() == '-') {
         errno = 0;
@@ -169,7 +186,8 @@ inline Value Parser::read_number_integer(const std::string &txt) {
         if (errno != 0 || endptr != txt.data() + txt.size()) {
             malformed_exception("error while parsing an integer number");
         }
-        return Value(int64_t(v), p);
+        this->count(&ParserStats::m_int64s);
+        return h.int64_value(int64_t(v), p);
     }
     else {
         errno = 0;
@@ -177,27 +195,36 @@ inline Value Parser::read_number_integer(const std::string &txt) {
         if (errno != 0 || endptr != txt.data() + txt.size()) {
             malformed_exception("error while parsing an integer number");
         }
-        return Value(uint64_t(v), p);
+        this->count(&ParserStats::m_uint64s);
+        return h.uint64_value(uint64_t(v), p);
     }
 }
 
-inline Value Parser::read_number_floatingpoint(const std::string &txt) {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_number_floatingpoint(const std::string &txt, Position p, Handler &h) {
     char *endptr = NULL;
-    const Position p = m_position;
 
     errno = 0;
     double d = strtod(txt.c_str(), &endptr);
-    if (errno != 0 || endptr != txt.data() + txt.size()) {
+    // strtod may report an underflow, whose result is still the nearest double: only an overflow is an error
+    if ((errno != 0 && !(errno == ERANGE && std::fabs(d) <= DBL_MIN)) || endptr != txt.data() + txt.size()) {
         malformed_exception("error while parsing a floating-point number");
     }
 
-    return Value(d, p);
+    this->count(&ParserStats::m_doubles);
+    return h.double_value(d, p);
 }
 
-inline Value Parser::read_number() {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_number(Handler &h) {
     std::string buf;
+    size_t capacity = buf.capacity();
     uint32_t cp;
     size_t consumed;
+    const Position p = m_position;
+    PhaseScope phase(*this, &ParserStats::m_number_ns);
+    auto push = [&](uint32_t c) {
+        buf.push_back(c & 0xFF);
+        this->count_allocation(buf, capacity);
+    };
 
 
     // minus ?
@@ -205,7 +232,7 @@ inline Value Parser::read_number() {
         malformed_exception("error while reading a number");
     }
     if (cp == '-') {
-        buf.push_back(cp & 0xFF);
+        push(cp);
         advance_codepoint(cp, consumed);
     }
 
@@ -214,19 +241,19 @@ inline Value Parser::read_number() {
         malformed_exception("error while reading a number (integral part)");
     }
     if (cp == '0') {
-        buf.push_back(cp & 0xFF);
+        push(cp);
     }
     else if (cp >= '1' && cp <= '9') {
-        buf.push_back(cp & 0xFF);
+        push(cp);
         while (true) {
             if (!pick_codepoint(cp, consumed)) {
-                return read_number_integer(buf);
+                return read_number_integer(buf, p, h);
             }
             if (!(cp >= '0' && cp <= '9')) {
                 break;
             }
             else {
-                buf.push_back(cp & 0xFF);
+                push(cp);
                 advance_codepoint(cp, consumed);
             }
         }
@@ -239,12 +266,12 @@ inline Value Parser::read_number() {
     bool is_floatting_point = false;
     // frac
     if (!pick_codepoint(cp, consumed)) {
-        return read_number_integer(buf);
+        return read_number_integer(buf, p, h);
     }
     if (cp == '.') {
         is_floatting_point = true;
         // fractional part
-        buf.push_back(cp & 0xFF);
+        push(cp);
         advance_codepoint(cp, consumed);
 
         // at least one digit
@@ -254,7 +281,7 @@ inline Value Parser::read_number() {
         if (!(cp >= '0' && cp <= '9')) {
             malformed_exception("error while reading a number (fractional part)");
         }
-        buf.push_back(cp & 0xFF);
+        push(cp);
 
         // other digits
         while (true) {
@@ -262,7 +289,7 @@ inline Value Parser::read_number() {
                 break;
             }
             if (cp >= '0' && cp <= '9') {
-                buf.push_back(cp & 0xFF);
+                push(cp);
                 advance_codepoint(cp, consumed);
             }
             else {
@@ -273,12 +300,12 @@ inline Value Parser::read_number() {
 
     // exp
     if (!pick_codepoint(cp, consumed)) {
-        return is_floatting_point ? read_number_floatingpoint(buf) : read_number_integer(buf);
+        return is_floatting_point ? read_number_floatingpoint(buf, p, h) : read_number_integer(buf, p, h);
     }
     if (cp == 'e' || cp == 'E') {
         is_floatting_point = true;
         // exponent part
-        buf.push_back(cp & 0xFF);
+        push(cp);
         advance_codepoint(cp, consumed);
 
         // sign or numbers
@@ -286,7 +313,7 @@ inline Value Parser::read_number() {
             malformed_exception("error while reading a number (exponent part)");
         }
         if (cp == '-' || cp == '+') {
-            buf.push_back(cp & 0xFF);
+            push(cp);
             if (!read_codepoint(cp)) {
                 malformed_exception("error while reading a number (exponent part)");
             }
@@ -295,7 +322,7 @@ inline Value Parser::read_number() {
         if (!(cp >= '0' && cp <= '9')) {
             malformed_exception("error while reading a number (exponent part)");
         }
-        buf.push_back(cp & 0xFF);
+        push(cp);
 
         // other digits
         while (true) {
@@ -303,7 +330,7 @@ inline Value Parser::read_number() {
                 break;
             }
             if (cp >= '0' && cp <= '9') {
-                buf.push_back(cp & 0xFF);
+                push(cp);
                 advance_codepoint(cp, consumed);
             }
             else {
@@ -312,13 +339,16 @@ inline Value Parser::read_number() {
         }
     }
 
-    return is_floatting_point ? read_number_floatingpoint(buf) : read_number_integer(buf);
+    return is_floatting_point ? read_number_floatingpoint(buf, p, h) : read_number_integer(buf, p, h);
 }
 
-inline std::string Parser::read_string_() {
+template<typename StatsPolicy> inline std::string BasicParser<StatsPolicy>::read_string_() {
     std::string ret;
+    size_t capacity = ret.capacity();
     uint32_t cp, v;
     uint32_t x1, x2, x3, x4;
+    bool escaped = false;
+    PhaseScope phase(*this, &ParserStats::m_string_ns);
 
     auto is_valid_hexa = [](uint32_t v) {
         return (v >= '0' && v <= '9') || (v >= 'a' && v <= 'f') || (v >= 'A' && v <= 'F');
@@ -355,6 +385,7 @@ inline std::string Parser::read_string_() {
         }
 
         if (cp == '\\') {
+            escaped = true;
             if (!read_codepoint(cp)) {
                 malformed_exception("error while reading a string (invalid escaped sequence)");
             }
@@ -418,28 +449,37 @@ inline std::string Parser::read_string_() {
             else {
                 malformed_exception("error while reading a string (invalid escaped sequence)");
             }
+            this->count(&ParserStats::m_non_ascii, v > 0x7F);
             UTF::encode_utf8(&v, 1, std::back_inserter(ret), NULL, NULL);
+            this->count_allocation(ret, capacity);
         }
         else {
+            this->count(&ParserStats::m_non_ascii, cp > 0x7F);
             UTF::encode_utf8(&cp, 1, std::back_inserter(ret), NULL, NULL);
+            this->count_allocation(ret, capacity);
         }
     }
 
+    this->count(&ParserStats::m_escaped_strings, escaped);
     return ret;
 }
 
-inline Value Parser::read_string() {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_string(Handler &h) {
     const Position p = m_position;
-    return Value(read_string_(), p);
+    PhaseScope phase(*this, &ParserStats::m_string_ns);
+    this->count(&ParserStats::m_strings);
+    return h.string_value(read_string_(), p);
 }
 
-inline Value Parser::read_array() {
-    Value ret = Value::new_array();
-    ret.set_position(m_position);
-    auto &array_content = ret.get<Type::Array>();
-
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_array(Handler &h) {
     uint32_t cp;
     size_t consumed;
+    PhaseScope phase(*this, &ParserStats::m_container_ns);
+    this->count(&ParserStats::m_arrays);
+
+    if (!h.begin_array(m_position)) {
+        return false;
+    }
 
     if (!read_codepoint(cp) || cp != '[') {
         malformed_exception("error while reading an array");
@@ -451,12 +491,14 @@ inline Value Parser::read_array() {
     }
     if (cp == ']') {
         advance_codepoint(cp, consumed);
-        return ret;
+        return h.end_array();
     }
 
     while (true) {
         eat_ws();
-        array_content.push_back(read_value());
+        if (!read_value(h)) {
+            return false;
+        }
         eat_ws();
 
         if (!read_codepoint(cp)) {
@@ -470,17 +512,18 @@ inline Value Parser::read_array() {
         }
     }
 
-    return ret;
+    return h.end_array();
 }
 
-inline Value Parser::read_object() {
-    Value ret = Value::new_object();
-    ret.set_position(m_position);
-    auto &object_content = ret.get<Type::Object>();
-
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_object(Handler &h) {
     uint32_t cp;
     size_t consumed;
-    std::string key;
+    PhaseScope phase(*this, &ParserStats::m_container_ns);
+    this->count(&ParserStats::m_objects);
+
+    if (!h.begin_object(m_position)) {
+        return false;
+    }
 
     if (!read_codepoint(cp) || cp != '{') {
         malformed_exception("error while reading an object");
@@ -492,18 +535,25 @@ inline Value Parser::read_object() {
     }
     if (cp == '}') {
         advance_codepoint(cp, consumed);
-        return ret;
+        return h.end_object();
     }
 
     while (true) {
         eat_ws();
-        key = read_string_();
+        const Position key_position = m_position;
+        std::string key = read_string_();
+        this->count(&ParserStats::m_keys);
         eat_ws();
         if (!read_codepoint(cp) || cp != ':') {
             malformed_exception("error while reading an object");
         }
+        if (!h.key(std::move(key), key_position)) {
+            return false;
+        }
         eat_ws();
-        object_content[key] = read_value();
+        if (!read_value(h)) {
+            return false;
+        }
         eat_ws();
 
         if (!read_codepoint(cp)) {
@@ -517,10 +567,10 @@ inline Value Parser::read_object() {
         }
     }
 
-    return ret;
+    return h.end_object();
 }
 
-inline Value Parser::read_value() {
+template<typename StatsPolicy> template<typename Handler> bool BasicParser<StatsPolicy>::read_value(Handler &h) {
     uint32_t cp;
     size_t consumed;
     if (m_depth == m_max_depth) {
@@ -535,30 +585,31 @@ inline Value Parser::read_value() {
             --m_d;
         }
     } depth(m_depth);
+    this->count_depth(m_depth);
 
     if (!pick_codepoint(cp, consumed)) {
         malformed_exception("expected a JSON value");
     }
     if (cp == '\"') {
-        return read_string();
+        return read_string(h);
     }
     if (cp == 'f') {
-        return read_boolean_false();
+        return read_boolean_false(h);
     }
     if (cp == 't') {
-        return read_boolean_true();
+        return read_boolean_true(h);
     }
     if (cp == 'n') {
-        return read_null();
+        return read_null(h);
     }
     if (cp == '-' || (cp >= '0' && cp <= '9')) {
-        return read_number();
+        return read_number(h);
     }
     if (cp == '{') {
-        return read_object();
+        return read_object(h);
     }
     if (cp == '[') {
-        return read_array();
+        return read_array(h);
     }
 
     malformed_exception("expected a JSON value");
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H3993E9C5_5D4D_4E7C_A786_A41D8B5F1AC8
+#define H3993E9C5_5D4D_4E7C_A786_A41D8B5F1AC8
+
+#include <cstddef>
+
+#include <string>
+#include <exception>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_pointer.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Thrown when a JSON Patch can't be applied
+ *
+ */
+class PatchException : public std::exception {
+    std::string m_msg;
+public:
+    /**
+     * @brief Build a new PatchException
+     *
+     * @param info message
+     */
+    PatchException(const std::string &info) : m_msg() {
+        m_msg = std::string("Can't apply JSON Patch: ") + info;
+    }
+    /**
+     * @brief Build a new PatchException
+     *
+     * @param operation index of the failing operation
+     * @param info message
+     */
+    PatchException(size_t operation, const std::string &info) : m_msg() {
+        m_msg = std::string("Can't apply JSON Patch, operation ") + std::to_string(operation) + ": " + info;
+    }
+
+    /**
+     * @brief returns an explanatory string
+     *
+     * @return message
+     */
+    const virtual char* what() const noexcept override {
+        return m_msg.c_str();
+    }
+};
+
+/**
+ * @brief Strategy used by Patch::diff() to align the elements of two arrays
+ */
+enum class ArrayDiff {
+    Positional, ///< the elements are compared index by index, after removing the common prefix and suffix
+    LCS         ///< the elements are aligned on a longest common subsequence of their hashes
+};
+
+/**
+ * @brief JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7386)
+ *
+ * The patches are applied in place. When the patch is an rvalue, the values it carries are
+ * moved into the document instead of being copied; "move" operations never copy their subtree.
+ *
+ * This class has no state, so all methods are static.
+ */
+class Patch {
+public:
+    /**
+     * @brief Maximum size of the table of the LCS alignment of two arrays
+     *
+     * Beyond this number of cells ((n + 1) * (m + 1) for the n and m elements left after removing the
+     * common prefix and suffix), the arrays are compared index by index.
+     */
+    static constexpr size_t LCS_MAX_CELLS = size_t(1) << 22;
+
+    /**
+     * @brief Compute a JSON Patch transforming a document into another one
+     *
+     * The hashes of all the subtrees of both documents are computed once (see Value::hash()),
+     * so that different subtrees are detected in O(1) and identical subtrees are skipped after
+     * a single comparison. The members of two objects are aligned by a merge of their sorted
+     * keys. Values of different types are replaced.
+     *
+     * The patch only uses the "add", "remove" and "replace" operations, with explicit array
+     * indexes. Applying it to from yields a document equal to to.
+     *
+     * @param from source document
+     * @param to target document
+     * @param arrays alignment strategy for the arrays
+     * @return patch, an array of operations
+     */
+    static Value diff(const Value &from, const Value &to, ArrayDiff arrays = ArrayDiff::LCS);
+
+    /**
+     * @brief Apply a JSON Patch to a document
+     *
+     * All the operations of RFC 6902 are supported: add, remove, replace, move, copy and test.
+     *
+     * When atomic is true, the previous content of every modified location is kept (moved, not
+     * copied) until the whole patch succeeds, and the document is restored if an operation
+     * fails. Otherwise, the operations preceding the failing one remain applied.
+     *
+     * @param doc document, modified in place
+     * @param patch patch, an array of operations
+     * @param atomic restore the document if the patch fails
+     * @throws PatchException if the patch is malformed or an operation fails
+     */
+    static void apply(Value &doc, const Value &patch, bool atomic = true) {
+        apply_operations(doc, patch, atomic);
+    }
+
+    /**
+     * @brief Apply a JSON Patch to a document, moving the values out of the patch
+     *
+     * @param doc document, modified in place
+     * @param patch patch, an array of operations, left in an unspecified state
+     * @param atomic restore the document if the patch fails
+     * @throws PatchException if the patch is malformed or an operation fails
+     */
+    static void apply(Value &doc, Value &&patch, bool atomic = true) {
+        apply_operations(doc, patch, atomic);
+    }
+
+    /**
+     * @brief Apply a JSON Merge Patch to a document
+     *
+     * The members of an object patch are merged recursively, the null members are removed
+     * from the document. Any other patch replaces the document.
+     *
+     * @param doc document, modified in place
+     * @param patch merge patch
+     */
+    static void merge(Value &doc, const Value &patch) {
+        merge_values(doc, patch);
+    }
+
+    /**
+     * @brief Apply a JSON Merge Patch to a document, moving the values out of the patch
+     *
+     * @param doc document, modified in place
+     * @param patch merge patch, left in an unspecified state
+     */
+    static void merge(Value &doc, Value &&patch) {
+        merge_values(doc, patch);
+    }
+
+private:
+    class Differ;
+    class Applier;
+
+    /**
+     * @brief Apply a JSON Patch
+     *
+     * @tparam PatchValue Value or const Value, the values are moved out of a non-const patch
+     * @param doc document
+     * @param patch patch
+     * @param atomic restore the document if the patch fails
+     */
+    template<typename PatchValue>
+    static void apply_operations(Value &doc, PatchValue &patch, bool atomic);
+
+    /**
+     * @brief Apply a JSON Merge Patch
+     *
+     * @tparam PatchValue Value or const Value, the values are moved out of a non-const patch
+     * @param doc document
+     * @param patch merge patch
+     */
+    template<typename PatchValue>
+    static void merge_values(Value &doc, PatchValue &patch);
+
+    /**
+     * @brief Copy a value out of a const patch, or move it out of a non-const patch
+     *
+     * @param v value of the patch
+     * @return value
+     */
+    static Value take(const Value &v) {
+        return v;
+    }
+    /**
+     * @brief Copy a value out of a const patch, or move it out of a non-const patch
+     *
+     * @param v value of the patch
+     * @return value
+     */
+    static Value take(Value &v) {
+        return std::move(v);
+    }
+};
+
+}
+
+#include <mini_json/mini_json_patch_impl.h>
+
+#endif /* H3993E9C5_5D4D_4E7C_A786_A41D8B5F1AC8 */
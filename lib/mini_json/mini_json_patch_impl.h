@@ -0,0 +1,678 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HB9A59D36_CD43_4899_AC2B_8D659E5F497C
+#define HB9A59D36_CD43_4899_AC2B_8D659E5F497C
+
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <mini_json/mini_json_patch.h>
+#include <mini_json/mini_json_pointer.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief State of a diff: the cached hashes of the subtrees and the operations produced
+ */
+class Patch::Differ {
+public:
+    /**
+     * @brief Prepare a diff
+     *
+     * @param arrays alignment strategy for the arrays
+     */
+    explicit Differ(ArrayDiff arrays) : m_arrays(arrays), m_hashes(), m_ops(Value::new_array()) {}
+
+    /**
+     * @brief Append the operations transforming a value into another one
+     *
+     * @param from source value
+     * @param to target value
+     * @param path pointer to the value, it is restored before returning
+     */
+    void diff(const Value &from, const Value &to, std::string &path) {
+        if (same(from, to)) {
+            return;
+        }
+        const Type t = from.get_type();
+        if (t != to.get_type() || !(t & MASK_TYPE_IS_CONTAINER)) {
+            emit("replace", path, &to);
+            return;
+        }
+        if (t == Type::Object) {
+            diff_objects(from.get<Type::Object>(), to.get<Type::Object>(), path);
+        }
+        else {
+            diff_arrays(from.get<Type::Array>(), to.get<Type::Array>(), path);
+        }
+    }
+
+    /**
+     * @brief Returns the operations
+     *
+     * @return array of operations
+     */
+    Value & ops() {
+        return m_ops;
+    }
+
+private:
+    ArrayDiff m_arrays;                                 ///< alignment strategy for the arrays
+    std::unordered_map<const Value *, size_t> m_hashes; ///< hashes of the containers already visited
+    Value m_ops;                                        ///< operations produced
+
+    /**
+     * @brief Returns the hash of a value, consistent with Value::hash()
+     *
+     * The hashes of the containers are computed once, with all their descendants.
+     */
+    size_t hash(const Value &v) {
+        static constexpr uint64_t HASH_OBJECT = 0x6F626A65ULL;
+        static constexpr uint64_t HASH_ARRAY = 0x61727261ULL;
+
+        const Type t = v.get_type();
+        if (!(t & MASK_TYPE_IS_CONTAINER)) {
+            return Value::hash_scalar(v);
+        }
+        auto it = m_hashes.find(&v);
+        if (it != m_hashes.end()) {
+            return it->second;
+        }
+        size_t h;
+        if (t == Type::Object) {
+            h = Value::hash_mix(HASH_OBJECT);
+            for (const auto &m : v.get<Type::Object>()) {
+                h = Value::hash_combine(h, std::hash<std::string_view>()(m.first));
+                h = Value::hash_combine(h, hash(m.second));
+            }
+        }
+        else {
+            h = Value::hash_mix(HASH_ARRAY);
+            for (const auto &e : v.get<Type::Array>()) {
+                h = Value::hash_combine(h, hash(e));
+            }
+        }
+        m_hashes.emplace(&v, h);
+        return h;
+    }
+
+    /**
+     * @brief Test whether two values are equal, the hashes are compared first
+     */
+    bool same(const Value &a, const Value &b) {
+        return hash(a) == hash(b) && a == b;
+    }
+
+    /**
+     * @brief Append an operation
+     *
+     * @param op name of the operation
+     * @param path target of the operation
+     * @param value value of the operation, nullptr for "remove"
+     */
+    void emit(const char *op, const std::string &path, const Value *value) {
+        Value o = Value::new_object();
+        o["op"] = op;
+        o["path"] = path;
+        if (value != nullptr) {
+            o["value"] = *value;
+        }
+        m_ops.get<Type::Array>().push_back(std::move(o));
+    }
+
+    /**
+     * @brief Append the operations transforming an object into another one
+     */
+    void diff_objects(const ObjectValues &from, const ObjectValues &to, std::string &path) {
+        const size_t length = path.size();
+        auto a = from.begin();
+        auto b = to.begin();
+        // both maps are sorted by key
+        while (a != from.end() || b != to.end()) {
+            path += '/';
+            if (b == to.end() || (a != from.end() && a->first < b->first)) {
+                path += Pointer::escape(a->first);
+                emit("remove", path, nullptr);
+                ++a;
+            }
+            else if (a == from.end() || b->first < a->first) {
+                path += Pointer::escape(b->first);
+                emit("add", path, &b->second);
+                ++b;
+            }
+            else {
+                path += Pointer::escape(a->first);
+                diff(a->second, b->second, path);
+                ++a;
+                ++b;
+            }
+            path.resize(length);
+        }
+    }
+
+    /**
+     * @brief Append the operations transforming an array into another one
+     */
+    void diff_arrays(const ArrayValues &from, const ArrayValues &to, std::string &path) {
+        std::vector<const Value *> a, b;
+        a.reserve(from.size());
+        b.reserve(to.size());
+        for (const Value &e : from) {
+            a.push_back(&e);
+        }
+        for (const Value &e : to) {
+            b.push_back(&e);
+        }
+
+        // common prefix and suffix
+        size_t prefix = 0;
+        while (prefix < a.size() && prefix < b.size() && same(*a[prefix], *b[prefix])) {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while (suffix < a.size() - prefix && suffix < b.size() - prefix
+            && same(*a[a.size() - 1 - suffix], *b[b.size() - 1 - suffix])) {
+            ++suffix;
+        }
+        const size_t n = a.size() - prefix - suffix;
+        const size_t m = b.size() - prefix - suffix;
+
+        // pairs of remaining elements left unchanged by the alignment, none when comparing index by index
+        std::vector<std::pair<size_t, size_t>> kept;
+        if (m_arrays == ArrayDiff::LCS && n != 0 && m != 0 && (n + 1) <= LCS_MAX_CELLS / (m + 1)) {
+            kept = lcs(a, b, prefix, n, m);
+        }
+
+        // the runs of removals and insertions between two kept pairs are first paired
+        // and diffed, then the extra elements are removed or inserted
+        size_t index = prefix;
+        size_t i = 0;
+        size_t j = 0;
+        kept.emplace_back(n, m);
+        for (const auto &k : kept) {
+            while (i < k.first && j < k.second) {
+                diff_element(*a[prefix + i++], *b[prefix + j++], index++, path);
+            }
+            while (i < k.first) {
+                emit_element("remove", index, nullptr, path);
+                ++i;
+            }
+            while (j < k.second) {
+                emit_element("add", index++, b[prefix + j++], path);
+            }
+            if (i < n) {
+                // the kept pair has the same hash, diff() is a no-op unless there is a collision
+                diff_element(*a[prefix + i++], *b[prefix + j++], index++, path);
+            }
+        }
+    }
+
+    /**
+     * @brief Find a longest common subsequence of the hashes of two ranges of elements
+     *
+     * @return pairs of indexes in the ranges, in increasing order
+     */
+    std::vector<std::pair<size_t, size_t>> lcs(const std::vector<const Value *> &a, const std::vector<const Value *> &b,
+                                               size_t offset, size_t n, size_t m) {
+        std::vector<size_t> ha(n), hb(m);
+        for (size_t i = 0; i < n; ++i) {
+            ha[i] = hash(*a[offset + i]);
+        }
+        for (size_t j = 0; j < m; ++j) {
+            hb[j] = hash(*b[offset + j]);
+        }
+        // table[i][j] is the length of the LCS of the suffixes a[i..] and b[j..]
+        const size_t width = m + 1;
+        std::vector<uint32_t> table((n + 1) * width, 0);
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = m; j-- > 0;) {
+                table[i * width + j] = ha[i] == hb[j]
+                    ? table[(i + 1) * width + j + 1] + 1
+                    : std::max(table[(i + 1) * width + j], table[i * width + j + 1]);
+            }
+        }
+        std::vector<std::pair<size_t, size_t>> kept;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < n && j < m) {
+            if (ha[i] == hb[j]) {
+                kept.emplace_back(i++, j++);
+            }
+            else if (table[(i + 1) * width + j] >= table[i * width + j + 1]) {
+                ++i;
+            }
+            else {
+                ++j;
+            }
+        }
+        return kept;
+    }
+
+    /**
+     * @brief Append the operations transforming an element of an array
+     */
+    void diff_element(const Value &from, const Value &to, size_t index, std::string &path) {
+        const size_t length = path.size();
+        path += '/';
+        path += std::to_string(index);
+        diff(from, to, path);
+        path.resize(length);
+    }
+
+    /**
+     * @brief Append an operation on an element of an array
+     */
+    void emit_element(const char *op, size_t index, const Value *value, std::string &path) {
+        const size_t length = path.size();
+        path += '/';
+        path += std::to_string(index);
+        emit(op, path, value);
+        path.resize(length);
+    }
+};
+
+inline Value Patch::diff(const Value &from, const Value &to, ArrayDiff arrays) {
+    Differ differ(arrays);
+    std::string path;
+    differ.diff(from, to, path);
+    return std::move(differ.ops());
+}
+
+
+/**
+ * @brief Primitive modifications of a document, with an optional undo log
+ */
+class Patch::Applier {
+public:
+    /**
+     * @brief Prepare the modification of a document
+     *
+     * @param doc document
+     * @param atomic record the undo log
+     */
+    Applier(Value &doc, bool atomic) : m_doc(doc), m_atomic(atomic), m_undo(), m_removed(), m_operation(0) {}
+
+    /**
+     * @brief Set the index of the current operation, for the error messages
+     *
+     * @param operation index of the operation
+     */
+    void set_operation(size_t operation) {
+        m_operation = operation;
+    }
+
+    /**
+     * @brief Throw an exception for the current operation
+     *
+     * @param info message
+     * @throws PatchException
+     */
+    [[noreturn]] void fail(const std::string &info) const {
+        throw PatchException(m_operation, info);
+    }
+
+    /**
+     * @brief Add a value: set a member of an object or insert an element in an array
+     *
+     * @param path location of the new value, "-" designates the end of an array
+     * @param v value
+     */
+    void add(const Pointer &path, Value &&v) {
+        if (path.empty()) {
+            replace(path, std::move(v));
+            return;
+        }
+        Value *parent = resolve_parent(path);
+        const Pointer::Token &t = path.tokens().back();
+        if (parent->get_type() == Type::Object) {
+            ObjectValues &map = parent->get<Type::Object>();
+            auto it = map.find(t.key().view());
+            if (it != map.end()) {
+                log(Undo::Replace, path, std::move(it->second));
+                it->second = std::move(v);
+            }
+            else {
+                map.emplace(t.key().str(), std::move(v));
+                log(Undo::Erase, path, Value());
+            }
+        }
+        else if (parent->get_type() == Type::Array) {
+            ArrayValues &list = parent->get<Type::Array>();
+            const size_t index = t.is_end() ? list.size() : t.index();
+            if (index > list.size()) {
+                fail("index out of range at \"" + path.to_string() + "\"");
+            }
+            list.insert(std::next(list.begin(), static_cast<ptrdiff_t>(index)), std::move(v));
+            log(Undo::Erase, t.is_end() ? path.parent().child(index) : path, Value());
+        }
+        else {
+            fail("the parent of \"" + path.to_string() + "\" is not a container");
+        }
+    }
+
+    /**
+     * @brief Remove a value
+     *
+     * @param path location of the value
+     * @return removed value
+     */
+    Value remove(const Pointer &path) {
+        if (path.empty()) {
+            fail("the whole document can't be removed");
+        }
+        Value *parent = resolve_parent(path);
+        const Pointer::Token &t = path.tokens().back();
+        Value ret;
+        if (parent->get_type() == Type::Object) {
+            ObjectValues &map = parent->get<Type::Object>();
+            auto it = map.find(t.key().view());
+            if (it == map.end()) {
+                fail("no value at \"" + path.to_string() + "\"");
+            }
+            ret = std::move(it->second);
+            map.erase(it);
+        }
+        else if (parent->get_type() == Type::Array) {
+            ArrayValues &list = parent->get<Type::Array>();
+            if (t.index() >= list.size()) {
+                fail("no value at \"" + path.to_string() + "\"");
+            }
+            auto it = std::next(list.begin(), static_cast<ptrdiff_t>(t.index()));
+            ret = std::move(*it);
+            list.erase(it);
+        }
+        else {
+            fail("no value at \"" + path.to_string() + "\"");
+        }
+        m_removed = path;
+        return ret;
+    }
+
+    /**
+     * @brief Record the undo of the last remove(), when its value is discarded
+     *
+     * @param v removed value
+     */
+    void discard(Value &&v) {
+        log(Undo::Insert, m_removed, std::move(v));
+    }
+
+    /**
+     * @brief Move a value to another location
+     *
+     * If the value can't be added at its new location, it is put back at its previous one.
+     *
+     * @param from location of the value
+     * @param path new location of the value
+     */
+    void move(const Pointer &from, const Pointer &path) {
+        Value v = remove(from);
+        log(Undo::InsertMoved, from, Value());
+        try {
+            add(path, std::move(v));
+        }
+        catch (const PatchException &) {
+            // add() checks the location before taking the value
+            if (m_atomic) {
+                m_undo.pop_back();
+            }
+            insert(from, std::move(v));
+            throw;
+        }
+    }
+
+    /**
+     * @brief Replace an existing value
+     *
+     * @param path location of the value
+     * @param v new value
+     */
+    void replace(const Pointer &path, Value &&v) {
+        Value *target = path.resolve(m_doc);
+        if (target == nullptr) {
+            fail("no value at \"" + path.to_string() + "\"");
+        }
+        log(Undo::Replace, path, std::move(*target));
+        *target = std::move(v);
+    }
+
+    /**
+     * @brief Returns the document
+     *
+     * @return document
+     */
+    Value & doc() {
+        return m_doc;
+    }
+
+    /**
+     * @brief Restore the document, undoing the modifications in reverse order
+     */
+    void rollback() {
+        // a value taken from the document by an undo step, for the next InsertMoved step
+        Value carried;
+        while (!m_undo.empty()) {
+            Step &step = m_undo.back();
+            switch (step.m_kind) {
+            case Undo::Erase:
+                carried = extract(step.m_path);
+                break;
+            case Undo::Insert:
+                insert(step.m_path, std::move(step.m_value));
+                break;
+            case Undo::InsertMoved:
+                insert(step.m_path, std::move(carried));
+                break;
+            case Undo::Replace:
+            {
+                Value *target = step.m_path.resolve(m_doc);
+                carried = std::move(*target);
+                *target = std::move(step.m_value);
+                break;
+            }
+            }
+            m_undo.pop_back();
+        }
+    }
+
+private:
+    /**
+     * @brief Kind of an undo step
+     */
+    enum class Undo {
+        Erase,          ///< remove an added value
+        Insert,         ///< insert back a removed value
+        InsertMoved,    ///< insert back a moved value, taken by the previous undo step
+        Replace         ///< restore a replaced value
+    };
+
+    /**
+     * @brief An undo step
+     */
+    struct Step {
+        Undo m_kind;        ///< kind of the step
+        Pointer m_path;     ///< location, array indexes are explicit
+        Value m_value;      ///< previous value, for Insert and Replace
+    };
+
+    Value &m_doc;               ///< document
+    bool m_atomic;              ///< record the undo log
+    std::vector<Step> m_undo;   ///< undo log
+    Pointer m_removed;          ///< location of the last removed value
+    size_t m_operation;         ///< index of the current operation
+
+    /**
+     * @brief Append an undo step if the undo log is enabled
+     */
+    void log(Undo kind, const Pointer &path, Value &&v) {
+        if (m_atomic) {
+            m_undo.push_back({kind, path, std::move(v)});
+        }
+    }
+
+    /**
+     * @brief Resolve the parent of a location, which must exist
+     */
+    Value * resolve_parent(const Pointer &path) {
+        Value *parent = path.parent().resolve(m_doc);
+        if (parent == nullptr) {
+            fail("the parent of \"" + path.to_string() + "\" does not exist");
+        }
+        return parent;
+    }
+
+    /**
+     * @brief Remove a value known to exist, while rolling back
+     */
+    Value extract(const Pointer &path) {
+        Value &parent = *path.parent().resolve(m_doc);
+        const Pointer::Token &t = path.tokens().back();
+        Value ret;
+        if (parent.get_type() == Type::Object) {
+            ObjectValues &map = parent.get<Type::Object>();
+            auto it = map.find(t.key().view());
+            ret = std::move(it->second);
+            map.erase(it);
+        }
+        else {
+            ArrayValues &list = parent.get<Type::Array>();
+            auto it = std::next(list.begin(), static_cast<ptrdiff_t>(t.index()));
+            ret = std::move(*it);
+            list.erase(it);
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Insert a value at a location known to be valid, while rolling back
+     */
+    void insert(const Pointer &path, Value &&v) {
+        Value &parent = *path.parent().resolve(m_doc);
+        const Pointer::Token &t = path.tokens().back();
+        if (parent.get_type() == Type::Object) {
+            parent.get<Type::Object>().emplace(t.key().str(), std::move(v));
+        }
+        else {
+            ArrayValues &list = parent.get<Type::Array>();
+            list.insert(std::next(list.begin(), static_cast<ptrdiff_t>(t.index())), std::move(v));
+        }
+    }
+};
+
+template<typename PatchValue>
+inline void Patch::apply_operations(Value &doc, PatchValue &patch, bool atomic) {
+    if (patch.get_type() != Type::Array) {
+        throw PatchException("the patch is not an array");
+    }
+    Applier applier(doc, atomic);
+    auto member = [&applier](auto &op, std::string_view key) {
+        auto *ret = op.find(key);
+        if (ret == nullptr || (key != "value" && ret->get_type() != Type::String)) {
+            applier.fail("missing or invalid \"" + std::string(key) + "\"");
+        }
+        return ret;
+    };
+    auto pointer = [&applier](const Value &text) {
+        try {
+            return Pointer(text.get<Type::String>());
+        }
+        catch (const PointerSyntaxException &e) {
+            applier.fail(e.what());
+        }
+    };
+
+    size_t n = 0;
+    try {
+        for (auto &op : patch.template get<Type::Array>()) {
+            applier.set_operation(n++);
+            const auto &name = member(op, "op")->template get<Type::String>();
+            const Pointer path = pointer(*member(op, "path"));
+            if (name == "add") {
+                applier.add(path, take(*member(op, "value")));
+            }
+            else if (name == "remove") {
+                applier.discard(applier.remove(path));
+            }
+            else if (name == "replace") {
+                applier.replace(path, take(*member(op, "value")));
+            }
+            else if (name == "move") {
+                const Pointer from = pointer(*member(op, "from"));
+                if (from == path) {
+                    continue;
+                }
+                if (from.size() < path.size()
+                    && std::equal(from.tokens().begin(), from.tokens().end(), path.tokens().begin(),
+                                  [](const Pointer::Token &x, const Pointer::Token &y) { return x.key() == y.key(); })) {
+                    applier.fail("a value can't be moved into one of its children");
+                }
+                applier.move(from, path);
+            }
+            else if (name == "copy") {
+                const Pointer from = pointer(*member(op, "from"));
+                const Value *source = from.resolve(static_cast<const Value &>(applier.doc()));
+                if (source == nullptr) {
+                    applier.fail("no value at \"" + from.to_string() + "\"");
+                }
+                applier.add(path, Value(*source));
+            }
+            else if (name == "test") {
+                const Value *target = path.resolve(static_cast<const Value &>(applier.doc()));
+                if (target == nullptr || !(*target == *member(op, "value"))) {
+                    applier.fail("test failed at \"" + path.to_string() + "\"");
+                }
+            }
+            else {
+                applier.fail("unknown operation \"" + std::string(name) + "\"");
+            }
+        }
+    }
+    catch (...) {
+        applier.rollback();
+        throw;
+    }
+}
+
+template<typename PatchValue>
+inline void Patch::merge_values(Value &doc, PatchValue &patch) {
+    if (patch.get_type() != Type::Object) {
+        doc = take(patch);
+        return;
+    }
+    if (doc.get_type() != Type::Object) {
+        doc = Value::new_object();
+    }
+    ObjectValues &map = doc.get<Type::Object>();
+    for (auto &m : patch.template get<Type::Object>()) {
+        if (m.second.get_type() == Type::Null) {
+            map.erase(m.first);
+        }
+        else {
+            auto it = map.find(m.first);
+            if (it == map.end()) {
+                // merged into null, so that the null members of an object patch are dropped
+                it = map.emplace(m.first, Value()).first;
+            }
+            merge_values(it->second, m.second);
+        }
+    }
+}
+
+}
+
+#endif /* HB9A59D36_CD43_4899_AC2B_8D659E5F497C */
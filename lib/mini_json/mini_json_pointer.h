@@ -0,0 +1,264 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H31BAB5EF_174F_43EB_A0ED_B14496731D72
+#define H31BAB5EF_174F_43EB_A0ED_B14496731D72
+
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <exception>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_snapshot.h>
+#include <mini_json/mini_json_key.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Thrown when a JSON Pointer is not valid
+ *
+ */
+class PointerSyntaxException : public std::exception {
+    std::string m_msg;
+public:
+    /**
+     * @brief Build a new PointerSyntaxException
+     *
+     * @param offset offset of the error in the pointer
+     * @param info message
+     */
+    PointerSyntaxException(size_t offset, const std::string &info) : m_msg() {
+        m_msg = std::string("Invalid JSON Pointer at offset ") + std::to_string(offset) + ": " + info;
+    }
+
+    /**
+     * @brief returns an explanatory string
+     *
+     * @return message
+     */
+    const virtual char* what() const noexcept override {
+        return m_msg.c_str();
+    }
+};
+
+/**
+ * @brief A compiled JSON Pointer (RFC 6901)
+ *
+ * The pointer is parsed once into a list of reference tokens. Each token keeps its unescaped
+ * key with its precomputed hash and, if the token is a valid array index, its numeric value.
+ * Resolving a pointer against a document does not allocate memory.
+ *
+ * A Pointer is immutable and can be shared between threads.
+ */
+class Pointer {
+public:
+    /**
+     * @brief A reference token
+     */
+    class Token {
+    public:
+        /**
+         * @brief Value of index() when the token is not an array index
+         */
+        static constexpr size_t NOT_AN_INDEX = static_cast<size_t>(-1);
+
+        /**
+         * @brief Build a token from its unescaped key
+         *
+         * @param key unescaped key
+         */
+        explicit Token(std::string_view key);
+        /**
+         * @brief Build a token from an array index
+         *
+         * @param index array index
+         */
+        explicit Token(size_t index) : m_key(std::to_string(index)), m_index(index) {}
+
+        /**
+         * @brief Returns the unescaped key
+         *
+         * @return key
+         */
+        const Key & key() const noexcept {
+            return m_key;
+        }
+        /**
+         * @brief Returns the array index represented by this token
+         *
+         * @return index or NOT_AN_INDEX
+         */
+        size_t index() const noexcept {
+            return m_index;
+        }
+        /**
+         * @brief Test whether this token is "-", the position after the last element of an array
+         *
+         * @return true if the token is "-"
+         */
+        bool is_end() const noexcept {
+            return m_key.view() == "-";
+        }
+
+    private:
+        Key m_key;          ///< unescaped key, with its hash
+        size_t m_index;     ///< array index, or NOT_AN_INDEX
+    };
+
+    /**
+     * @brief Build the empty pointer, referencing the whole document
+     */
+    Pointer() : m_tokens() {}
+
+    /**
+     * @brief Compile a JSON Pointer
+     *
+     * @param text pointer, "" or a sequence of "/" followed by an escaped reference token
+     * @throws PointerSyntaxException if the pointer is not valid
+     */
+    explicit Pointer(std::string_view text);
+
+    /**
+     * @brief Build a pointer from its reference tokens
+     *
+     * @param tokens reference tokens
+     */
+    explicit Pointer(std::vector<Token> tokens) : m_tokens(std::move(tokens)) {}
+
+    /**
+     * @brief Returns the reference tokens
+     *
+     * @return tokens
+     */
+    const std::vector<Token> & tokens() const noexcept {
+        return m_tokens;
+    }
+
+    /**
+     * @brief Returns the number of reference tokens
+     *
+     * @return number of tokens
+     */
+    size_t size() const noexcept {
+        return m_tokens.size();
+    }
+
+    /**
+     * @brief Test whether this pointer references the whole document
+     *
+     * @return true if there are no reference tokens
+     */
+    bool empty() const noexcept {
+        return m_tokens.empty();
+    }
+
+    /**
+     * @brief Returns the pointer to the parent of the referenced value
+     *
+     * The parent of the empty pointer is the empty pointer.
+     *
+     * @return parent pointer
+     */
+    Pointer parent() const;
+
+    /**
+     * @brief Returns the pointer to a member of the referenced value
+     *
+     * @param key unescaped key
+     * @return child pointer
+     */
+    Pointer child(std::string_view key) const;
+
+    /**
+     * @brief Returns the pointer to an element of the referenced value
+     *
+     * @param index array index
+     * @return child pointer
+     */
+    Pointer child(size_t index) const;
+
+    /**
+     * @brief Resolve the pointer in a document
+     *
+     * @param doc document
+     * @return the referenced value or nullptr if it does not exist
+     */
+    const Value * resolve(const Value &doc) const noexcept;
+
+    /**
+     * @brief Resolve the pointer in a document
+     *
+     * @param doc document
+     * @return the referenced value or nullptr if it does not exist
+     */
+    Value * resolve(Value &doc) const noexcept {
+        return const_cast<Value *>(resolve(static_cast<const Value &>(doc)));
+    }
+
+    /**
+     * @brief Resolve the pointer in a document
+     *
+     * Small objects are searched using the precomputed hash of the keys.
+     *
+     * @param doc document
+     * @return the referenced value or nullptr if it does not exist
+     */
+    const Snapshot * resolve(const Snapshot &doc) const noexcept;
+
+    /**
+     * @brief Returns the string representation of the pointer
+     *
+     * @return pointer, with its tokens escaped
+     */
+    std::string to_string() const;
+
+    /**
+     * @brief Escape a reference token, "~" becomes "~0" and "/" becomes "~1"
+     *
+     * @param key unescaped key
+     * @return escaped key
+     */
+    static std::string escape(std::string_view key);
+
+    /**
+     * @brief equal operator
+     *
+     * @param o other pointer
+     * @return true if the pointers have the same tokens
+     */
+    bool operator==(const Pointer &o) const noexcept;
+    /**
+     * @brief != operator
+     *
+     * @param o other pointer
+     * @return true if the pointers are different
+     */
+    bool operator!=(const Pointer &o) const noexcept {
+        return !operator==(o);
+    }
+
+private:
+    std::vector<Token> m_tokens;    ///< reference tokens
+};
+
+}
+
+#include <mini_json/mini_json_pointer_impl.h>
+
+#endif /* H31BAB5EF_174F_43EB_A0ED_B14496731D72 */
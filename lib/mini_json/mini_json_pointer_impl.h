@@ -0,0 +1,186 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H96CB8046_B519_4451_BF82_28BA141B7682
+#define H96CB8046_B519_4451_BF82_28BA141B7682
+
+#include <iterator>
+#include <mini_json/mini_json_pointer.h>
+
+namespace MiniJSON {
+
+inline Pointer::Token::Token(std::string_view key) : m_key(key), m_index(NOT_AN_INDEX) {
+    // array indexes are "0" or digits without a leading zero
+    if (key.empty() || (key.size() > 1 && key[0] == '0')) {
+        return;
+    }
+    size_t index = 0;
+    for (char c : key) {
+        if (c < '0' || c > '9') {
+            return;
+        }
+        const size_t d = static_cast<size_t>(c - '0');
+        if (index > (NOT_AN_INDEX - 1 - d) / 10) {
+            return;
+        }
+        index = index * 10 + d;
+    }
+    m_index = index;
+}
+
+inline Pointer::Pointer(std::string_view text) : m_tokens() {
+    if (text.empty()) {
+        return;
+    }
+    if (text[0] != '/') {
+        throw PointerSyntaxException(0, "a pointer must start with '/'");
+    }
+    std::string key;
+    for (size_t i = 1; i <= text.size(); ++i) {
+        if (i == text.size() || text[i] == '/') {
+            m_tokens.emplace_back(key);
+            key.clear();
+        }
+        else if (text[i] == '~') {
+            if (i + 1 < text.size() && text[i + 1] == '0') {
+                key += '~';
+            }
+            else if (i + 1 < text.size() && text[i + 1] == '1') {
+                key += '/';
+            }
+            else {
+                throw PointerSyntaxException(i, "'~' must be followed by '0' or '1'");
+            }
+            ++i;
+        }
+        else {
+            key += text[i];
+        }
+    }
+}
+
+inline Pointer Pointer::parent() const {
+    if (m_tokens.empty()) {
+        return *this;
+    }
+    return Pointer(std::vector<Token>(m_tokens.begin(), std::prev(m_tokens.end())));
+}
+
+inline Pointer Pointer::child(std::string_view key) const {
+    std::vector<Token> tokens(m_tokens);
+    tokens.emplace_back(key);
+    return Pointer(std::move(tokens));
+}
+
+inline Pointer Pointer::child(size_t index) const {
+    std::vector<Token> tokens(m_tokens);
+    tokens.emplace_back(index);
+    return Pointer(std::move(tokens));
+}
+
+inline const Value * Pointer::resolve(const Value &doc) const noexcept {
+    const Value *current = &doc;
+    for (const Token &t : m_tokens) {
+        switch (current->get_type()) {
+        case Type::Object:
+            current = current->find(t.key().view());
+            if (current == nullptr) {
+                return nullptr;
+            }
+            break;
+        case Type::Array:
+        {
+            const ArrayValues &list = current->get<Type::Array>();
+            if (t.index() >= list.size()) {
+                return nullptr;
+            }
+            current = &*std::next(list.begin(), static_cast<ptrdiff_t>(t.index()));
+            break;
+        }
+        default:
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+inline const Snapshot * Pointer::resolve(const Snapshot &doc) const noexcept {
+    const Snapshot *current = &doc;
+    for (const Token &t : m_tokens) {
+        switch (current->get_type()) {
+        case Type::Object:
+            current = current->find(t.key());
+            if (current == nullptr) {
+                return nullptr;
+            }
+            break;
+        case Type::Array:
+        {
+            const ArraySnapshots &elements = current->get<Type::Array>();
+            if (t.index() >= elements.size()) {
+                return nullptr;
+            }
+            current = &elements[t.index()];
+            break;
+        }
+        default:
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+inline std::string Pointer::to_string() const {
+    std::string ret;
+    for (const Token &t : m_tokens) {
+        ret += '/';
+        ret += escape(t.key().view());
+    }
+    return ret;
+}
+
+inline std::string Pointer::escape(std::string_view key) {
+    std::string ret;
+    ret.reserve(key.size());
+    for (char c : key) {
+        if (c == '~') {
+            ret += "~0";
+        }
+        else if (c == '/') {
+            ret += "~1";
+        }
+        else {
+            ret += c;
+        }
+    }
+    return ret;
+}
+
+inline bool Pointer::operator==(const Pointer &o) const noexcept {
+    if (m_tokens.size() != o.m_tokens.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < m_tokens.size(); ++i) {
+        if (m_tokens[i].key() != o.m_tokens[i].key()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+#endif /* H96CB8046_B519_4451_BF82_28BA141B7682 */
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H8E8BD23A_575A_4EFF_A834_36674883D7C5
+#define H8E8BD23A_575A_4EFF_A834_36674883D7C5
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <exception>
+
+#include <mini_json/mini_json_value.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Thrown when a query can't be compiled
+ *
+ */
+class QuerySyntaxException : public std::exception {
+    std::string m_msg;
+public:
+    /**
+     * @brief Build a new QuerySyntaxException
+     *
+     * @param offset offset of the error in the query
+     * @param info message
+     */
+    QuerySyntaxException(size_t offset, const std::string &info) : m_msg() {
+        m_msg = std::string("Invalid query at offset ") + std::to_string(offset) + ": " + info;
+    }
+
+    /**
+     * @brief returns an explanatory string
+     *
+     * @return message
+     */
+    const virtual char* what() const noexcept override {
+        return m_msg.c_str();
+    }
+};
+
+/**
+ * @brief Comparison operators of the filter expressions
+ */
+enum class CompareOp {
+    Equal,          ///< ==
+    NotEqual,       ///< !=
+    Less,           ///< <
+    LessEqual,      ///< <=
+    Greater,        ///< >
+    GreaterEqual    ///< >=
+};
+
+/**
+ * @brief A compiled JSONPath query
+ *
+ * The supported syntax is a subset of RFC 9535:
+ * - the root identifier $
+ * - child segments: .name, .*, [selectors]
+ * - descendant segments: ..name, ..*, ..[selectors]
+ * - selectors: 'name' or "name", *, index (negative indexes count from the end),
+ *   slice start:end:step, and unions of selectors separated by commas
+ * - filter selectors ?expr, where expr combines with ||, && and ! the existence tests and the
+ *   comparisons (==, !=, <, <=, >, >=) of singular paths (@.a.b, @['a'][0], $.x) and literals
+ *   (numbers, strings, true, false, null). Parentheses can be used.
+ *
+ * A Query is compiled once, it is immutable and can be used on many documents, from several threads.
+ * The matches are returned as pointers into the document, in the order defined by RFC 9535.
+ */
+class Query {
+public:
+    /**
+     * @brief Compile a query
+     *
+     * @param text query
+     * @throws QuerySyntaxException if the query is not valid or not supported
+     */
+    explicit Query(std::string_view text);
+
+    /**
+     * @brief Select the values matching the query
+     *
+     * @param doc document
+     * @return pointers to the matching values, into doc
+     */
+    std::vector<const Value *> select(const Value &doc) const;
+
+    /**
+     * @brief Select the values matching the query
+     *
+     * @param doc document
+     * @return pointers to the matching values, into doc
+     */
+    std::vector<Value *> select(Value &doc) const;
+
+    /**
+     * @brief Returns the first value matching the query
+     *
+     * @param doc document
+     * @return pointer to the first matching value or nullptr
+     */
+    const Value * first(const Value &doc) const;
+
+    /**
+     * @brief Returns the text of the query
+     *
+     * @return query
+     */
+    const std::string & str() const noexcept {
+        return m_text;
+    }
+
+    /**
+     * @brief Compare two values as in the filter expressions
+     *
+     * A nullptr represents a missing value: two missing values are equal, a missing value is not
+     * equal to any value. The numbers are compared by value whatever their types, the strings are
+     * compared by bytes. The ordering operators are only true between two numbers or two strings.
+     *
+     * @param a left operand or nullptr
+     * @param op operator
+     * @param b right operand or nullptr
+     * @return result of the comparison
+     */
+    static bool compare(const Value *a, CompareOp op, const Value *b);
+
+private:
+    /**
+     * @brief A selector of a segment
+     */
+    struct Selector {
+        enum Kind {
+            Name,       ///< member of an object
+            Wildcard,   ///< all the children
+            Index,      ///< element of an array
+            Slice,      ///< elements of an array
+            Filter      ///< children matching an expression
+        };
+        Kind m_kind;            ///< kind of selector
+        std::string m_name;     ///< key, for Name
+        int64_t m_index;        ///< index for Index, start for Slice
+        int64_t m_end;          ///< end for Slice
+        int64_t m_step;         ///< step for Slice
+        bool m_has_start;       ///< the start of the Slice is defined
+        bool m_has_end;         ///< the end of the Slice is defined
+        size_t m_filter;        ///< index of the root of the expression in m_filters, for Filter
+    };
+    /**
+     * @brief A segment of the query, applying its selectors to the nodes selected so far
+     */
+    struct Segment {
+        bool m_descendant;                  ///< apply to the nodes and all their descendants
+        std::vector<Selector> m_selectors;  ///< selectors
+    };
+    /**
+     * @brief A step of a singular path
+     */
+    struct PathStep {
+        bool m_is_index;        ///< the step is an array index
+        std::string m_name;     ///< key
+        int64_t m_index;        ///< array index
+    };
+    /**
+     * @brief An operand of a filter expression
+     */
+    struct Operand {
+        enum Kind {
+            Current,    ///< path relative to the current node @
+            Root,       ///< path relative to the root $
+            Literal     ///< constant
+        };
+        Kind m_kind;                    ///< kind of operand
+        std::vector<PathStep> m_path;   ///< path for Current and Root
+        Value m_literal;                ///< constant for Literal
+    };
+    /**
+     * @brief A node of a filter expression
+     */
+    struct FilterNode {
+        enum Kind {
+            Or,         ///< m_lhs || m_rhs
+            And,        ///< m_lhs && m_rhs
+            Not,        ///< !m_lhs
+            Exists,     ///< the operand m_lhs exists
+            Compare     ///< operands m_lhs and m_rhs compared with m_op
+        };
+        Kind m_kind;    ///< kind of node
+        size_t m_lhs;   ///< left child node or operand
+        size_t m_rhs;   ///< right child node or operand
+        CompareOp m_op; ///< operator for Compare
+    };
+
+    class Compiler;
+
+    std::string m_text;                 ///< query
+    std::vector<Segment> m_segments;    ///< compiled segments
+    std::vector<FilterNode> m_filters;  ///< nodes of all the filter expressions
+    std::vector<Operand> m_operands;    ///< operands of all the filter expressions
+
+    /**
+     * @brief Apply the selectors of a segment to a node
+     *
+     * @param seg segment
+     * @param node node
+     * @param root document
+     * @param out selected nodes
+     */
+    void apply(const Segment &seg, const Value &node, const Value &root, std::vector<const Value *> &out) const;
+    /**
+     * @brief Apply the selectors of a segment to a node and all its descendants
+     *
+     * @param seg segment
+     * @param node node
+     * @param root document
+     * @param out selected nodes
+     */
+    void apply_descendants(const Segment &seg, const Value &node, const Value &root, std::vector<const Value *> &out) const;
+    /**
+     * @brief Apply a selector to a node
+     *
+     * @param sel selector
+     * @param node node
+     * @param root document
+     * @param out selected nodes
+     */
+    void apply(const Selector &sel, const Value &node, const Value &root, std::vector<const Value *> &out) const;
+    /**
+     * @brief Evaluate a filter expression
+     *
+     * @param filter index of the node of the expression
+     * @param current current node @
+     * @param root document $
+     * @return result
+     */
+    bool eval(size_t filter, const Value &current, const Value &root) const;
+    /**
+     * @brief Evaluate an operand
+     *
+     * @param operand index of the operand
+     * @param current current node @
+     * @param root document $
+     * @return value or nullptr if the path does not exist
+     */
+    const Value * eval_operand(size_t operand, const Value &current, const Value &root) const;
+    /**
+     * @brief Compare two numbers, exactly
+     *
+     * @param a number
+     * @param b number
+     * @return true if a < b
+     */
+    static bool numeric_less(const Value &a, const Value &b);
+    /**
+     * @brief Compare an integer with a double, exactly
+     *
+     * @param integer Int64 or UInt64 value
+     * @param d double
+     * @return -1, 0 or 1 if the integer is less than, equal to or greater than d
+     */
+    static int compare_integer(const Value &integer, double d);
+};
+
+}
+
+#include <mini_json/mini_json_query_impl.h>
+
+#endif /* H8E8BD23A_575A_4EFF_A834_36674883D7C5 */
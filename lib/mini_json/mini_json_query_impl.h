@@ -0,0 +1,803 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H2CEA4B95_BC89_4C52_9BF6_D8E7BBE7D6A4
+#define H2CEA4B95_BC89_4C52_9BF6_D8E7BBE7D6A4
+
+#include <cmath>
+#include <iterator>
+#include <algorithm>
+#include <mini_json/mini_json_query.h>
+#include <mini_json/mini_json_parser.h>
+#include <mini_json/utf_conv.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Recursive descent compiler of the queries
+ */
+class Query::Compiler {
+public:
+    /**
+     * @brief Prepare the compilation
+     *
+     * @param q query being compiled
+     */
+    explicit Compiler(Query &q) : m_q(q), m_text(q.m_text), m_pos(0) {}
+
+    /**
+     * @brief Compile the query
+     */
+    void compile() {
+        if (!accept('$')) {
+            fail("a query must start with '$'");
+        }
+        while (m_pos < m_text.size()) {
+            Segment seg{false, {}};
+            if (accept("..")) {
+                seg.m_descendant = true;
+                if (peek() == '[') {
+                    read_brackets(seg);
+                }
+                else {
+                    read_shorthand(seg);
+                }
+            }
+            else if (accept('.')) {
+                read_shorthand(seg);
+            }
+            else if (peek() == '[') {
+                read_brackets(seg);
+            }
+            else {
+                fail("unexpected character");
+            }
+            m_q.m_segments.push_back(std::move(seg));
+        }
+    }
+
+private:
+    Query &m_q;                 ///< query being compiled
+    std::string_view m_text;    ///< text of the query
+    size_t m_pos;               ///< current offset
+
+    /**
+     * @brief Throw a QuerySyntaxException at the current offset
+     */
+    [[noreturn]] void fail(const std::string &info) const {
+        throw QuerySyntaxException(m_pos, info);
+    }
+
+    /**
+     * @brief Returns the current character, or '\0' at the end of the query
+     */
+    char peek() const {
+        return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+    }
+
+    /**
+     * @brief Skip the current character if it is c
+     */
+    bool accept(char c) {
+        if (peek() == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Skip the next characters if they are s
+     */
+    bool accept(std::string_view s) {
+        if (m_text.substr(m_pos, s.size()) == s) {
+            m_pos += s.size();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Skip the current character, which must be c
+     */
+    void expect(char c) {
+        if (!accept(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    /**
+     * @brief Skip the blank characters
+     */
+    void skip_ws() {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r')) {
+            ++m_pos;
+        }
+    }
+
+    /**
+     * @brief Test whether a character can start a shorthand member name
+     */
+    static bool is_name_first(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    /**
+     * @brief Test whether a character can be part of a shorthand member name
+     */
+    static bool is_name_char(char c) {
+        return is_name_first(c) || (c >= '0' && c <= '9');
+    }
+
+    /**
+     * @brief Read a shorthand member name
+     */
+    std::string read_name() {
+        if (!is_name_first(peek())) {
+            fail("expected a member name");
+        }
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() && is_name_char(m_text[m_pos])) {
+            ++m_pos;
+        }
+        return std::string(m_text.substr(start, m_pos - start));
+    }
+
+    /**
+     * @brief Read the selector of a .name or .* segment
+     */
+    void read_shorthand(Segment &seg) {
+        Selector sel{};
+        if (accept('*')) {
+            sel.m_kind = Selector::Wildcard;
+        }
+        else {
+            sel.m_kind = Selector::Name;
+            sel.m_name = read_name();
+        }
+        seg.m_selectors.push_back(std::move(sel));
+    }
+
+    /**
+     * @brief Read the selectors of a bracketed segment
+     */
+    void read_brackets(Segment &seg) {
+        expect('[');
+        while (true) {
+            skip_ws();
+            seg.m_selectors.push_back(read_selector());
+            skip_ws();
+            if (accept(']')) {
+                return;
+            }
+            expect(',');
+        }
+    }
+
+    /**
+     * @brief Read one selector inside brackets
+     */
+    Selector read_selector() {
+        Selector sel{};
+        const char c = peek();
+        if (c == '\'' || c == '"') {
+            sel.m_kind = Selector::Name;
+            sel.m_name = read_string();
+        }
+        else if (accept('*')) {
+            sel.m_kind = Selector::Wildcard;
+        }
+        else if (accept('?')) {
+            sel.m_kind = Selector::Filter;
+            skip_ws();
+            sel.m_filter = read_or();
+        }
+        else if (c == '-' || (c >= '0' && c <= '9') || c == ':') {
+            sel.m_kind = Selector::Index;
+            sel.m_has_start = c != ':';
+            if (sel.m_has_start) {
+                sel.m_index = read_integer();
+            }
+            skip_ws();
+            if (accept(':')) {
+                sel.m_kind = Selector::Slice;
+                sel.m_step = 1;
+                skip_ws();
+                const char e = peek();
+                sel.m_has_end = e == '-' || (e >= '0' && e <= '9');
+                if (sel.m_has_end) {
+                    sel.m_end = read_integer();
+                }
+                skip_ws();
+                if (accept(':')) {
+                    skip_ws();
+                    const char s = peek();
+                    if (s == '-' || (s >= '0' && s <= '9')) {
+                        sel.m_step = read_integer();
+                    }
+                }
+            }
+            else if (!sel.m_has_start) {
+                fail("expected an index");
+            }
+        }
+        else {
+            fail("expected a selector");
+        }
+        return sel;
+    }
+
+    /**
+     * @brief Read an integer, in the I-JSON range
+     */
+    int64_t read_integer() {
+        const bool negative = accept('-');
+        if (peek() < '0' || peek() > '9') {
+            fail("expected an integer");
+        }
+        uint64_t v = 0;
+        while (peek() >= '0' && peek() <= '9') {
+            v = v * 10 + static_cast<uint64_t>(peek() - '0');
+            if (v > (uint64_t(1) << 53)) {
+                fail("integer out of range");
+            }
+            ++m_pos;
+        }
+        return negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+    }
+
+    /**
+     * @brief Read the 4 hexadecimal digits of a \u escape sequence
+     */
+    uint32_t read_hex4() {
+        uint32_t cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char h = peek();
+            cp <<= 4;
+            if (h >= '0' && h <= '9') {
+                cp |= static_cast<uint32_t>(h - '0');
+            }
+            else if (h >= 'a' && h <= 'f') {
+                cp |= static_cast<uint32_t>(h - 'a' + 10);
+            }
+            else if (h >= 'A' && h <= 'F') {
+                cp |= static_cast<uint32_t>(h - 'A' + 10);
+            }
+            else {
+                fail("invalid unicode escape sequence");
+            }
+            ++m_pos;
+        }
+        return cp;
+    }
+
+    /**
+     * @brief Read a quoted string literal
+     */
+    std::string read_string() {
+        const char quote = m_text[m_pos++];
+        std::string ret;
+        while (true) {
+            if (m_pos >= m_text.size()) {
+                fail("unterminated string");
+            }
+            const char c = m_text[m_pos++];
+            if (c == quote) {
+                return ret;
+            }
+            if (c != '\\') {
+                ret += c;
+                continue;
+            }
+            const char e = peek();
+            ++m_pos;
+            switch (e) {
+            case '\\': ret += '\\'; break;
+            case '/': ret += '/'; break;
+            case '\'': ret += '\''; break;
+            case '"': ret += '"'; break;
+            case 'b': ret += '\b'; break;
+            case 'f': ret += '\f'; break;
+            case 'n': ret += '\n'; break;
+            case 'r': ret += '\r'; break;
+            case 't': ret += '\t'; break;
+            case 'u':
+            {
+                uint32_t cp = read_hex4();
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (!accept("\\u")) {
+                        fail("invalid unicode escape sequence");
+                    }
+                    const uint32_t low = read_hex4();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        fail("invalid unicode escape sequence");
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    fail("invalid unicode escape sequence");
+                }
+                size_t consumed, written;
+                UTF::encode_utf8(&cp, 1, std::back_inserter(ret), &consumed, &written);
+                break;
+            }
+            default:
+                --m_pos;
+                fail("invalid escape sequence");
+            }
+        }
+    }
+
+    /**
+     * @brief Add a node to the filter expressions
+     */
+    size_t add_filter(FilterNode::Kind kind, size_t lhs, size_t rhs = 0, CompareOp op = CompareOp::Equal) {
+        m_q.m_filters.push_back({kind, lhs, rhs, op});
+        return m_q.m_filters.size() - 1;
+    }
+
+    /**
+     * @brief Read a logical-or expression
+     */
+    size_t read_or() {
+        size_t lhs = read_and();
+        skip_ws();
+        while (accept("||")) {
+            skip_ws();
+            const size_t rhs = read_and();
+            lhs = add_filter(FilterNode::Or, lhs, rhs);
+            skip_ws();
+        }
+        return lhs;
+    }
+
+    /**
+     * @brief Read a logical-and expression
+     */
+    size_t read_and() {
+        size_t lhs = read_unary();
+        skip_ws();
+        while (accept("&&")) {
+            skip_ws();
+            const size_t rhs = read_unary();
+            lhs = add_filter(FilterNode::And, lhs, rhs);
+            skip_ws();
+        }
+        return lhs;
+    }
+
+    /**
+     * @brief Read a negation, a parenthesized expression, a test or a comparison
+     */
+    size_t read_unary() {
+        if (accept('!')) {
+            skip_ws();
+            return add_filter(FilterNode::Not, read_unary());
+        }
+        if (accept('(')) {
+            skip_ws();
+            const size_t ret = read_or();
+            skip_ws();
+            expect(')');
+            return ret;
+        }
+        const size_t lhs = read_operand();
+        skip_ws();
+        CompareOp op;
+        if (accept("==")) {
+            op = CompareOp::Equal;
+        }
+        else if (accept("!=")) {
+            op = CompareOp::NotEqual;
+        }
+        else if (accept("<=")) {
+            op = CompareOp::LessEqual;
+        }
+        else if (accept(">=")) {
+            op = CompareOp::GreaterEqual;
+        }
+        else if (accept('<')) {
+            op = CompareOp::Less;
+        }
+        else if (accept('>')) {
+            op = CompareOp::Greater;
+        }
+        else {
+            if (m_q.m_operands[lhs].m_kind == Operand::Literal) {
+                fail("expected a comparison");
+            }
+            return add_filter(FilterNode::Exists, lhs);
+        }
+        skip_ws();
+        const size_t rhs = read_operand();
+        return add_filter(FilterNode::Compare, lhs, rhs, op);
+    }
+
+    /**
+     * @brief Read an operand of a comparison
+     */
+    size_t read_operand() {
+        Operand operand{Operand::Literal, {}, Value()};
+        const char c = peek();
+        if (c == '@' || c == '$') {
+            ++m_pos;
+            operand.m_kind = c == '@' ? Operand::Current : Operand::Root;
+            operand.m_path = read_singular_path();
+        }
+        else if (c == '\'' || c == '"') {
+            operand.m_literal = Value(read_string());
+        }
+        else if (accept("true")) {
+            operand.m_literal = Value(true);
+        }
+        else if (accept("false")) {
+            operand.m_literal = Value(false);
+        }
+        else if (accept("null")) {
+            operand.m_literal = Value();
+        }
+        else if (c == '-' || (c >= '0' && c <= '9')) {
+            operand.m_literal = read_number();
+        }
+        else {
+            fail("expected an operand");
+        }
+        m_q.m_operands.push_back(std::move(operand));
+        return m_q.m_operands.size() - 1;
+    }
+
+    /**
+     * @brief Read the steps of a singular path, after @ or $
+     */
+    std::vector<PathStep> read_singular_path() {
+        std::vector<PathStep> path;
+        while (true) {
+            if (peek() == '.' && is_name_first(m_pos + 1 < m_text.size() ? m_text[m_pos + 1] : '\0')) {
+                ++m_pos;
+                path.push_back({false, read_name(), 0});
+            }
+            else if (accept('[')) {
+                skip_ws();
+                const char c = peek();
+                if (c == '\'' || c == '"') {
+                    path.push_back({false, read_string(), 0});
+                }
+                else {
+                    path.push_back({true, {}, read_integer()});
+                }
+                skip_ws();
+                expect(']');
+            }
+            else {
+                return path;
+            }
+        }
+    }
+
+    /**
+     * @brief Read a number literal
+     */
+    Value read_number() {
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() && std::string_view("+-.0123456789eE").find(m_text[m_pos]) != std::string_view::npos) {
+            ++m_pos;
+        }
+        try {
+            Parser p;
+            return p.parse(std::string(m_text.substr(start, m_pos - start)));
+        }
+        catch (const std::exception &) {
+            m_pos = start;
+            fail("invalid number");
+        }
+    }
+};
+
+inline Query::Query(std::string_view text) : m_text(text), m_segments(), m_filters(), m_operands() {
+    Compiler(*this).compile();
+}
+
+inline std::vector<const Value *> Query::select(const Value &doc) const {
+    std::vector<const Value *> current{&doc};
+    std::vector<const Value *> next;
+    for (const Segment &seg : m_segments) {
+        next.clear();
+        for (const Value *node : current) {
+            if (seg.m_descendant) {
+                apply_descendants(seg, *node, doc, next);
+            }
+            else {
+                apply(seg, *node, doc, next);
+            }
+        }
+        current.swap(next);
+        if (current.empty()) {
+            break;
+        }
+    }
+    return current;
+}
+
+inline std::vector<Value *> Query::select(Value &doc) const {
+    std::vector<const Value *> found = select(static_cast<const Value &>(doc));
+    std::vector<Value *> ret;
+    ret.reserve(found.size());
+    for (const Value *v : found) {
+        ret.push_back(const_cast<Value *>(v));
+    }
+    return ret;
+}
+
+inline const Value * Query::first(const Value &doc) const {
+    std::vector<const Value *> found = select(doc);
+    return found.empty() ? nullptr : found.front();
+}
+
+inline void Query::apply(const Segment &seg, const Value &node, const Value &root, std::vector<const Value *> &out) const {
+    for (const Selector &sel : seg.m_selectors) {
+        apply(sel, node, root, out);
+    }
+}
+
+inline void Query::apply_descendants(const Segment &seg, const Value &node, const Value &root, std::vector<const Value *> &out) const {
+    apply(seg, node, root, out);
+    if (const ObjectValues *map = node.get_ptr<Type::Object>()) {
+        for (const auto &m : *map) {
+            apply_descendants(seg, m.second, root, out);
+        }
+    }
+    else if (const ArrayValues *list = node.get_ptr<Type::Array>()) {
+        for (const Value &e : *list) {
+            apply_descendants(seg, e, root, out);
+        }
+    }
+}
+
+inline void Query::apply(const Selector &sel, const Value &node, const Value &root, std::vector<const Value *> &out) const {
+    const ObjectValues *map = node.get_ptr<Type::Object>();
+    const ArrayValues *list = node.get_ptr<Type::Array>();
+    switch (sel.m_kind) {
+    case Selector::Name:
+        if (const Value *v = node.find(sel.m_name)) {
+            out.push_back(v);
+        }
+        break;
+    case Selector::Wildcard:
+        if (map != nullptr) {
+            for (const auto &m : *map) {
+                out.push_back(&m.second);
+            }
+        }
+        else if (list != nullptr) {
+            for (const Value &e : *list) {
+                out.push_back(&e);
+            }
+        }
+        break;
+    case Selector::Index:
+        if (list != nullptr) {
+            const int64_t len = static_cast<int64_t>(list->size());
+            const int64_t i = sel.m_index < 0 ? sel.m_index + len : sel.m_index;
+            if (i >= 0 && i < len) {
+                out.push_back(&*std::next(list->begin(), static_cast<ptrdiff_t>(i)));
+            }
+        }
+        break;
+    case Selector::Slice:
+    {
+        if (list == nullptr || sel.m_step == 0) {
+            break;
+        }
+        // RFC 9535, section 2.3.4.2.2
+        const int64_t len = static_cast<int64_t>(list->size());
+        const int64_t step = sel.m_step;
+        auto normalize = [len](int64_t i) { return i >= 0 ? i : len + i; };
+        int64_t start = sel.m_has_start ? normalize(sel.m_index) : (step > 0 ? 0 : len - 1);
+        int64_t end = sel.m_has_end ? normalize(sel.m_end) : (step > 0 ? len : -len - 1);
+        // walk the list, without random access: the elements are visited once, in the order of the step
+        if (step > 0) {
+            const int64_t lower = std::min(std::max(start, int64_t(0)), len);
+            const int64_t upper = std::min(std::max(end, int64_t(0)), len);
+            auto it = list->begin();
+            std::advance(it, static_cast<ptrdiff_t>(std::min(lower, upper)));
+            for (int64_t i = lower; i < upper; i += step) {
+                out.push_back(&*it);
+                if (upper - i <= step) {
+                    break;
+                }
+                std::advance(it, static_cast<ptrdiff_t>(step));
+            }
+        }
+        else {
+            const int64_t upper = std::min(std::max(start, int64_t(-1)), len - 1);
+            const int64_t lower = std::min(std::max(end, int64_t(-1)), len - 1);
+            if (lower < upper) {
+                auto it = list->rbegin();
+                std::advance(it, static_cast<ptrdiff_t>(len - 1 - upper));
+                for (int64_t i = upper; lower < i; i += step) {
+                    out.push_back(&*it);
+                    if (i - lower <= -step) {
+                        break;
+                    }
+                    std::advance(it, static_cast<ptrdiff_t>(-step));
+                }
+            }
+        }
+        break;
+    }
+    case Selector::Filter:
+        if (map != nullptr) {
+            for (const auto &m : *map) {
+                if (eval(sel.m_filter, m.second, root)) {
+                    out.push_back(&m.second);
+                }
+            }
+        }
+        else if (list != nullptr) {
+            for (const Value &e : *list) {
+                if (eval(sel.m_filter, e, root)) {
+                    out.push_back(&e);
+                }
+            }
+        }
+        break;
+    }
+}
+
+inline bool Query::eval(size_t filter, const Value &current, const Value &root) const {
+    const FilterNode &f = m_filters[filter];
+    switch (f.m_kind) {
+    case FilterNode::Or:
+        return eval(f.m_lhs, current, root) || eval(f.m_rhs, current, root);
+    case FilterNode::And:
+        return eval(f.m_lhs, current, root) && eval(f.m_rhs, current, root);
+    case FilterNode::Not:
+        return !eval(f.m_lhs, current, root);
+    case FilterNode::Exists:
+        return eval_operand(f.m_lhs, current, root) != nullptr;
+    case FilterNode::Compare:
+        return compare(eval_operand(f.m_lhs, current, root), f.m_op, eval_operand(f.m_rhs, current, root));
+    }
+    return false;
+}
+
+inline const Value * Query::eval_operand(size_t operand, const Value &current, const Value &root) const {
+    const Operand &o = m_operands[operand];
+    if (o.m_kind == Operand::Literal) {
+        return &o.m_literal;
+    }
+    const Value *v = o.m_kind == Operand::Current ? &current : &root;
+    for (const PathStep &step : o.m_path) {
+        if (!step.m_is_index) {
+            v = v->find(step.m_name);
+        }
+        else if (const ArrayValues *list = v->get_ptr<Type::Array>()) {
+            const int64_t len = static_cast<int64_t>(list->size());
+            const int64_t i = step.m_index < 0 ? step.m_index + len : step.m_index;
+            v = i >= 0 && i < len ? &*std::next(list->begin(), static_cast<ptrdiff_t>(i)) : nullptr;
+        }
+        else {
+            v = nullptr;
+        }
+        if (v == nullptr) {
+            return nullptr;
+        }
+    }
+    return v;
+}
+
+inline bool Query::numeric_less(const Value &a, const Value &b) {
+    const Type ta = a.get_type();
+    const Type tb = b.get_type();
+    if (!(ta & MASK_TYPE_IS_NUMERIC_FLOAT) && !(tb & MASK_TYPE_IS_NUMERIC_FLOAT)) {
+        // exact comparison of the integers
+        const bool a_neg = ta == Type::Int64 && a.get<Type::Int64>() < 0;
+        const bool b_neg = tb == Type::Int64 && b.get<Type::Int64>() < 0;
+        if (a_neg != b_neg) {
+            return a_neg;
+        }
+        if (a_neg) {
+            return a.get<Type::Int64>() < b.get<Type::Int64>();
+        }
+        const uint64_t ua = ta == Type::Int64 ? uint64_t(a.get<Type::Int64>()) : a.get<Type::UInt64>();
+        const uint64_t ub = tb == Type::Int64 ? uint64_t(b.get<Type::Int64>()) : b.get<Type::UInt64>();
+        return ua < ub;
+    }
+    if ((ta & MASK_TYPE_IS_NUMERIC_FLOAT) && (tb & MASK_TYPE_IS_NUMERIC_FLOAT)) {
+        return a.get<Type::Double>() < b.get<Type::Double>();
+    }
+    // an integer and a double: converting either one to the type of the other may round it
+    return (ta & MASK_TYPE_IS_NUMERIC_FLOAT) ? compare_integer(b, a.get<Type::Double>()) > 0 : compare_integer(a, b.get<Type::Double>()) < 0;
+}
+
+inline int Query::compare_integer(const Value &integer, double d) {
+    if (d >= 18446744073709551616.0) {
+        return -1;
+    }
+    if (d < -9223372036854775808.0) {
+        return 1;
+    }
+    // compare with floor(d), which is an integer in range, then with the fractional part
+    const double f = std::floor(d);
+    const bool negative = integer.get_type() == Type::Int64 && integer.get<Type::Int64>() < 0;
+    if (f >= 0.0) {
+        if (negative) {
+            return -1;
+        }
+        const uint64_t u = integer.get_type() == Type::Int64 ? uint64_t(integer.get<Type::Int64>()) : integer.get<Type::UInt64>();
+        if (u != uint64_t(f)) {
+            return u < uint64_t(f) ? -1 : 1;
+        }
+    }
+    else {
+        if (!negative) {
+            return 1;
+        }
+        const int64_t i = integer.get<Type::Int64>();
+        if (i != int64_t(f)) {
+            return i < int64_t(f) ? -1 : 1;
+        }
+    }
+    return d > f ? -1 : 0;
+}
+
+inline bool Query::compare(const Value *a, CompareOp op, const Value *b) {
+    auto equal = [a, b]() {
+        if (a == nullptr || b == nullptr) {
+            return a == b;
+        }
+        return *a == *b;
+    };
+    auto less = [](const Value *x, const Value *y) {
+        if (x == nullptr || y == nullptr) {
+            return false;
+        }
+        if ((x->get_type() & MASK_TYPE_IS_NUMERIC) && (y->get_type() & MASK_TYPE_IS_NUMERIC)) {
+            return numeric_less(*x, *y);
+        }
+        if (x->get_type() == Type::String && y->get_type() == Type::String) {
+            return x->get<Type::String>() < y->get<Type::String>();
+        }
+        return false;
+    };
+    // the numbers and the strings are totally ordered, a <= b is not b < a
+    auto ordered = [a, b]() {
+        if (a == nullptr || b == nullptr) {
+            return false;
+        }
+        return ((a->get_type() & MASK_TYPE_IS_NUMERIC) && (b->get_type() & MASK_TYPE_IS_NUMERIC)) ||
+            (a->get_type() == Type::String && b->get_type() == Type::String);
+    };
+    switch (op) {
+    case CompareOp::Equal:
+        return equal();
+    case CompareOp::NotEqual:
+        return !equal();
+    case CompareOp::Less:
+        return less(a, b);
+    case CompareOp::LessEqual:
+        return ordered() ? !less(b, a) : equal();
+    case CompareOp::Greater:
+        return less(b, a);
+    case CompareOp::GreaterEqual:
+        return ordered() ? !less(a, b) : equal();
+    }
+    return false;
+}
+
+}
+
+#endif /* H2CEA4B95_BC89_4C52_9BF6_D8E7BBE7D6A4 */
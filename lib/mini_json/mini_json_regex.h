@@ -0,0 +1,150 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef H760DB07E_67E0_49D6_B0CC_25B1AA2A0843
+#define H760DB07E_67E0_49D6_B0CC_25B1AA2A0843
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <exception>
+
+namespace MiniJSON {
+
+/**
+ * @brief Thrown when a regular expression can't be compiled
+ *
+ */
+class RegexException : public std::exception {
+    std::string m_msg;
+public:
+    /**
+     * @brief Build a new RegexException
+     *
+     * @param offset offset of the error in the pattern, in code points
+     * @param info message
+     */
+    RegexException(size_t offset, const std::string &info) : m_msg() {
+        m_msg = info + " at offset " + std::to_string(offset);
+    }
+
+    /**
+     * @brief returns an explanatory string
+     *
+     * @return message
+     */
+    const virtual char* what() const noexcept override {
+        return m_msg.c_str();
+    }
+};
+
+/**
+ * @brief A regular expression searched in linear time
+ *
+ * The syntax is the ECMAScript one without flags, as required by the JSON Schema "pattern"
+ * keyword: alternatives, groups (capturing, named or not), the greedy and lazy quantifiers
+ * *, +, ?, {n}, {n,} and {n,m}, the classes [...], [^...], ., \\d, \\D, \\w, \\W, \\s, \\S,
+ * the assertions ^, $, \\b, \\B and the character escapes. The backreferences and the
+ * lookarounds are rejected.
+ *
+ * The pattern and the subject are handled as sequences of code points. An invalid UTF-8
+ * sequence of the subject is read as U+FFFD, one byte at a time.
+ *
+ * The expression is compiled to a non deterministic automaton which is simulated on all the
+ * positions at once: the search has no recursion and runs in O(length of the subject * size
+ * of the automaton), whatever the pattern. The automaton is limited to MAX_INSTRUCTIONS
+ * instructions, which bounds the counted repetitions, and the groups to MAX_DEPTH levels.
+ *
+ * A Regex is immutable once compiled and can be used from several threads.
+ */
+class Regex {
+public:
+    static constexpr size_t MAX_INSTRUCTIONS = 1 << 16; ///< maximum size of the automaton
+    static constexpr size_t MAX_DEPTH = 256;            ///< maximum nesting of the groups
+
+    /**
+     * @brief Build an expression matching every string
+     */
+    Regex();
+
+    /**
+     * @brief Compile an expression
+     *
+     * @param pattern pattern, UTF-8 encoded
+     * @throws RegexException if the pattern is not valid or not supported
+     */
+    explicit Regex(std::string_view pattern);
+
+    /**
+     * @brief Search the expression in a string
+     *
+     * @param s subject, UTF-8 encoded
+     * @return true if a substring of s matches the expression
+     */
+    bool search(std::string_view s) const;
+
+private:
+    class Compiler;
+
+    enum Op : uint8_t {
+        CHAR,               ///< consume the code point m_x
+        ANY,                ///< consume any code point but a line terminator
+        CLASS,              ///< consume a code point of m_classes[m_x]
+        SPLIT,              ///< continue at m_x and at m_y
+        JMP,                ///< continue at m_x
+        BEGIN,              ///< assert the start of the subject
+        END,                ///< assert the end of the subject
+        WORD_BOUNDARY,      ///< assert a word boundary
+        NOT_WORD_BOUNDARY,  ///< assert the absence of a word boundary
+        MATCH               ///< the expression is found
+    };
+
+    struct Instruction {
+        Op m_op;
+        uint32_t m_x;
+        uint32_t m_y;
+    };
+
+    typedef std::pair<uint32_t, uint32_t> Range; ///< inclusive range of code points
+
+    struct CharClass {
+        bool m_negated;                 ///< the class matches the code points outside of the ranges
+        std::vector<Range> m_ranges;    ///< sorted and disjoint ranges
+
+        bool contains(uint32_t cp) const;
+    };
+
+    static constexpr uint32_t NONE = 0xFFFFFFFF; ///< code point before the start or after the end of the subject
+
+    static bool is_word(uint32_t cp);
+    static void decode(std::string_view s, size_t pos, uint32_t *cp, size_t *len);
+    bool consumes(const Instruction &i, uint32_t cp) const;
+
+    std::vector<Instruction> m_program; ///< the automaton, starting at 0
+    std::vector<CharClass> m_classes;   ///< classes used by the CLASS instructions
+    bool m_anchored;                    ///< the automaton starts with BEGIN, it's only tried at the start of the subject
+};
+
+}
+
+#include <mini_json/mini_json_regex_impl.h>
+
+#endif /* H760DB07E_67E0_49D6_B0CC_25B1AA2A0843 */
@@ -0,0 +1,677 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef H45881FE8_B4C5_4B09_A476_6AD2BFAE1182
+#define H45881FE8_B4C5_4B09_A476_6AD2BFAE1182
+
+#include <algorithm>
+#include <iterator>
+#include <mini_json/mini_json_regex.h>
+#include <mini_json/utf_conv.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Recursive descent parser of a pattern, producing the automaton
+ *
+ * Each construct is compiled to a fragment whose jump targets are relative to its start, the
+ * fragments are relocated when they are concatenated.
+ */
+class Regex::Compiler {
+public:
+    typedef std::vector<Instruction> Code;
+
+    /**
+     * @brief Prepare the compilation of a pattern
+     *
+     * @param re receives the classes
+     * @param pattern pattern, UTF-8 encoded
+     * @throws RegexException if the pattern is not valid UTF-8
+     */
+    Compiler(Regex &re, std::string_view pattern) : m_re(re), m_pattern(), m_pos(0), m_depth(0) {
+        size_t pos = 0;
+        while (pos < pattern.size()) {
+            uint32_t cp;
+            size_t consumed;
+            if (UTF::decode_one_utf8(pattern.data() + pos, pattern.size() - pos, &cp, &consumed) != UTF::RetCode::OK) {
+                throw RegexException(m_pattern.size(), "invalid UTF-8 sequence");
+            }
+            m_pattern.push_back(cp);
+            pos += consumed;
+        }
+    }
+
+    /**
+     * @brief Compile the pattern
+     *
+     * @return the automaton, without the final MATCH
+     * @throws RegexException
+     */
+    Code compile() {
+        Code c = disjunction();
+        if (!at_end()) {
+            error("unmatched )");
+        }
+        return c;
+    }
+
+private:
+    static constexpr size_t INFINITE = static_cast<size_t>(-1);
+
+    [[noreturn]] void error(const std::string &info) const {
+        throw RegexException(m_pos, info);
+    }
+
+    bool at_end() const {
+        return m_pos >= m_pattern.size();
+    }
+
+    uint32_t peek(size_t ahead = 0) const {
+        return m_pos + ahead < m_pattern.size() ? m_pattern[m_pos + ahead] : NONE;
+    }
+
+    bool accept(uint32_t c) {
+        if (peek() == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    static bool is_digit(uint32_t c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static int hex_value(uint32_t c) {
+        if (c >= '0' && c <= '9') {
+            return static_cast<int>(c - '0');
+        }
+        if (c >= 'a' && c <= 'f') {
+            return static_cast<int>(c - 'a' + 10);
+        }
+        if (c >= 'A' && c <= 'F') {
+            return static_cast<int>(c - 'A' + 10);
+        }
+        return -1;
+    }
+
+    static Instruction make(Op op, uint32_t x = 0, uint32_t y = 0) {
+        return Instruction{op, x, y};
+    }
+
+    // append a fragment, relocating its jumps
+    void append(Code &dst, const Code &src) const {
+        if (dst.size() + src.size() >= MAX_INSTRUCTIONS) {
+            error("pattern too large");
+        }
+        const uint32_t offset = static_cast<uint32_t>(dst.size());
+        for (Instruction i : src) {
+            if (i.m_op == SPLIT || i.m_op == JMP) {
+                i.m_x += offset;
+                i.m_y += offset;
+            }
+            dst.push_back(i);
+        }
+    }
+
+    // append an instruction, its jumps are already relative to the start of dst
+    void append(Code &dst, Instruction i) const {
+        if (dst.size() + 1 >= MAX_INSTRUCTIONS) {
+            error("pattern too large");
+        }
+        dst.push_back(i);
+    }
+
+    // disjunction := alternative ('|' alternative)*
+    Code disjunction() {
+        Code left = alternative();
+        while (accept('|')) {
+            Code right = alternative();
+            Code c;
+            append(c, make(SPLIT, 1, static_cast<uint32_t>(left.size() + 2)));
+            append(c, left);
+            append(c, make(JMP, static_cast<uint32_t>(left.size() + 2 + right.size())));
+            append(c, right);
+            left = std::move(c);
+        }
+        return left;
+    }
+
+    // alternative := term*
+    Code alternative() {
+        Code c;
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            append(c, term());
+        }
+        return c;
+    }
+
+    // term := assertion | atom quantifier?
+    Code term() {
+        if (accept('^')) {
+            return Code{make(BEGIN)};
+        }
+        if (accept('$')) {
+            return Code{make(END)};
+        }
+        if (peek() == '\\' && (peek(1) == 'b' || peek(1) == 'B')) {
+            m_pos += 2;
+            return Code{make(m_pattern[m_pos - 1] == 'b' ? WORD_BOUNDARY : NOT_WORD_BOUNDARY)};
+        }
+        return quantifier(atom());
+    }
+
+    Code atom() {
+        const uint32_t c = peek();
+        switch (c) {
+        case '.':
+            ++m_pos;
+            return Code{make(ANY)};
+        case '(':
+            return group();
+        case '[':
+            ++m_pos;
+            return char_class();
+        case '\\':
+            ++m_pos;
+            return atom_escape();
+        case '*':
+        case '+':
+        case '?':
+            error("nothing to repeat");
+        case '{':
+        {
+            size_t min, max;
+            const size_t start = m_pos;
+            if (braces(&min, &max)) {
+                m_pos = start;
+                error("nothing to repeat");
+            }
+            ++m_pos;
+            return Code{make(CHAR, c)};
+        }
+        default:
+            // as in the Annex B of ECMAScript, ] and } are literals
+            ++m_pos;
+            return Code{make(CHAR, c)};
+        }
+    }
+
+    Code group() {
+        ++m_pos;
+        if (accept('?')) {
+            if (accept('<')) {
+                if (peek() == '=' || peek() == '!') {
+                    error("lookbehinds are not supported");
+                }
+                // the groups don't capture anything, the name is only checked
+                size_t n = 0;
+                while (!at_end() && peek() != '>') {
+                    const uint32_t c = peek();
+                    if (!(c == '_' || c == '$' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (n != 0 && is_digit(c)) || c >= 0x80)) {
+                        error("invalid group name");
+                    }
+                    ++m_pos;
+                    ++n;
+                }
+                if (n == 0 || !accept('>')) {
+                    error("invalid group name");
+                }
+            }
+            else if (peek() == '=' || peek() == '!') {
+                error("lookaheads are not supported");
+            }
+            else if (!accept(':')) {
+                error("invalid group");
+            }
+        }
+        if (++m_depth > MAX_DEPTH) {
+            error("groups nested too deeply");
+        }
+        Code c = disjunction();
+        --m_depth;
+        if (!accept(')')) {
+            error("missing )");
+        }
+        return c;
+    }
+
+    // parse {n}, {n,} or {n,m}, leaves the position unchanged if it's not a quantifier
+    bool braces(size_t *min, size_t *max) {
+        const size_t start = m_pos;
+        auto number = [this](size_t *n) {
+            if (!is_digit(peek())) {
+                return false;
+            }
+            *n = 0;
+            while (is_digit(peek())) {
+                // saturate, the size of the automaton is checked anyway
+                *n = std::min<size_t>(*n * 10 + (m_pattern[m_pos++] - '0'), MAX_INSTRUCTIONS);
+            }
+            return true;
+        };
+        if (accept('{') && number(min)) {
+            if (accept('}')) {
+                *max = *min;
+                return true;
+            }
+            if (accept(',')) {
+                if (accept('}')) {
+                    *max = INFINITE;
+                    return true;
+                }
+                if (number(max) && accept('}')) {
+                    return true;
+                }
+            }
+        }
+        m_pos = start;
+        return false;
+    }
+
+    Code quantifier(Code a) {
+        size_t min, max;
+        if (accept('*')) {
+            min = 0;
+            max = INFINITE;
+        }
+        else if (accept('+')) {
+            min = 1;
+            max = INFINITE;
+        }
+        else if (accept('?')) {
+            min = 0;
+            max = 1;
+        }
+        else if (!braces(&min, &max)) {
+            return a;
+        }
+        // a lazy quantifier matches the same strings
+        accept('?');
+        if (min > max) {
+            error("numbers out of order in {} quantifier");
+        }
+        if (a.empty()) {
+            return a;
+        }
+
+        Code c;
+        const uint32_t size = static_cast<uint32_t>(a.size());
+        if (max == INFINITE) {
+            for (size_t i = 1; i < min; ++i) {
+                append(c, a);
+            }
+            if (min == 0) {
+                // L: SPLIT L+1, end; a; JMP L
+                Code star;
+                append(star, make(SPLIT, 1, size + 2));
+                append(star, a);
+                append(star, make(JMP, 0));
+                append(c, star);
+            }
+            else {
+                // L: a; SPLIT L, end
+                Code plus;
+                append(plus, a);
+                append(plus, make(SPLIT, 0, size + 1));
+                append(c, plus);
+            }
+        }
+        else {
+            for (size_t i = 0; i < min; ++i) {
+                append(c, a);
+            }
+            Code optional;
+            append(optional, make(SPLIT, 1, size + 1));
+            append(optional, a);
+            for (size_t i = min; i < max; ++i) {
+                append(c, optional);
+            }
+        }
+        return c;
+    }
+
+    // a character escape, after the backslash
+    uint32_t char_escape() {
+        if (at_end()) {
+            error("\\ at end of pattern");
+        }
+        const uint32_t c = m_pattern[m_pos++];
+        switch (c) {
+        case 't': return '\t';
+        case 'n': return '\n';
+        case 'v': return '\v';
+        case 'f': return '\f';
+        case 'r': return '\r';
+        case '0':
+            if (is_digit(peek())) {
+                error("octal escapes are not supported");
+            }
+            return 0;
+        case 'c':
+        {
+            const uint32_t l = peek();
+            if (!((l >= 'a' && l <= 'z') || (l >= 'A' && l <= 'Z'))) {
+                error("invalid \\c escape");
+            }
+            ++m_pos;
+            return l % 32;
+        }
+        case 'x':
+        {
+            const int h = hex_value(peek());
+            const int l = hex_value(peek(1));
+            if (h < 0 || l < 0) {
+                // Annex B: an incomplete escape is the letter
+                return c;
+            }
+            m_pos += 2;
+            return static_cast<uint32_t>(h * 16 + l);
+        }
+        case 'u':
+        {
+            uint32_t u;
+            if (!hex4(0, &u)) {
+                return c;
+            }
+            m_pos += 4;
+            // a surrogate pair written as two escapes
+            uint32_t low;
+            if (u >= 0xD800 && u <= 0xDBFF && peek() == '\\' && peek(1) == 'u' && hex4(2, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                m_pos += 6;
+                u = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+            }
+            return u;
+        }
+        default:
+            if (is_digit(c)) {
+                error("backreferences are not supported");
+            }
+            // identity escape
+            return c;
+        }
+    }
+
+    bool hex4(size_t ahead, uint32_t *u) const {
+        *u = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const int h = hex_value(peek(ahead + i));
+            if (h < 0) {
+                return false;
+            }
+            *u = *u * 16 + static_cast<uint32_t>(h);
+        }
+        return true;
+    }
+
+    // \d, \D, \s, \S, \w and \W, after the backslash
+    bool class_escape(std::vector<Range> *ranges) {
+        static const Range digits[] = {{'0', '9'}};
+        static const Range words[] = {{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}};
+        static const Range spaces[] = {{0x09, 0x0D}, {0x20, 0x20}, {0xA0, 0xA0}, {0x1680, 0x1680}, {0x2000, 0x200A},
+            {0x2028, 0x2029}, {0x202F, 0x202F}, {0x205F, 0x205F}, {0x3000, 0x3000}, {0xFEFF, 0xFEFF}};
+        const Range *begin, *end;
+        switch (peek()) {
+        case 'd': case 'D': begin = std::begin(digits); end = std::end(digits); break;
+        case 'w': case 'W': begin = std::begin(words); end = std::end(words); break;
+        case 's': case 'S': begin = std::begin(spaces); end = std::end(spaces); break;
+        default: return false;
+        }
+        const bool negated = peek() == 'D' || peek() == 'W' || peek() == 'S';
+        ++m_pos;
+        if (!negated) {
+            ranges->insert(ranges->end(), begin, end);
+            return true;
+        }
+        uint32_t next = 0;
+        for (const Range *r = begin; r != end; ++r) {
+            if (r->first > next) {
+                ranges->push_back({next, r->first - 1});
+            }
+            next = r->second + 1;
+        }
+        ranges->push_back({next, 0x10FFFF});
+        return true;
+    }
+
+    Code make_class(CharClass cc) {
+        std::sort(cc.m_ranges.begin(), cc.m_ranges.end());
+        std::vector<Range> merged;
+        for (const Range &r : cc.m_ranges) {
+            if (!merged.empty() && r.first <= merged.back().second + 1) {
+                merged.back().second = std::max(merged.back().second, r.second);
+            }
+            else {
+                merged.push_back(r);
+            }
+        }
+        cc.m_ranges = std::move(merged);
+        m_re.m_classes.push_back(std::move(cc));
+        return Code{make(CLASS, static_cast<uint32_t>(m_re.m_classes.size() - 1))};
+    }
+
+    // an escape outside of a class, after the backslash
+    Code atom_escape() {
+        CharClass cc{false, {}};
+        if (class_escape(&cc.m_ranges)) {
+            return make_class(std::move(cc));
+        }
+        if (peek() == 'k' && peek(1) == '<') {
+            error("backreferences are not supported");
+        }
+        return Code{make(CHAR, char_escape())};
+    }
+
+    // a member of a class: a code point, or a set added to ranges
+    bool class_atom(std::vector<Range> *ranges, uint32_t *cp) {
+        if (at_end()) {
+            error("missing ]");
+        }
+        if (!accept('\\')) {
+            *cp = m_pattern[m_pos++];
+            return true;
+        }
+        if (class_escape(ranges)) {
+            return false;
+        }
+        if (accept('b')) {
+            *cp = '\b';
+            return true;
+        }
+        if (accept('-')) {
+            *cp = '-';
+            return true;
+        }
+        *cp = char_escape();
+        return true;
+    }
+
+    // a class, after the [
+    Code char_class() {
+        CharClass cc{accept('^'), {}};
+        while (!accept(']')) {
+            uint32_t lo, hi;
+            const bool lo_single = class_atom(&cc.m_ranges, &lo);
+            if (peek() == '-' && peek(1) != ']' && peek(1) != NONE) {
+                ++m_pos;
+                const bool hi_single = class_atom(&cc.m_ranges, &hi);
+                if (lo_single && hi_single) {
+                    if (lo > hi) {
+                        error("range out of order in character class");
+                    }
+                    cc.m_ranges.push_back({lo, hi});
+                }
+                else {
+                    // Annex B: a range with a class escape is the union of its members and -
+                    cc.m_ranges.push_back({'-', '-'});
+                    if (lo_single) {
+                        cc.m_ranges.push_back({lo, lo});
+                    }
+                    if (hi_single) {
+                        cc.m_ranges.push_back({hi, hi});
+                    }
+                }
+            }
+            else if (lo_single) {
+                cc.m_ranges.push_back({lo, lo});
+            }
+        }
+        return make_class(std::move(cc));
+    }
+
+    Regex &m_re;                    ///< receives the classes
+    std::vector<uint32_t> m_pattern;///< code points of the pattern
+    size_t m_pos;                   ///< position in m_pattern
+    size_t m_depth;                 ///< nesting of the groups
+};
+
+inline Regex::Regex() : m_program{{MATCH, 0, 0}}, m_classes(), m_anchored(false) {}
+
+inline Regex::Regex(std::string_view pattern) : m_program(), m_classes(), m_anchored(false) {
+    m_program = Compiler(*this, pattern).compile();
+    m_program.push_back({MATCH, 0, 0});
+    m_anchored = m_program.front().m_op == BEGIN;
+}
+
+inline bool Regex::CharClass::contains(uint32_t cp) const {
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), cp, [](uint32_t c, const Range &r) { return c < r.first; });
+    const bool in = it != m_ranges.begin() && cp <= std::prev(it)->second;
+    return in != m_negated;
+}
+
+inline bool Regex::is_word(uint32_t cp) {
+    return (cp >= '0' && cp <= '9') || (cp >= 'A' && cp <= 'Z') || (cp >= 'a' && cp <= 'z') || cp == '_';
+}
+
+inline void Regex::decode(std::string_view s, size_t pos, uint32_t *cp, size_t *len) {
+    if (pos >= s.size()) {
+        *cp = NONE;
+        *len = 0;
+    }
+    else if (static_cast<unsigned char>(s[pos]) < 0x80) {
+        *cp = static_cast<unsigned char>(s[pos]);
+        *len = 1;
+    }
+    else if (UTF::decode_one_utf8(s.data() + pos, s.size() - pos, cp, len) != UTF::RetCode::OK) {
+        *cp = 0xFFFD;
+        *len = 1;
+    }
+}
+
+inline bool Regex::consumes(const Instruction &i, uint32_t cp) const {
+    switch (i.m_op) {
+    case CHAR:
+        return cp == i.m_x;
+    case ANY:
+        return cp != '\n' && cp != '\r' && cp != 0x2028 && cp != 0x2029;
+    case CLASS:
+        return m_classes[i.m_x].contains(cp);
+    default:
+        return false;
+    }
+}
+
+inline bool Regex::search(std::string_view s) const {
+    // Pike's simulation: the list of the consuming instructions reached at the current position,
+    // each instruction is added once per position
+    std::vector<uint32_t> current;
+    std::vector<uint32_t> arrived;
+    std::vector<uint32_t> stack;
+    std::vector<size_t> mark(m_program.size(), 0);
+    size_t generation = 0;
+
+    size_t pos = 0;
+    uint32_t prev = NONE;
+    uint32_t cp;
+    size_t len;
+    decode(s, pos, &cp, &len);
+
+    // follow the non consuming instructions from pc, returns true if MATCH is reached
+    auto closure = [&](uint32_t pc) {
+        stack.clear();
+        stack.push_back(pc);
+        while (!stack.empty()) {
+            pc = stack.back();
+            stack.pop_back();
+            if (mark[pc] == generation) {
+                continue;
+            }
+            mark[pc] = generation;
+            const Instruction &i = m_program[pc];
+            switch (i.m_op) {
+            case MATCH:
+                return true;
+            case JMP:
+                stack.push_back(i.m_x);
+                break;
+            case SPLIT:
+                stack.push_back(i.m_y);
+                stack.push_back(i.m_x);
+                break;
+            case BEGIN:
+                if (pos == 0) {
+                    stack.push_back(pc + 1);
+                }
+                break;
+            case END:
+                if (pos == s.size()) {
+                    stack.push_back(pc + 1);
+                }
+                break;
+            case WORD_BOUNDARY:
+            case NOT_WORD_BOUNDARY:
+                if ((is_word(prev) != is_word(cp)) == (i.m_op == WORD_BOUNDARY)) {
+                    stack.push_back(pc + 1);
+                }
+                break;
+            default:
+                current.push_back(pc);
+                break;
+            }
+        }
+        return false;
+    };
+
+    while (true) {
+        ++generation;
+        current.clear();
+        for (uint32_t pc : arrived) {
+            if (closure(pc)) {
+                return true;
+            }
+        }
+        if ((pos == 0 || !m_anchored) && closure(0)) {
+            return true;
+        }
+        if (pos == s.size() || (m_anchored && current.empty())) {
+            return false;
+        }
+        arrived.clear();
+        for (uint32_t pc : current) {
+            if (consumes(m_program[pc], cp)) {
+                arrived.push_back(pc + 1);
+            }
+        }
+        prev = cp;
+        pos += len;
+        decode(s, pos, &cp, &len);
+    }
+}
+
+}
+
+#endif /* H45881FE8_B4C5_4B09_A476_6AD2BFAE1182 */
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H1E94E72A_5ED6_4A79_BF9A_0C43F0E9C147
+#define H1E94E72A_5ED6_4A79_BF9A_0C43F0E9C147
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <exception>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_parser.h>
+#include <mini_json/mini_json_regex.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Thrown when a schema can't be compiled
+ *
+ */
+class SchemaException : public std::exception {
+    std::string m_msg;
+public:
+    /**
+     * @brief Build a new SchemaException
+     *
+     * @param pointer JSON Pointer to the invalid keyword in the schema
+     * @param info message
+     */
+    SchemaException(const std::string &pointer, const std::string &info) : m_msg() {
+        m_msg = std::string("Invalid schema at \"") + pointer + "\": " + info;
+    }
+
+    /**
+     * @brief returns an explanatory string
+     *
+     * @return message
+     */
+    const virtual char* what() const noexcept override {
+        return m_msg.c_str();
+    }
+};
+
+/**
+ * @brief Description of the first validation error found in a document
+ */
+struct ValidationError {
+    std::string m_pointer;  ///< JSON Pointer to the invalid value in the document
+    std::string m_message;  ///< description of the error
+};
+
+/**
+ * @brief A compiled JSON Schema
+ *
+ * The schema is compiled once into a table of nodes, the validation does not interpret the
+ * schema document anymore. The supported keywords are a subset of the draft 2020-12:
+ * - type (a name or an array of names), enum, const
+ * - minimum, maximum, exclusiveMinimum, exclusiveMaximum
+ * - minLength, maxLength (counted in code points), pattern (ECMAScript syntax, searched in
+ *   linear time on the code points, see Regex)
+ * - properties, required, additionalProperties, minProperties, maxProperties
+ * - items (applied to all the elements), minItems, maxItems
+ * - the boolean schemas true and false
+ *
+ * The other keywords are ignored, as the unknown keywords are by the specification.
+ *
+ * The error reported is the first one in the order of the document: when the document has been
+ * parsed, both overloads of validate() report the same error. The members of an object built
+ * without positions are checked in the order of their keys. A Schema is immutable once compiled
+ * and can be used from several threads.
+ */
+class Schema {
+public:
+    /**
+     * @brief Compile a schema
+     *
+     * @param schema schema document, an object or a boolean
+     * @throws SchemaException if the schema is not valid
+     */
+    explicit Schema(const Value &schema);
+
+    /**
+     * @brief Validate a document
+     *
+     * @param doc document
+     * @param error optional, receives the description of the first error
+     * @return true if the document is valid
+     */
+    bool validate(const Value &doc, ValidationError *error = nullptr) const;
+
+    /**
+     * @brief Parse and validate a document, without building it
+     *
+     * The document is validated on the parser events and the parsing stops at the first error,
+     * unless the error is in an object: the rest of the document is then parsed to check that
+     * the invalid value is not replaced by a repeated key. Parser keeps the last occurrence of a
+     * repeated key: if the invalid value is replaced, the document tree is built and validated,
+     * so both overloads of validate() agree. Only the subtrees tested by enum or const are built.
+     *
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param document document, UTF-8 encoded
+     * @param parser parser to use
+     * @param error optional, receives the description of the first error
+     * @return true if the document is valid
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    template<typename StatsPolicy> bool validate(std::string_view document, BasicParser<StatsPolicy> &parser, ValidationError *error = nullptr) const;
+
+private:
+    /**
+     * @brief Index of a node which accepts any value
+     */
+    static constexpr size_t ANY = static_cast<size_t>(-1);
+    /**
+     * @brief Value of the unset size limits
+     */
+    static constexpr size_t UNLIMITED = static_cast<size_t>(-1);
+
+    /**
+     * @brief Bits of the type keyword
+     */
+    enum TypeBits : unsigned int {
+        TYPE_NULL = 0x01,
+        TYPE_BOOLEAN = 0x02,
+        TYPE_OBJECT = 0x04,
+        TYPE_ARRAY = 0x08,
+        TYPE_NUMBER = 0x10,
+        TYPE_INTEGER = 0x20,
+        TYPE_STRING = 0x40
+    };
+
+    /**
+     * @brief A compiled (sub)schema
+     */
+    struct Node {
+        bool m_false = false;                   ///< the boolean schema false
+        unsigned int m_types = 0;               ///< accepted types, 0 for any
+        std::vector<Value> m_enum;              ///< accepted values, empty for any
+        bool m_has_const = false;               ///< m_const is defined
+        Value m_const;                          ///< accepted value
+        Value m_minimum;                        ///< inclusive lower bound, Null if unset
+        Value m_maximum;                        ///< inclusive upper bound, Null if unset
+        Value m_exclusive_minimum;              ///< exclusive lower bound, Null if unset
+        Value m_exclusive_maximum;              ///< exclusive upper bound, Null if unset
+        size_t m_min_length = 0;                ///< minimum number of code points
+        size_t m_max_length = UNLIMITED;        ///< maximum number of code points
+        bool m_has_pattern = false;             ///< m_pattern is defined
+        Regex m_pattern;                        ///< pattern of the strings
+        std::vector<std::pair<std::string, size_t>> m_properties;  ///< schemas of the properties, sorted by key
+        std::vector<std::string> m_required;    ///< required properties, sorted
+        size_t m_additional = ANY;              ///< schema of the other properties
+        size_t m_min_properties = 0;            ///< minimum number of properties
+        size_t m_max_properties = UNLIMITED;    ///< maximum number of properties
+        size_t m_items = ANY;                   ///< schema of the elements
+        size_t m_min_items = 0;                 ///< minimum number of elements
+        size_t m_max_items = UNLIMITED;         ///< maximum number of elements
+    };
+
+    class EventValidator;
+
+    std::vector<Node> m_nodes;      ///< compiled schemas, the root is the first one
+
+    /**
+     * @brief Compile a (sub)schema
+     *
+     * @param schema schema
+     * @param pointer location of the schema, for the error messages
+     * @return index of the node
+     */
+    size_t compile(const Value &schema, const std::string &pointer);
+
+    /**
+     * @brief Compile a subschema, the boolean schema true is compiled as ANY
+     *
+     * @param schema schema
+     * @param pointer location of the schema, for the error messages
+     * @return index of the node or ANY
+     */
+    size_t compile_child(const Value &schema, const std::string &pointer) {
+        if (schema.get_type() == Type::Boolean && schema.get<Type::Boolean>()) {
+            return ANY;
+        }
+        return compile(schema, pointer);
+    }
+
+    /**
+     * @brief Validate a value
+     *
+     * @param node index of the node
+     * @param v value
+     * @param error optional error description
+     * @return true if the value is valid
+     */
+    bool check(size_t node, const Value &v, ValidationError *error) const;
+
+    /**
+     * @brief Checks common to all the types: false schema and type
+     *
+     * @param n node
+     * @param t type of the value
+     * @param integral the value is an integer
+     * @param error optional error description
+     * @return true if the value is valid
+     */
+    static bool check_type(const Node &n, Type t, bool integral, ValidationError *error);
+
+    /**
+     * @brief Validate the members of an object
+     *
+     * @param n node
+     * @param map object
+     * @param error optional error description
+     * @return true if the object is valid
+     */
+    bool check_object(const Node &n, const ObjectValues &map, ValidationError *error) const;
+
+    /**
+     * @brief Returns the index of the node validating a property
+     *
+     * @param n node of the object
+     * @param key key of the property
+     * @return index of the node or ANY
+     */
+    static size_t property_node(const Node &n, std::string_view key);
+
+    /**
+     * @brief Count the code points of an UTF-8 string
+     *
+     * @param s string
+     * @return number of code points
+     */
+    static size_t length(std::string_view s);
+
+    /**
+     * @brief Prepend a reference token to the pointer of an error
+     *
+     * @param error optional error description
+     * @param token unescaped reference token
+     */
+    static void prepend(ValidationError *error, std::string_view token);
+
+    /**
+     * @brief Fill an error description
+     *
+     * @param error optional error description
+     * @param message description of the error
+     * @return false
+     */
+    static bool fail(ValidationError *error, const std::string &message);
+};
+
+}
+
+#include <mini_json/mini_json_schema_impl.h>
+
+#endif /* H1E94E72A_5ED6_4A79_BF9A_0C43F0E9C147 */
@@ -0,0 +1,777 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H315680FD_462C_4B05_967C_E3BD986F0BF9
+#define H315680FD_462C_4B05_967C_E3BD986F0BF9
+
+#include <cmath>
+#include <algorithm>
+#include <mini_json/mini_json_schema.h>
+#include <mini_json/mini_json_pointer.h>
+#include <mini_json/mini_json_query.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Parser event handler validating a document
+ */
+class Schema::EventValidator {
+public:
+    /**
+     * @brief Prepare the validation of a document
+     *
+     * @param schema schema
+     * @param error optional error description
+     */
+    EventValidator(const Schema &schema, ValidationError *error) :
+        m_schema(schema), m_error(error), m_stack(), m_keys(), m_skip(0), m_capture_depth(0), m_capture(), m_capture_node(ANY),
+        m_failed(false), m_overridden(false), m_watch_depth(0), m_watch_frames(0) {}
+
+    /**
+     * @brief Test whether an error was found
+     */
+    bool found_error() const {
+        return m_failed;
+    }
+
+    /**
+     * @brief Test whether the error found may not apply to the document tree
+     *
+     * After an error, the parsing goes on to the end of the document: if an object on the path
+     * of the error repeats its key, Parser keeps the last occurrence and the error may not be
+     * in the document tree. The validation must be done again on the tree.
+     *
+     * @return true if the error is on a value replaced by a repeated key
+     */
+    bool overridden() const {
+        return m_overridden;
+    }
+
+    /**
+     * @brief Handle a null value
+     */
+    bool null_value(Position p) {
+        if (m_skip != 0 || m_failed) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.null_value(p);
+        }
+        return scalar(Value());
+    }
+    /**
+     * @brief Handle a boolean value
+     */
+    bool boolean_value(bool v, Position p) {
+        if (m_skip != 0 || m_failed) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.boolean_value(v, p);
+        }
+        return scalar(Value(v));
+    }
+    /**
+     * @brief Handle a positive integer
+     */
+    bool uint64_value(uint64_t v, Position p) {
+        if (m_skip != 0 || m_failed) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.uint64_value(v, p);
+        }
+        return scalar(Value(v));
+    }
+    /**
+     * @brief Handle a negative integer
+     */
+    bool int64_value(int64_t v, Position p) {
+        if (m_skip != 0 || m_failed) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.int64_value(v, p);
+        }
+        return scalar(Value(v));
+    }
+    /**
+     * @brief Handle a floating point number
+     */
+    bool double_value(double v, Position p) {
+        if (m_skip != 0 || m_failed) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.double_value(v, p);
+        }
+        return scalar(Value(v));
+    }
+    /**
+     * @brief Handle a string
+     */
+    bool string_value(std::string &&v, Position p) {
+        if (m_skip != 0 || m_failed) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.string_value(std::move(v), p);
+        }
+        return scalar(Value(v));
+    }
+    /**
+     * @brief Handle the begining of an object
+     */
+    bool begin_object(Position p) {
+        return begin(false, p);
+    }
+    /**
+     * @brief Handle an object key
+     */
+    bool key(std::string &&k, Position p) {
+        if (m_failed) {
+            if (m_watch_depth <= m_watch_frames && k == m_stack[m_watch_depth - 1].m_key) {
+                // the value which failed is replaced, no need to parse further
+                m_overridden = true;
+                return false;
+            }
+            return true;
+        }
+        if (m_skip != 0) {
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            return m_capture.key(std::move(k), p);
+        }
+        Frame &f = m_stack.back();
+        const Node &n = m_schema.m_nodes[f.m_node];
+        if (f.m_keys_begin != NO_KEYS) {
+            m_keys.push_back(k);
+        }
+        f.m_child = property_node(n, k);
+        auto r = std::lower_bound(n.m_required.begin(), n.m_required.end(), k);
+        if (r != n.m_required.end() && *r == k) {
+            f.m_required_seen[static_cast<size_t>(r - n.m_required.begin())] = 1;
+        }
+        f.m_key = std::move(k);
+        return true;
+    }
+    /**
+     * @brief Handle the end of an object
+     */
+    bool end_object() {
+        return end(false);
+    }
+    /**
+     * @brief Handle the begining of an array
+     */
+    bool begin_array(Position p) {
+        return begin(true, p);
+    }
+    /**
+     * @brief Handle the end of an array
+     */
+    bool end_array() {
+        return end(true);
+    }
+
+private:
+    /**
+     * @brief An array or an object being validated
+     */
+    struct Frame {
+        size_t m_node;                      ///< node of the container
+        bool m_array;                       ///< the container is an array
+        size_t m_count;                     ///< number of elements or members already validated
+        size_t m_keys_begin;                ///< start of the keys of the object in m_keys, or NO_KEYS if they are not counted
+        size_t m_child;                     ///< node of the current member of an object
+        std::string m_key;                  ///< key of the current member of an object
+        std::vector<char> m_required_seen;  ///< required properties found so far
+    };
+
+    static constexpr size_t NO_KEYS = static_cast<size_t>(-1);
+
+    const Schema &m_schema;         ///< schema
+    ValidationError *m_error;       ///< optional error description
+    std::vector<Frame> m_stack;     ///< open arrays and objects
+    std::vector<std::string> m_keys;///< keys of the open objects whose distinct properties are counted
+    size_t m_skip;                  ///< depth in a container which doesn't need to be validated
+    size_t m_capture_depth;         ///< depth in a container being built for a whole value check
+    ValueBuilder m_capture;         ///< builder of the captured container
+    size_t m_capture_node;          ///< node validating the captured container
+    bool m_failed;                  ///< an error was found, the rest of the document is only watched for repeated keys
+    bool m_overridden;              ///< the error is on a value replaced by a repeated key
+    size_t m_watch_depth;           ///< depth in the document after the error
+    size_t m_watch_frames;          ///< number of frames of m_stack still open after the error
+
+    /**
+     * @brief Returns the node validating the next value
+     */
+    size_t target() const {
+        if (m_stack.empty()) {
+            return 0;
+        }
+        const Frame &f = m_stack.back();
+        return f.m_array ? m_schema.m_nodes[f.m_node].m_items : f.m_child;
+    }
+
+    /**
+     * @brief A value of the current container has been validated
+     */
+    bool done() {
+        if (!m_stack.empty()) {
+            ++m_stack.back().m_count;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Complete the pointer of the error with the path of the current value
+     *
+     * The parsing stops unless the error is in an object, whose key may be repeated later.
+     *
+     * @param depth depth of the parser in the document
+     * @return false to stop the parsing
+     */
+    bool failed(size_t depth) {
+        if (m_error != nullptr) {
+            std::string prefix;
+            for (const Frame &f : m_stack) {
+                prefix += '/';
+                prefix += f.m_array ? std::to_string(f.m_count) : Pointer::escape(f.m_key);
+            }
+            m_error->m_pointer.insert(0, prefix);
+        }
+        m_failed = true;
+        m_watch_depth = depth;
+        m_watch_frames = m_stack.size();
+        return std::any_of(m_stack.begin(), m_stack.end(), [](const Frame &f) { return !f.m_array; });
+    }
+
+    /**
+     * @brief Validate a scalar value
+     */
+    bool scalar(const Value &v) {
+        const size_t node = target();
+        if (node != ANY && !m_schema.check(node, v, m_error)) {
+            return failed(m_stack.size());
+        }
+        return done();
+    }
+
+    /**
+     * @brief Handle the begining of an array or an object
+     */
+    bool begin(bool array, Position p) {
+        if (m_failed) {
+            ++m_watch_depth;
+            return true;
+        }
+        if (m_skip != 0) {
+            ++m_skip;
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            ++m_capture_depth;
+            return array ? m_capture.begin_array(p) : m_capture.begin_object(p);
+        }
+        const size_t node = target();
+        if (node == ANY) {
+            m_skip = 1;
+            return true;
+        }
+        const Node &n = m_schema.m_nodes[node];
+        if (!check_type(n, array ? Type::Array : Type::Object, false, m_error)) {
+            // the container is open
+            return failed(m_stack.size() + 1);
+        }
+        if (!n.m_enum.empty() || n.m_has_const) {
+            // these keywords need the whole value
+            m_capture = ValueBuilder();
+            m_capture_node = node;
+            m_capture_depth = 1;
+            return array ? m_capture.begin_array(p) : m_capture.begin_object(p);
+        }
+        const bool counted = !array && (n.m_min_properties != 0 || n.m_max_properties != UNLIMITED);
+        m_stack.push_back({node, array, 0, counted ? m_keys.size() : NO_KEYS, ANY, {}, std::vector<char>(array ? 0 : n.m_required.size(), 0)});
+        return true;
+    }
+
+    /**
+     * @brief Handle the end of an array or an object
+     */
+    bool end(bool array) {
+        if (m_failed) {
+            --m_watch_depth;
+            m_watch_frames = std::min(m_watch_frames, m_watch_depth);
+            return true;
+        }
+        if (m_skip != 0) {
+            if (--m_skip == 0) {
+                return done();
+            }
+            return true;
+        }
+        if (m_capture_depth != 0) {
+            if (array) {
+                m_capture.end_array();
+            }
+            else {
+                m_capture.end_object();
+            }
+            if (--m_capture_depth == 0) {
+                if (!m_schema.check(m_capture_node, m_capture.get(), m_error)) {
+                    return failed(m_stack.size());
+                }
+                return done();
+            }
+            return true;
+        }
+        const Frame f = std::move(m_stack.back());
+        m_stack.pop_back();
+        const Node &n = m_schema.m_nodes[f.m_node];
+        if (array) {
+            if (f.m_count < n.m_min_items) {
+                fail(m_error, "too few items");
+                return failed(m_stack.size());
+            }
+            if (f.m_count > n.m_max_items) {
+                fail(m_error, "too many items");
+                return failed(m_stack.size());
+            }
+        }
+        else {
+            // as in the document tree, a repeated key is counted once
+            size_t count = f.m_count;
+            if (f.m_keys_begin != NO_KEYS) {
+                auto begin = m_keys.begin() + static_cast<std::ptrdiff_t>(f.m_keys_begin);
+                std::sort(begin, m_keys.end());
+                count = static_cast<size_t>(std::unique(begin, m_keys.end()) - begin);
+                m_keys.resize(f.m_keys_begin);
+            }
+            if (count < n.m_min_properties) {
+                fail(m_error, "too few properties");
+                return failed(m_stack.size());
+            }
+            if (count > n.m_max_properties) {
+                fail(m_error, "too many properties");
+                return failed(m_stack.size());
+            }
+            for (size_t i = 0; i < f.m_required_seen.size(); ++i) {
+                if (!f.m_required_seen[i]) {
+                    fail(m_error, "missing required property \"" + n.m_required[i] + "\"");
+                    return failed(m_stack.size());
+                }
+            }
+        }
+        return done();
+    }
+};
+
+inline Schema::Schema(const Value &schema) : m_nodes() {
+    compile(schema, "");
+}
+
+inline size_t Schema::compile(const Value &schema, const std::string &pointer) {
+    const size_t index = m_nodes.size();
+    m_nodes.emplace_back();
+    if (schema.get_type() == Type::Boolean) {
+        m_nodes[index].m_false = !schema.get<Type::Boolean>();
+        return index;
+    }
+    if (schema.get_type() != Type::Object) {
+        throw SchemaException(pointer, "a schema must be an object or a boolean");
+    }
+
+    auto to_size = [](const Value &v, const std::string &p) -> size_t {
+        switch (v.get_type()) {
+        case Type::UInt64:
+            return static_cast<size_t>(v.get<Type::UInt64>());
+        case Type::Int64:
+            if (v.get<Type::Int64>() >= 0) {
+                return static_cast<size_t>(v.get<Type::Int64>());
+            }
+            break;
+        case Type::Double:
+        {
+            const double d = v.get<Type::Double>();
+            if (d >= 0.0 && std::trunc(d) == d && d < 18446744073709551616.0) {
+                return static_cast<size_t>(d);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        throw SchemaException(p, "expected a non-negative integer");
+    };
+    auto to_number = [](const Value &v, const std::string &p) -> Value {
+        if (!(v.get_type() & MASK_TYPE_IS_NUMERIC)) {
+            throw SchemaException(p, "expected a number");
+        }
+        return v;
+    };
+    auto to_type = [](const Value &v, const std::string &p) -> unsigned int {
+        if (v.get_type() == Type::String) {
+            const std::string_view name = v.get<Type::String>();
+            if (name == "null") return TYPE_NULL;
+            if (name == "boolean") return TYPE_BOOLEAN;
+            if (name == "object") return TYPE_OBJECT;
+            if (name == "array") return TYPE_ARRAY;
+            if (name == "number") return TYPE_NUMBER;
+            if (name == "integer") return TYPE_INTEGER;
+            if (name == "string") return TYPE_STRING;
+        }
+        throw SchemaException(p, "unknown type");
+    };
+
+    // the node is built aside, the compilation of the subschemas may reallocate m_nodes
+    Node n;
+    for (const auto &m : schema.get<Type::Object>()) {
+        const std::string_view k = m.first;
+        const Value &v = m.second;
+        const std::string p = pointer + "/" + Pointer::escape(k);
+        if (k == "type") {
+            if (v.get_type() == Type::Array) {
+                size_t i = 0;
+                for (const Value &t : v.get<Type::Array>()) {
+                    n.m_types |= to_type(t, p + "/" + std::to_string(i++));
+                }
+            }
+            else {
+                n.m_types = to_type(v, p);
+            }
+            if (n.m_types & TYPE_NUMBER) {
+                n.m_types |= TYPE_INTEGER;
+            }
+        }
+        else if (k == "enum") {
+            if (v.get_type() != Type::Array) {
+                throw SchemaException(p, "expected an array");
+            }
+            n.m_enum.assign(v.get<Type::Array>().begin(), v.get<Type::Array>().end());
+            if (n.m_enum.empty()) {
+                // no value can match, as the false schema
+                n.m_false = true;
+            }
+        }
+        else if (k == "const") {
+            n.m_has_const = true;
+            n.m_const = v;
+        }
+        else if (k == "minimum") {
+            n.m_minimum = to_number(v, p);
+        }
+        else if (k == "maximum") {
+            n.m_maximum = to_number(v, p);
+        }
+        else if (k == "exclusiveMinimum") {
+            n.m_exclusive_minimum = to_number(v, p);
+        }
+        else if (k == "exclusiveMaximum") {
+            n.m_exclusive_maximum = to_number(v, p);
+        }
+        else if (k == "minLength") {
+            n.m_min_length = to_size(v, p);
+        }
+        else if (k == "maxLength") {
+            n.m_max_length = to_size(v, p);
+        }
+        else if (k == "pattern") {
+            if (v.get_type() != Type::String) {
+                throw SchemaException(p, "expected a string");
+            }
+            try {
+                n.m_pattern = Regex(v.get<Type::String>());
+            }
+            catch (const RegexException &e) {
+                throw SchemaException(p, std::string("invalid regular expression: ") + e.what());
+            }
+            n.m_has_pattern = true;
+        }
+        else if (k == "properties") {
+            if (v.get_type() != Type::Object) {
+                throw SchemaException(p, "expected an object");
+            }
+            // ObjectValues is sorted, so is m_properties
+            for (const auto &prop : v.get<Type::Object>()) {
+                n.m_properties.emplace_back(prop.first, compile_child(prop.second, p + "/" + Pointer::escape(prop.first)));
+            }
+        }
+        else if (k == "required") {
+            if (v.get_type() != Type::Array) {
+                throw SchemaException(p, "expected an array");
+            }
+            for (const Value &r : v.get<Type::Array>()) {
+                if (r.get_type() != Type::String) {
+                    throw SchemaException(p, "expected an array of strings");
+                }
+                n.m_required.emplace_back(r.get<Type::String>());
+            }
+            std::sort(n.m_required.begin(), n.m_required.end());
+            n.m_required.erase(std::unique(n.m_required.begin(), n.m_required.end()), n.m_required.end());
+        }
+        else if (k == "additionalProperties") {
+            n.m_additional = compile_child(v, p);
+        }
+        else if (k == "minProperties") {
+            n.m_min_properties = to_size(v, p);
+        }
+        else if (k == "maxProperties") {
+            n.m_max_properties = to_size(v, p);
+        }
+        else if (k == "items") {
+            n.m_items = compile_child(v, p);
+        }
+        else if (k == "minItems") {
+            n.m_min_items = to_size(v, p);
+        }
+        else if (k == "maxItems") {
+            n.m_max_items = to_size(v, p);
+        }
+    }
+    m_nodes[index] = std::move(n);
+    return index;
+}
+
+inline bool Schema::validate(const Value &doc, ValidationError *error) const {
+    return check(0, doc, error);
+}
+
+template<typename StatsPolicy> inline bool Schema::validate(std::string_view document, BasicParser<StatsPolicy> &parser, ValidationError *error) const {
+    EventValidator validator(*this, error);
+    parser.parse(document, validator);
+    if (!validator.overridden()) {
+        return !validator.found_error();
+    }
+    // the error is on a value replaced by a repeated key, validate the document tree
+    if (error != nullptr) {
+        *error = ValidationError();
+    }
+    ValueBuilder builder;
+    parser.parse(document, builder);
+    return check(0, builder.get(), error);
+}
+
+inline bool Schema::fail(ValidationError *error, const std::string &message) {
+    if (error != nullptr) {
+        error->m_pointer.clear();
+        error->m_message = message;
+    }
+    return false;
+}
+
+inline void Schema::prepend(ValidationError *error, std::string_view token) {
+    if (error != nullptr) {
+        error->m_pointer.insert(0, "/" + Pointer::escape(token));
+    }
+}
+
+inline size_t Schema::length(std::string_view s) {
+    // count the bytes which are not UTF-8 continuation bytes
+    size_t n = 0;
+    for (char c : s) {
+        n += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    }
+    return n;
+}
+
+inline size_t Schema::property_node(const Node &n, std::string_view key) {
+    auto it = std::lower_bound(n.m_properties.begin(), n.m_properties.end(), key,
+        [](const std::pair<std::string, size_t> &p, std::string_view k) { return p.first < k; });
+    if (it != n.m_properties.end() && it->first == key) {
+        return it->second;
+    }
+    return n.m_additional;
+}
+
+inline bool Schema::check_type(const Node &n, Type t, bool integral, ValidationError *error) {
+    if (n.m_false) {
+        return fail(error, "no value is allowed");
+    }
+    if (n.m_types == 0) {
+        return true;
+    }
+    unsigned int bits = 0;
+    switch (t) {
+    case Type::Null:
+        bits = TYPE_NULL;
+        break;
+    case Type::Boolean:
+        bits = TYPE_BOOLEAN;
+        break;
+    case Type::UInt64:
+    case Type::Int64:
+    case Type::Double:
+        bits = integral ? TYPE_INTEGER : TYPE_NUMBER;
+        break;
+    case Type::String:
+        bits = TYPE_STRING;
+        break;
+    case Type::Object:
+        bits = TYPE_OBJECT;
+        break;
+    case Type::Array:
+        bits = TYPE_ARRAY;
+        break;
+    }
+    if ((n.m_types & bits) == 0) {
+        return fail(error, "invalid type");
+    }
+    return true;
+}
+
+inline bool Schema::check(size_t node, const Value &v, ValidationError *error) const {
+    if (node == ANY) {
+        return true;
+    }
+    const Node &n = m_nodes[node];
+    const Type t = v.get_type();
+    bool integral = t == Type::UInt64 || t == Type::Int64;
+    if (t == Type::Double) {
+        const double d = v.get<Type::Double>();
+        integral = std::isfinite(d) && std::trunc(d) == d;
+    }
+    if (!check_type(n, t, integral, error)) {
+        return false;
+    }
+    if (!n.m_enum.empty() && std::find(n.m_enum.begin(), n.m_enum.end(), v) == n.m_enum.end()) {
+        return fail(error, "value is not one of the enumerated values");
+    }
+    if (n.m_has_const && !(n.m_const == v)) {
+        return fail(error, "value is not equal to the constant");
+    }
+
+    switch (t) {
+    case Type::UInt64:
+    case Type::Int64:
+    case Type::Double:
+        if (n.m_minimum.get_type() != Type::Null && Query::compare(&v, CompareOp::Less, &n.m_minimum)) {
+            return fail(error, "value is less than the minimum");
+        }
+        if (n.m_maximum.get_type() != Type::Null && Query::compare(&v, CompareOp::Greater, &n.m_maximum)) {
+            return fail(error, "value is greater than the maximum");
+        }
+        if (n.m_exclusive_minimum.get_type() != Type::Null && !Query::compare(&v, CompareOp::Greater, &n.m_exclusive_minimum)) {
+            return fail(error, "value is less than or equal to the exclusive minimum");
+        }
+        if (n.m_exclusive_maximum.get_type() != Type::Null && !Query::compare(&v, CompareOp::Less, &n.m_exclusive_maximum)) {
+            return fail(error, "value is greater than or equal to the exclusive maximum");
+        }
+        return true;
+    case Type::String:
+    {
+        const std::string_view s = v.get<Type::String>();
+        if (n.m_min_length != 0 || n.m_max_length != UNLIMITED) {
+            const size_t len = length(s);
+            if (len < n.m_min_length) {
+                return fail(error, "string is too short");
+            }
+            if (len > n.m_max_length) {
+                return fail(error, "string is too long");
+            }
+        }
+        if (n.m_has_pattern && !n.m_pattern.search(s)) {
+            return fail(error, "string does not match the pattern");
+        }
+        return true;
+    }
+    case Type::Object:
+    {
+        // same order as the event validator: the members, then the counts, then the required properties
+        const ObjectValues &map = v.get<Type::Object>();
+        if (!check_object(n, map, error)) {
+            return false;
+        }
+        if (map.size() < n.m_min_properties) {
+            return fail(error, "too few properties");
+        }
+        if (map.size() > n.m_max_properties) {
+            return fail(error, "too many properties");
+        }
+        for (const std::string &r : n.m_required) {
+            if (map.find(std::string_view(r)) == map.end()) {
+                return fail(error, "missing required property \"" + r + "\"");
+            }
+        }
+        return true;
+    }
+    case Type::Array:
+    {
+        const ArrayValues &list = v.get<Type::Array>();
+        if (n.m_items != ANY) {
+            size_t i = 0;
+            for (const Value &e : list) {
+                if (!check(n.m_items, e, error)) {
+                    prepend(error, std::to_string(i));
+                    return false;
+                }
+                ++i;
+            }
+        }
+        if (list.size() < n.m_min_items) {
+            return fail(error, "too few items");
+        }
+        if (list.size() > n.m_max_items) {
+            return fail(error, "too many items");
+        }
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+inline bool Schema::check_object(const Node &n, const ObjectValues &map, ValidationError *error) const {
+    if (n.m_properties.empty() && n.m_additional == ANY) {
+        return true;
+    }
+    // the error reported is the one of the invalid member found first in the document, as by the
+    // event validator: after a failure, only the members starting before the invalid one are checked
+    const std::pmr::string *invalid = nullptr;
+    uint64_t invalid_offset = 0;
+    ValidationError first;
+    // both the members and the properties are sorted by key
+    auto prop = n.m_properties.begin();
+    for (const auto &m : map) {
+        while (prop != n.m_properties.end() && std::string_view(prop->first) < m.first) {
+            ++prop;
+        }
+        const uint64_t offset = m.second.get_position().m_offset;
+        if (invalid != nullptr && offset >= invalid_offset) {
+            continue;
+        }
+        const size_t child = prop != n.m_properties.end() && std::string_view(prop->first) == m.first ? prop->second : n.m_additional;
+        ValidationError e;
+        if (!check(child, m.second, error != nullptr ? &e : nullptr)) {
+            invalid = &m.first;
+            invalid_offset = offset;
+            first = std::move(e);
+        }
+    }
+    if (invalid == nullptr) {
+        return true;
+    }
+    if (error != nullptr) {
+        *error = std::move(first);
+        prepend(error, *invalid);
+    }
+    return false;
+}
+
+}
+
+#endif /* H315680FD_462C_4B05_967C_E3BD986F0BF9 */
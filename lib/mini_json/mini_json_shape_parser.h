@@ -0,0 +1,125 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H887A94CC_2C71_4686_BBD9_D291FE232603
+#define H887A94CC_2C71_4686_BBD9_D291FE232603
+
+#include <cstdint>
+
+#include <string_view>
+
+#include <mini_json/mini_json_parser.h>
+#include <mini_json/mini_json_binding.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Parser specialized for the shape of a bound type
+ *
+ * The parser is generated from the Binding of the type. It reads the documents directly
+ * into the destination and expects them to have the shape of the type:
+ * - the keys of the objects are expected in the order of the binding, so that each key is
+ *   a single comparison, and are otherwise looked up with the perfect hash of the binding
+ * - the integers are read into their fixed-width members, the numbers are converted to
+ *   double without strtod when the conversion is exact
+ * - the strings are copied as they are
+ *
+ * Any surprise (an unknown key, a string with an escape sequence or a non-ASCII character,
+ * a number requiring more precision, a value of an unexpected type, a malformed document)
+ * falls back to the generic Parser and Binder::decode(), which decodes the document again
+ * or reports the error. Both paths produce the same result.
+ *
+ * @tparam T bound type
+ */
+template<typename T>
+class ShapeParser {
+public:
+    /**
+     * @brief Build a new parser
+     */
+    ShapeParser() : m_parser(), m_documents(0), m_fallbacks(0) {}
+
+    /**
+     * @brief Decode a document
+     *
+     * @param document document, UTF-8 encoded
+     * @return decoded value
+     * @throws BindingException if the document does not match the type
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    T decode(std::string_view document) {
+        T out{};
+        decode(document, out);
+        return out;
+    }
+
+    /**
+     * @brief Decode a document into an existing value
+     *
+     * Same semantic as Binder::decode(): the members of the structs which are missing from
+     * the document are left unchanged, the containers are cleared before being filled.
+     *
+     * @param document document, UTF-8 encoded
+     * @param out decoded value
+     * @throws BindingException if the document does not match the type
+     * @throws MalFormedException
+     * @throws MaximumDepthException
+     * @throws UTF8Exception
+     */
+    void decode(std::string_view document, T &out);
+
+    /**
+     * @brief Returns the generic parser used for the fallback
+     *
+     * Its maximum depth also applies to the fast path.
+     *
+     * @return parser
+     */
+    Parser & get_parser() {
+        return m_parser;
+    }
+
+    /**
+     * @brief Returns the number of decoded documents
+     *
+     * @return number of documents
+     */
+    uint64_t get_documents() const {
+        return m_documents;
+    }
+
+    /**
+     * @brief Returns the number of documents decoded by the generic Parser
+     *
+     * @return number of fallbacks
+     */
+    uint64_t get_fallbacks() const {
+        return m_fallbacks;
+    }
+
+private:
+    Parser m_parser;        ///< generic parser
+    uint64_t m_documents;   ///< number of decoded documents
+    uint64_t m_fallbacks;   ///< number of documents decoded by m_parser
+};
+
+}
+
+#include <mini_json/mini_json_shape_parser_impl.h>
+
+#endif /* H887A94CC_2C71_4686_BBD9_D291FE232603 */
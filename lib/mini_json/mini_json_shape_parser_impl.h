@@ -0,0 +1,37 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H79DA9C8E_9293_429E_B9A0_2DA19090E556
+#define H79DA9C8E_9293_429E_B9A0_2DA19090E556
+
+#include <mini_json/mini_json_shape_parser.h>
+
+namespace MiniJSON {
+
+template<typename T>
+inline void ShapeParser<T>::decode(std::string_view document, T &out) {
+    ++m_documents;
+    Binder::Cursor cursor(document, m_parser.getMaxDepth());
+    if (Binder::Codec<T>::read(cursor, out) && cursor.at_end()) {
+        return;
+    }
+    ++m_fallbacks;
+    Binder::decode(document, m_parser, out);
+}
+
+}
+
+#endif /* H79DA9C8E_9293_429E_B9A0_2DA19090E556 */
@@ -0,0 +1,359 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H500F93DC_8947_4F0A_A0B5_AEE45C7AF84C
+#define H500F93DC_8947_4F0A_A0B5_AEE45C7AF84C
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+#include <mini_json/mini_json_snapshot.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Epoch based memory reclamation
+ *
+ * Readers enter a critical section with a Guard. Objects unlinked by the writers are retired with
+ * the current epoch and are only deleted once every reader which could still see them has left
+ * its critical section.
+ *
+ * Each thread owns a record, registered on its first Guard and recycled when the thread exits.
+ * Apart from this registration, entering and leaving a critical section is wait-free.
+ *
+ * There is a single process-wide domain, shared by all the SharedDocument instances. It is created
+ * by the first Guard or SharedDocument, so it outlives the documents with static storage duration.
+ *
+ * The retired objects are collected when an object is retired, and when a reader which may still
+ * reference one of them leaves its outermost critical section.
+ */
+class EpochDomain {
+    struct Record;
+public:
+    /**
+     * @brief A read-side critical section
+     *
+     * Guards can be nested. A Guard must be destroyed by the thread which created it.
+     */
+    class Guard {
+    public:
+        /**
+         * @brief Enter a critical section
+         */
+        Guard() : m_record(EpochDomain::instance().enter()) {}
+        /**
+         * @brief Leave the critical section
+         */
+        ~Guard() {
+            EpochDomain::instance().leave(m_record);
+        }
+        Guard(const Guard &) = delete;
+        Guard & operator=(const Guard &) = delete;
+    private:
+        Record *m_record;   ///< record of the calling thread
+    };
+
+    /**
+     * @brief Returns the process-wide domain
+     *
+     * @return domain
+     */
+    static EpochDomain & instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    /**
+     * @brief Retire an object which is no longer reachable by new readers
+     *
+     * The object will be deleted by a later call to collect(), once all the readers
+     * which may hold a reference on it have left their critical section.
+     * This method also calls collect().
+     *
+     * @param p object
+     * @param deleter function called to delete the object
+     */
+    void retire(const void *p, void (*deleter)(const void *));
+
+    /**
+     * @brief Delete the retired objects which are no longer referenced by a reader
+     *
+     * @return number of objects deleted
+     */
+    size_t collect();
+
+    /**
+     * @brief Returns the number of retired objects waiting to be deleted
+     *
+     * @return number of objects
+     */
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(m_retired_mutex);
+        return m_retired.size();
+    }
+
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain & operator=(const EpochDomain &) = delete;
+
+    /**
+     * @brief Destroy the domain and delete all the retired objects
+     */
+    ~EpochDomain();
+
+private:
+    /**
+     * @brief Per-thread state
+     */
+    struct Record {
+        std::atomic<uint64_t> m_epoch;      ///< epoch observed when entering the critical section, 0 when inactive
+        std::atomic<bool> m_in_use;         ///< true while owned by a thread
+        Record *m_next;                     ///< next record, records are never removed from the list
+        unsigned int m_nesting;             ///< nesting level of the guards, only accessed by the owning thread
+
+        Record() : m_epoch(0), m_in_use(true), m_next(nullptr), m_nesting(0) {}
+    };
+
+    /**
+     * @brief A retired object
+     */
+    struct Retired {
+        const void *m_ptr;                  ///< object
+        void (*m_deleter)(const void *);    ///< function deleting the object
+        uint64_t m_epoch;                   ///< epoch at which the object was retired
+    };
+
+    std::atomic<uint64_t> m_global_epoch;   ///< current epoch, starts at 1
+    std::atomic<Record *> m_records;        ///< list of the thread records
+    mutable std::mutex m_retired_mutex;     ///< protects m_retired
+    std::vector<Retired> m_retired;         ///< objects waiting for deletion
+    std::atomic<uint64_t> m_retired_epoch;  ///< newest epoch of the objects waiting for deletion, 0 if none
+
+    EpochDomain() : m_global_epoch(1), m_records(nullptr), m_retired_mutex(), m_retired(), m_retired_epoch(0) {}
+
+    /**
+     * @brief Returns the record of the calling thread, registering it if needed
+     *
+     * @return record
+     */
+    Record * local_record();
+
+    /**
+     * @brief Enter a critical section
+     *
+     * @return record of the calling thread
+     */
+    Record * enter();
+
+    /**
+     * @brief Leave a critical section
+     *
+     * Leaving the outermost critical section collects the retired objects if the reader may have
+     * been the last one to reference some of them.
+     *
+     * @param r record of the calling thread
+     */
+    void leave(Record *r) {
+        if (--r->m_nesting == 0) {
+            const uint64_t epoch = r->m_epoch.load(std::memory_order_relaxed);
+            r->m_epoch.store(0, std::memory_order_seq_cst);
+            if (epoch <= m_retired_epoch.load(std::memory_order_seq_cst)) {
+                collect();
+            }
+        }
+    }
+};
+
+/**
+ * @brief A Snapshot published to many concurrent readers
+ *
+ * This is a read-copy-update holder : the readers get the current version without taking any lock
+ * and the writers publish a whole new version, usually built from the previous one with the
+ * Snapshot modifying methods so that the unchanged subtrees are shared.
+ *
+ * The replaced versions are reclaimed through the EpochDomain once the readers are gone.
+ * A reader which needs to keep a version beyond its critical section can copy the Snapshot,
+ * which only increments a reference count.
+ *
+ * Example:
+ * @code
+ * SharedDocument flags(Snapshot(Parser().parse(text)));
+ * // readers
+ * {
+ *     auto doc = flags.read();
+ *     bool enabled = (*doc)["feature"].get<Type::Boolean>();
+ * }
+ * // writers
+ * flags.update([](const Snapshot &cur) { return cur.set("feature", false); });
+ * @endcode
+ */
+class SharedDocument {
+public:
+    /**
+     * @brief Access to the current version of a document
+     *
+     * The version stays valid as long as this object lives.
+     * A Reader must be destroyed by the thread which created it.
+     */
+    class Reader {
+    public:
+        /**
+         * @brief Returns the document
+         *
+         * @return document
+         */
+        const Snapshot & operator*() const noexcept {
+            return *m_snapshot;
+        }
+        /**
+         * @brief Member access to the document
+         *
+         * @return document
+         */
+        const Snapshot * operator->() const noexcept {
+            return m_snapshot;
+        }
+        /**
+         * @brief Returns the document
+         *
+         * @return document
+         */
+        const Snapshot & get() const noexcept {
+            return *m_snapshot;
+        }
+    private:
+        friend class SharedDocument;
+        EpochDomain::Guard m_guard;         ///< critical section, must be entered before loading m_snapshot
+        const Snapshot *m_snapshot;         ///< current version
+
+        explicit Reader(const std::atomic<const Snapshot *> &current) :
+            m_guard(), m_snapshot(current.load(std::memory_order_seq_cst)) {}
+    };
+
+    /**
+     * @brief Constructs a document holding a null value
+     */
+    SharedDocument() : m_current(new Snapshot()), m_version(0), m_write_mutex() {
+        // the domain must be constructed first, to be destroyed after this document
+        EpochDomain::instance();
+    }
+    /**
+     * @brief Constructs a document
+     *
+     * @param s initial version
+     */
+    explicit SharedDocument(Snapshot s) : m_current(new Snapshot(std::move(s))), m_version(0), m_write_mutex() {
+        EpochDomain::instance();
+    }
+
+    SharedDocument(const SharedDocument &) = delete;
+    SharedDocument & operator=(const SharedDocument &) = delete;
+
+    /**
+     * @brief Retire the current version
+     *
+     * There must not be any Reader left on this document.
+     */
+    ~SharedDocument() {
+        EpochDomain::instance().retire(m_current.load(), &delete_snapshot);
+    }
+
+    /**
+     * @brief Get the current version, wait-free
+     *
+     * @return Reader
+     */
+    Reader read() const {
+        return Reader(m_current);
+    }
+
+    /**
+     * @brief Get a reference counted copy of the current version
+     *
+     * @return document
+     */
+    Snapshot load() const {
+        EpochDomain::Guard guard;
+        return *m_current.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Publish a new version
+     *
+     * @param s new version
+     */
+    void store(Snapshot s) {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        store_locked(std::move(s));
+    }
+
+    /**
+     * @brief Build and publish a new version from the current one
+     *
+     * The updates are serialized, so no update is lost.
+     *
+     * @tparam F callable with the signature Snapshot(const Snapshot &)
+     * @param f function returning the new version
+     * @return the new version
+     */
+    template<typename F> Snapshot update(F &&f) {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        // writers are serialized, the current version can't be retired under our feet
+        Snapshot s = f(*m_current.load(std::memory_order_acquire));
+        store_locked(s);
+        return s;
+    }
+
+    /**
+     * @brief Returns the number of versions published since the construction
+     *
+     * @return version number
+     */
+    uint64_t version() const noexcept {
+        return m_version.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<const Snapshot *> m_current;    ///< current version
+    std::atomic<uint64_t> m_version;            ///< number of stores
+    std::mutex m_write_mutex;                   ///< serializes the writers
+
+    /**
+     * @brief Publish a new version, m_write_mutex must be held
+     *
+     * @param s new version
+     */
+    void store_locked(Snapshot s);
+
+    /**
+     * @brief Deleter used to reclaim the versions
+     *
+     * @param p Snapshot allocated with new
+     */
+    static void delete_snapshot(const void *p) {
+        delete static_cast<const Snapshot *>(p);
+    }
+};
+
+}
+
+#include <mini_json/mini_json_shared_document_impl.h>
+
+#endif /* H500F93DC_8947_4F0A_A0B5_AEE45C7AF84C */
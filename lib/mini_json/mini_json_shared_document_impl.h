@@ -0,0 +1,139 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H0FA78A12_C8F5_4EEE_8D51_FE67CCD09E1E
+#define H0FA78A12_C8F5_4EEE_8D51_FE67CCD09E1E
+
+#include <algorithm>
+#include <limits>
+#include <mini_json/mini_json_shared_document.h>
+
+namespace MiniJSON {
+
+inline EpochDomain::Record * EpochDomain::local_record() {
+    // releases the record when the thread exits, so that another thread can reuse it
+    struct LocalRecord {
+        Record *m_record = nullptr;
+        ~LocalRecord() {
+            if (m_record != nullptr) {
+                m_record->m_in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+    static thread_local LocalRecord local;
+
+    if (local.m_record != nullptr) {
+        return local.m_record;
+    }
+
+    // try to reuse the record of a dead thread
+    for (Record *r = m_records.load(std::memory_order_acquire); r != nullptr; r = r->m_next) {
+        bool expected = false;
+        if (!r->m_in_use.load(std::memory_order_relaxed) &&
+            r->m_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            local.m_record = r;
+            return r;
+        }
+    }
+
+    // register a new record
+    Record *r = new Record();
+    Record *head = m_records.load(std::memory_order_relaxed);
+    do {
+        r->m_next = head;
+    } while (!m_records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+    local.m_record = r;
+    return r;
+}
+
+inline EpochDomain::Record * EpochDomain::enter() {
+    Record *r = local_record();
+    if (r->m_nesting++ == 0) {
+        // the epoch must be published before the reader loads any shared pointer
+        r->m_epoch.store(m_global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    return r;
+}
+
+inline void EpochDomain::retire(const void *p, void (*deleter)(const void *)) {
+    {
+        // the object has already been unlinked, so the readers who may still see it
+        // have observed an epoch <= the one returned here
+        const uint64_t epoch = m_global_epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(m_retired_mutex);
+        m_retired.push_back({p, deleter, epoch});
+        m_retired_epoch.store(std::max(m_retired_epoch.load(std::memory_order_relaxed), epoch), std::memory_order_seq_cst);
+    }
+    collect();
+}
+
+inline size_t EpochDomain::collect() {
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_retired_mutex);
+        if (m_retired.empty()) {
+            return 0;
+        }
+
+        // oldest epoch still observed by a reader
+        uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+        for (Record *r = m_records.load(std::memory_order_acquire); r != nullptr; r = r->m_next) {
+            uint64_t e = r->m_epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < min_epoch) {
+                min_epoch = e;
+            }
+        }
+
+        auto it = std::partition(m_retired.begin(), m_retired.end(),
+            [min_epoch](const Retired &o) { return o.m_epoch >= min_epoch; });
+        ready.assign(it, m_retired.end());
+        m_retired.erase(it, m_retired.end());
+        uint64_t newest = 0;
+        for (const auto &o : m_retired) {
+            newest = std::max(newest, o.m_epoch);
+        }
+        m_retired_epoch.store(newest, std::memory_order_seq_cst);
+    }
+
+    // delete outside of the lock, destroying a large document may take a while
+    for (const auto &o : ready) {
+        o.m_deleter(o.m_ptr);
+    }
+    return ready.size();
+}
+
+inline EpochDomain::~EpochDomain() {
+    for (const auto &o : m_retired) {
+        o.m_deleter(o.m_ptr);
+    }
+    Record *r = m_records.load();
+    while (r != nullptr) {
+        Record *next = r->m_next;
+        delete r;
+        r = next;
+    }
+}
+
+inline void SharedDocument::store_locked(Snapshot s) {
+    const Snapshot *next = new Snapshot(std::move(s));
+    const Snapshot *prev = m_current.exchange(next, std::memory_order_seq_cst);
+    m_version.fetch_add(1, std::memory_order_release);
+    EpochDomain::instance().retire(prev, &delete_snapshot);
+}
+
+}
+
+#endif /* H0FA78A12_C8F5_4EEE_8D51_FE67CCD09E1E */
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H5F59FD21_5CAC_4B42_B86E_BAC3C16E1FD9
+#define H5F59FD21_5CAC_4B42_B86E_BAC3C16E1FD9
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MiniJSON {
+
+/**
+ * @brief A memory resource serving the small blocks of a document from size-class slabs
+ *
+ * The blocks up to MAX_BLOCK bytes (the Value contents, the nodes of the objects and arrays,
+ * the short strings) are rounded to a size class and carved from slabs of SLAB_SIZE bytes
+ * obtained from the upstream resource. Each slab only holds blocks of one class, so the freed
+ * blocks are reused exactly and the churn of the nodes of a mutable document doesn't fragment
+ * the memory. The larger blocks are forwarded to the upstream resource.
+ *
+ * Each thread allocating from the resource owns a heap of free lists and slabs, reached
+ * without locking through a thread-local cache. A block freed by another thread than the owner
+ * of its slab is pushed to a lock-free list of the owner, which takes the blocks back when its
+ * own free list is empty.
+ *
+ * The slabs are only returned to the upstream resource by release() or by the destructor:
+ * using one resource per document reclaims all the memory of the document at once.
+ * @code
+ * MiniJSON::SlabResource slab;
+ * MiniJSON::Value doc = parser.parse(text, &slab);
+ * @endcode
+ * The resource must outlive the values allocated from it.
+ */
+class SlabResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t SLAB_SIZE = size_t(1) << 16;    ///< size and alignment of a slab
+    static constexpr size_t MAX_BLOCK = 256;                ///< largest block served from the slabs
+    static constexpr size_t MAX_ALIGN = 16;                 ///< largest alignment served from the slabs
+
+    /**
+     * @brief Build a new resource
+     *
+     * @param upstream resource of the slabs and of the large blocks, it must support the
+     *        alignment of SLAB_SIZE
+     */
+    explicit SlabResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+    SlabResource(const SlabResource &) = delete;
+    SlabResource & operator=(const SlabResource &) = delete;
+
+    /**
+     * @brief Release all the slabs
+     */
+    ~SlabResource() override;
+
+    /**
+     * @brief Return all the slabs to the upstream resource
+     *
+     * No value allocated from this resource may be used or destroyed afterwards, nor can
+     * any thread be allocating from it. The large blocks are not released.
+     */
+    void release();
+
+    /**
+     * @brief Returns the upstream resource
+     *
+     * @return upstream resource
+     */
+    std::pmr::memory_resource * upstream_resource() const noexcept {
+        return m_upstream;
+    }
+
+    /**
+     * @brief Returns the memory reserved in slabs
+     *
+     * @return number of bytes
+     */
+    size_t slab_bytes() const;
+
+protected:
+    void * do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    static constexpr size_t CLASSES = 12;   ///< number of size classes
+    static constexpr size_t CLASS_SIZES[CLASSES] = {16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256}; ///< block size of each class
+
+    /**
+     * @brief A free block, linked in a free list
+     */
+    struct Block {
+        Block *m_next;  ///< next free block
+    };
+
+    struct Heap;
+
+    /**
+     * @brief Header of a slab, at its beginning
+     */
+    struct Slab {
+        Heap *m_owner;      ///< heap which carves and reuses the blocks of this slab
+        size_t m_class;     ///< size class of the blocks
+    };
+
+    /**
+     * @brief Free lists and current slabs of a thread
+     */
+    struct Heap {
+        std::thread::id m_thread;                               ///< owner thread
+        std::array<Block *, CLASSES> m_free;                    ///< free blocks, per class
+        std::array<char *, CLASSES> m_bump;                     ///< next block of the current slab, per class
+        std::array<char *, CLASSES> m_end;                      ///< end of the current slab, per class
+        std::array<std::atomic<Block *>, CLASSES> m_remote;     ///< blocks freed by other threads, per class
+
+        explicit Heap(std::thread::id t) : m_thread(t), m_free(), m_bump(), m_end(), m_remote() {
+            for (auto &r : m_remote) {
+                r.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief Returns the size class of a block
+     *
+     * @param bytes size of the block, at most MAX_BLOCK
+     * @return class index
+     */
+    static size_t size_class(size_t bytes) noexcept;
+
+    /**
+     * @brief Returns a new identifier, never reused by another resource
+     *
+     * @return identifier
+     */
+    static uint64_t new_id() noexcept;
+
+    /**
+     * @brief Returns the heap of the calling thread, creating it if needed
+     *
+     * @return heap
+     */
+    Heap * local_heap();
+
+    /**
+     * @brief Carve a block from the current slab of a class, or from a new slab
+     *
+     * @param h heap of the calling thread
+     * @param c size class
+     * @return block
+     */
+    void * carve(Heap *h, size_t c);
+
+    std::pmr::memory_resource *m_upstream;      ///< upstream resource
+    const uint64_t m_id;                        ///< unique identifier, for the thread-local caches
+    mutable std::mutex m_mutex;                 ///< protects the heaps, the slabs and the upstream resource
+    std::vector<std::unique_ptr<Heap>> m_heaps; ///< heaps of the threads
+    std::vector<void *> m_slabs;                ///< slabs obtained from the upstream resource
+};
+
+}
+
+#include <mini_json/mini_json_slab_impl.h>
+
+#endif /* H5F59FD21_5CAC_4B42_B86E_BAC3C16E1FD9 */
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H4DDC0E31_2CCE_4289_9F4D_5B16819C5A59
+#define H4DDC0E31_2CCE_4289_9F4D_5B16819C5A59
+
+#include <mini_json/mini_json_slab.h>
+
+namespace MiniJSON {
+
+inline SlabResource::SlabResource(std::pmr::memory_resource *upstream) :
+    m_upstream(upstream), m_id(new_id()), m_mutex(), m_heaps(), m_slabs() {}
+
+inline uint64_t SlabResource::new_id() noexcept {
+    static std::atomic<uint64_t> next_id(1);
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline SlabResource::~SlabResource() {
+    release();
+}
+
+inline void SlabResource::release() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (void *s : m_slabs) {
+        m_upstream->deallocate(s, SLAB_SIZE, SLAB_SIZE);
+    }
+    m_slabs.clear();
+    for (auto &h : m_heaps) {
+        h->m_free.fill(nullptr);
+        h->m_bump.fill(nullptr);
+        h->m_end.fill(nullptr);
+        for (auto &r : h->m_remote) {
+            r.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline size_t SlabResource::slab_bytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slabs.size() * SLAB_SIZE;
+}
+
+inline size_t SlabResource::size_class(size_t bytes) noexcept {
+    static constexpr uint8_t CLASS_OF_GRANULE[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11};
+    return CLASS_OF_GRANULE[(bytes + 15) / 16];
+}
+
+inline SlabResource::Heap * SlabResource::local_heap() {
+    struct CacheEntry {
+        uint64_t m_id;  ///< identifier of the resource
+        Heap *m_heap;   ///< heap of this thread in the resource
+    };
+    static thread_local std::array<CacheEntry, 4> cache{};
+
+    CacheEntry &e = cache[m_id & 3];
+    if (e.m_id == m_id) {
+        return e.m_heap;
+    }
+
+    const std::thread::id self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Heap *heap = nullptr;
+    for (auto &h : m_heaps) {
+        // a finished thread may have the same id: its heap is reused
+        if (h->m_thread == self) {
+            heap = h.get();
+            break;
+        }
+    }
+    if (heap == nullptr) {
+        m_heaps.push_back(std::make_unique<Heap>(self));
+        heap = m_heaps.back().get();
+    }
+    e = CacheEntry{m_id, heap};
+    return heap;
+}
+
+inline void * SlabResource::carve(Heap *h, size_t c) {
+    const size_t size = CLASS_SIZES[c];
+    if (size_t(h->m_end[c] - h->m_bump[c]) < size) {
+        void *s;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            s = m_upstream->allocate(SLAB_SIZE, SLAB_SIZE);
+            try {
+                m_slabs.push_back(s);
+            }
+            catch (...) {
+                m_upstream->deallocate(s, SLAB_SIZE, SLAB_SIZE);
+                throw;
+            }
+        }
+        new (s) Slab{h, c};
+        h->m_bump[c] = static_cast<char *>(s) + MAX_ALIGN * ((sizeof(Slab) + MAX_ALIGN - 1) / MAX_ALIGN);
+        h->m_end[c] = static_cast<char *>(s) + SLAB_SIZE;
+    }
+    void *p = h->m_bump[c];
+    h->m_bump[c] += size;
+    return p;
+}
+
+inline void * SlabResource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > MAX_BLOCK || alignment > MAX_ALIGN) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_upstream->allocate(bytes, alignment);
+    }
+    const size_t c = size_class(bytes);
+    Heap *h = local_heap();
+    Block *b = h->m_free[c];
+    if (b == nullptr) {
+        b = h->m_remote[c].exchange(nullptr, std::memory_order_acquire);
+        if (b == nullptr) {
+            return carve(h, c);
+        }
+    }
+    h->m_free[c] = b->m_next;
+    return b;
+}
+
+inline void SlabResource::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    if (bytes > MAX_BLOCK || alignment > MAX_ALIGN) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+    const Slab *s = reinterpret_cast<const Slab *>(reinterpret_cast<uintptr_t>(p) & ~uintptr_t(SLAB_SIZE - 1));
+    Block *b = static_cast<Block *>(p);
+    Heap *h = local_heap();
+    if (s->m_owner == h) {
+        b->m_next = h->m_free[s->m_class];
+        h->m_free[s->m_class] = b;
+        return;
+    }
+    // only the owner takes the whole list, so the push can't suffer from ABA
+    std::atomic<Block *> &remote = s->m_owner->m_remote[s->m_class];
+    b->m_next = remote.load(std::memory_order_relaxed);
+    while (!remote.compare_exchange_weak(b->m_next, b, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+}
+
+#endif /* H4DDC0E31_2CCE_4289_9F4D_5B16819C5A59 */
@@ -0,0 +1,666 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HB64C9263_5333_448A_8162_D4D562FB7E96
+#define HB64C9263_5333_448A_8162_D4D562FB7E96
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <any>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_key.h>
+
+namespace MiniJSON {
+
+class Snapshot;
+
+/**
+ * @brief The underlying type of a Snapshot representing a JSON object
+ *
+ * The members are sorted by key and the keys are unique, as in ObjectValues.
+ * The keys may be interned in a KeyTable.
+ */
+typedef std::vector<std::pair<Key, Snapshot>> ObjectSnapshots;
+/**
+ * @brief The underlying type of a Snapshot representing a JSON array
+ *
+ */
+typedef std::vector<Snapshot> ArraySnapshots;
+
+/**
+ * @brief A templated struct holding the mapping between the Type enum and the data type stored in a Snapshot
+ *
+ * The numbers and booleans are the same as for a Value (see TypeToNative); the strings are std::string and the containers differ.
+ */
+template<Type T> struct SnapshotTypeToNative { typedef typename TypeToNative<T>::type type; /*!< scalar data type */};
+/**
+ * @brief Specialization of SnapshotTypeToNative for String
+ */
+template<> struct SnapshotTypeToNative<Type::String> { typedef std::string type; /*!< JSON string data type, the nodes do not use a memory resource */};
+/**
+ * @brief Specialization of SnapshotTypeToNative for Object
+ */
+template<> struct SnapshotTypeToNative<Type::Object> { typedef ObjectSnapshots type; /*!< JSON object data type */};
+/**
+ * @brief Specialization of SnapshotTypeToNative for Array
+ */
+template<> struct SnapshotTypeToNative<Type::Array>  { typedef ArraySnapshots type; /*!< JSON array data type */};
+
+/**
+ * @brief An immutable, reference-counted JSON value
+ *
+ * A Snapshot is a handle on an immutable node. Copying a Snapshot is O(1): only the reference
+ * count of the node is incremented. The nodes are never modified once built, so the "modifying"
+ * methods (set(), erase(), push_back()...) return a new root which shares every untouched subtree
+ * with the original document.
+ *
+ * The reference counts are managed by std::shared_ptr and are atomic, so a Snapshot can be copied
+ * to and read by any number of threads. As for std::shared_ptr, a single Snapshot object must not be
+ * reassigned while other threads are reading it (see SharedDocument for that purpose).
+ *
+ * The default constructed Snapshot is a null value and does not allocate any memory.
+ */
+class Snapshot {
+public:
+    /**
+     * @brief Constructs a null JSON value
+     *
+     */
+    Snapshot() noexcept : m_node() {}
+    /**
+     * @brief Constructs a boolean JSON value
+     *
+     * @param v value
+     * @param p Position in stream
+     */
+    Snapshot(bool v, Position p = {}) : m_node(make_node(Boolean, v, p)) {}
+    /**
+     * @brief Constructs a number JSON value holding unsigned 64 bits integer values
+     *
+     * @param v value
+     * @param p Position in stream
+     */
+    Snapshot(uint64_t v, Position p = {}) : m_node(make_node(UInt64, v, p)) {}
+    /**
+     * @brief Constructs a number JSON value holding signed 64 bits integer values
+     *
+     * @param v value
+     * @param p Position in stream
+     */
+    Snapshot(int64_t v, Position p = {}) : m_node(make_node(Int64, v, p)) {}
+    /**
+     * @brief Constructs a number JSON value holding unsigned 64 bits integer values
+     *
+     * @param v value
+     * @param p Position in stream
+     */
+    Snapshot(unsigned int v, Position p = {}) : m_node(make_node(UInt64, uint64_t(v), p)) {}
+    /**
+     * @brief Constructs a number JSON value holding signed 64 bits integer values
+     *
+     * @param v value
+     * @param p Position in stream
+     */
+    Snapshot(int v, Position p = {}) : m_node(make_node(Int64, int64_t(v), p)) {}
+    /**
+     * @brief Constructs a number JSON value holding 64 bits floating point values
+     *
+     * @param v value, must not be infinity or NaN
+     * @param p Position in stream
+     * @throws BadValueException if v is not finite
+     */
+    Snapshot(double v, Position p = {}) : m_node() {
+        if (!std::isfinite(v)) {
+            throw BadValueException();
+        }
+        m_node = make_node(Double, v, p);
+    }
+    /**
+     * @brief Constructs a string JSON value
+     *
+     * @param v value, must be UTF-8 encoded
+     * @param p Position in stream
+     */
+    Snapshot(const std::string &v, Position p = {}) : m_node(make_node(String, v, p)) {}
+    /**
+     * @brief Constructs a string JSON value
+     *
+     * @param v value, must be UTF-8 encoded
+     * @param p Position in stream
+     */
+    Snapshot(std::string &&v, Position p = {}) : m_node(make_node(String, std::move(v), p)) {}
+    /**
+     * @brief Constructs a NULL or string JSON value
+     *
+     * If v is not null, then v must be UTF-8 encoded
+     *
+     * @param v if v is null, construct a NULL JSON value. Otherwise construct a string
+     * @param p Position in stream
+     */
+    Snapshot(const char *v, Position p = {}) :
+        m_node(v == nullptr ? make_node(Null, std::any(), p) : make_node(String, std::string(v), p)) {}
+    /**
+     * @brief Constructs an object JSON value
+     *
+     * @param v members, they must be sorted by key and the keys must be unique
+     * @param p Position in stream
+     */
+    Snapshot(ObjectSnapshots v, Position p = {}) : m_node(make_node(Object, std::move(v), p)) {}
+    /**
+     * @brief Constructs an array JSON value
+     *
+     * @param v value
+     * @param p Position in stream
+     */
+    Snapshot(ArraySnapshots v, Position p = {}) : m_node(make_node(Array, std::move(v), p)) {}
+
+    /**
+     * @brief Build an immutable copy of a Value
+     *
+     * This is a deep copy, done once. The positions are preserved.
+     *
+     * @param v JSON value
+     */
+    explicit Snapshot(const Value &v) : Snapshot(v, nullptr) {}
+    /**
+     * @brief Build an immutable copy of a Value, interning its keys
+     *
+     * @param v JSON value
+     * @param keys table used to intern the object keys
+     */
+    Snapshot(const Value &v, KeyTable &keys) : Snapshot(v, &keys) {}
+    /**
+     * @brief Build an immutable copy of a Value, emptying its containers
+     *
+     * @param v JSON value, left in a valid but unspecified state
+     */
+    explicit Snapshot(Value &&v);
+
+    /**
+     * @brief Copy constructor, O(1)
+     *
+     * @param o JSON value
+     */
+    Snapshot(const Snapshot &o) = default;
+    /**
+     * @brief Move constructor
+     *
+     * @param o JSON value, null after the call
+     */
+    Snapshot(Snapshot &&o) noexcept = default;
+    /**
+     * @brief Assignment operator, O(1)
+     *
+     * @param o JSON value
+     * @return reference to this
+     */
+    Snapshot & operator=(const Snapshot &o) = default;
+    /**
+     * @brief Move assignment operator
+     *
+     * @param o JSON value, null after the call
+     * @return reference to this
+     */
+    Snapshot & operator=(Snapshot &&o) noexcept = default;
+
+    /**
+     * @brief Returns an empty JSON object value
+     *
+     * @return JSON value
+     */
+    static Snapshot new_object() {
+        return Snapshot(ObjectSnapshots{});
+    }
+    /**
+     * @brief Returns an empty JSON array value
+     *
+     * @return JSON value
+     */
+    static Snapshot new_array() {
+        return Snapshot(ArraySnapshots{});
+    }
+
+    /**
+     * @brief Returns the type of the value
+     *
+     * @return type
+     */
+    Type get_type() const noexcept {
+        return m_node ? m_node->m_type : Null;
+    }
+
+    /**
+     * @brief Returns the position at which the value was parsed
+     *
+     * @return Position
+     */
+    Position get_position() const noexcept {
+        return m_node ? m_node->m_position : Position();
+    }
+
+    /**
+     * @brief Get a const reference on the object content
+     *
+     * The template argument must be equal to the type returned by get_type().
+     *
+     * @tparam dt Must be equal to the data type of the object
+     * @return the value's content
+     * @throws throws std::bad_any_cast if the template argument does not match the actual data type
+     */
+    template<Type dt> const typename SnapshotTypeToNative<dt>::type & get() const {
+        typedef typename SnapshotTypeToNative<dt>::type T;
+        if (!m_node) {
+            throw std::bad_any_cast();
+        }
+        return std::any_cast<const T &>(m_node->m_value);
+    }
+
+    /**
+     * @brief Get a const pointer to the object content
+     *
+     * Unlike the get() method, get_ptr() does not throw an exception if the type is invalid.
+     *
+     * @tparam dt Must be equal to the data type of the object
+     * @return a pointer to the value's content, or nullptr
+     */
+    template<Type dt> const typename SnapshotTypeToNative<dt>::type * get_ptr() const noexcept {
+        typedef typename SnapshotTypeToNative<dt>::type T;
+        return m_node ? std::any_cast<const T>(&m_node->m_value) : nullptr;
+    }
+
+    /**
+     * @brief Assume the value is of type Object and access a value by its key.
+     *
+     * @param key The key to retrieve
+     * @return Snapshot
+     * @throws std::out_of_range if the key is not defined
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    const Snapshot & operator[](std::string_view key) const;
+
+    /**
+     * @brief Assume the value is of type Object and access a value by its key.
+     *
+     * For small objects, the lookup only compares the precomputed hashes of the keys
+     * until a candidate is found.
+     *
+     * @param key The key to retrieve
+     * @return Snapshot
+     * @throws std::out_of_range if the key is not defined
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    const Snapshot & operator[](const Key &key) const;
+
+    /**
+     * @brief Assume the value is of type Array and access a value by its index.
+     *
+     * @param index The index to retrieve
+     * @return Snapshot
+     * @throws std::out_of_range if the index is out of bounds
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    const Snapshot & operator[](size_t index) const {
+        return get<Type::Array>().at(index);
+    }
+
+    /**
+     * @brief Assume the value is of type Object and test whether a key is defined
+     *
+     * @param key The key to test
+     * @return true if the key is defined
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    bool contains(std::string_view key) const;
+
+    /**
+     * @brief Find a member by its key, with a single lookup
+     *
+     * Unlike operator[], find() does not throw an exception if this value is not an Object.
+     *
+     * @param key The key to retrieve
+     * @return a pointer to the member, or nullptr if this value is not an Object or if the key is not defined
+     */
+    const Snapshot * find(std::string_view key) const noexcept;
+
+    /**
+     * @brief Find a member by its key, with a single lookup
+     *
+     * Unlike operator[], find() does not throw an exception if this value is not an Object.
+     *
+     * @param key The key to retrieve
+     * @return a pointer to the member, or nullptr if this value is not an Object or if the key is not defined
+     */
+    const Snapshot * find(const Key &key) const noexcept;
+
+    /**
+     * @brief Get a const pointer to the content of a member
+     *
+     * This method never throws an exception.
+     *
+     * @tparam dt Expected data type of the member
+     * @param key The key to retrieve
+     * @return a pointer to the member's content, or nullptr if this value is not an Object,
+     *         if the key is not defined or if the member is not of type dt
+     */
+    template<Type dt> const typename SnapshotTypeToNative<dt>::type * get_ptr(std::string_view key) const noexcept {
+        const Snapshot *s = find(key);
+        return s != nullptr ? s->get_ptr<dt>() : nullptr;
+    }
+
+    /**
+     * @brief Get a copy of the content of a member, or a default value
+     *
+     * This method does not throw an exception, unless copying the content does.
+     *
+     * @tparam dt Expected data type of the member
+     * @param key The key to retrieve
+     * @param def Value returned if this value is not an Object, if the key is not defined or if
+     *            the member is not of type dt
+     * @return the member's content or def
+     */
+    template<Type dt> typename SnapshotTypeToNative<dt>::type get_or(std::string_view key, typename SnapshotTypeToNative<dt>::type def) const {
+        const typename SnapshotTypeToNative<dt>::type *p = get_ptr<dt>(key);
+        return p != nullptr ? *p : def;
+    }
+
+    /**
+     * @brief Assume the value is either an array, an object or a string and return its size
+     *
+     * @return size of the string or number of elements of the array/object
+     * @throws std::bad_any_cast if this value is neither an array, an object or a string
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns a copy of this Snapshot where the member key is set to v
+     *
+     * The member is added if it does not exist yet. The other members are shared.
+     *
+     * @param key key
+     * @param v new value
+     * @return new JSON value
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    Snapshot set(std::string_view key, Snapshot v) const;
+
+    /**
+     * @brief Returns a copy of this Snapshot where the member key is set to v
+     *
+     * @param key key, possibly interned
+     * @param v new value
+     * @return new JSON value
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    Snapshot set(const Key &key, Snapshot v) const;
+
+    /**
+     * @brief Returns a copy of this Snapshot without the member key
+     *
+     * @param key key
+     * @return new JSON value, sharing this node if the key is not defined
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    Snapshot erase(std::string_view key) const;
+
+    /**
+     * @brief Returns a copy of this Snapshot where the element at index is set to v
+     *
+     * @param index index
+     * @param v new value
+     * @return new JSON value
+     * @throws std::out_of_range if the index is out of bounds
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    Snapshot set(size_t index, Snapshot v) const;
+
+    /**
+     * @brief Returns a copy of this Snapshot where v is inserted before index
+     *
+     * @param index index, may be equal to size()
+     * @param v new value
+     * @return new JSON value
+     * @throws std::out_of_range if the index is out of bounds
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    Snapshot insert(size_t index, Snapshot v) const;
+
+    /**
+     * @brief Returns a copy of this Snapshot where v is appended
+     *
+     * @param v new value
+     * @return new JSON value
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    Snapshot push_back(Snapshot v) const;
+
+    /**
+     * @brief Returns a copy of this Snapshot without the element at index
+     *
+     * @param index index
+     * @return new JSON value
+     * @throws std::out_of_range if the index is out of bounds
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    Snapshot erase(size_t index) const;
+
+    /**
+     * @brief Test whether two Snapshots share the same node
+     *
+     * @param o other value
+     * @return true if both handles refer to the same node
+     */
+    bool is_same(const Snapshot &o) const noexcept {
+        return m_node == o.m_node;
+    }
+
+    /**
+     * @brief Returns a hash of this value, consistent with operator==
+     *
+     * Same value as Value::hash(), but computed once when the node is built, so this call is O(1).
+     *
+     * @return hash
+     */
+    size_t hash() const noexcept {
+        return m_node ? m_node->m_hash : hash_scalar(Null, std::any());
+    }
+
+    /**
+     * @brief equal operator
+     *
+     * Same semantic as Value::operator==(). The comparison is O(1) for shared subtrees
+     * and for values having different hashes or sizes.
+     *
+     * @param o other value
+     * @return true if the values are identical
+     */
+    bool operator==(const Snapshot &o) const;
+
+    /**
+     * @brief != operator
+     *
+     * @param o other value
+     * @return true if the values are different
+     */
+    bool operator!=(const Snapshot &o) const {
+        return !operator==(o);
+    }
+
+    /**
+     * @brief Build a mutable deep copy of this document
+     *
+     * @return JSON value
+     */
+    Value to_value() const;
+
+    /**
+     * @brief Return a compact string representation of this document
+     *
+     * @return Document
+     */
+    std::string to_string() const {
+        return to_value().to_string();
+    }
+
+    /**
+     * @brief Return an indented string representation of this document
+     *
+     * @param indent indentation width
+     * @return Document
+     */
+    std::string to_string(int indent) const {
+        return to_value().to_string(indent);
+    }
+
+private:
+    /**
+     * @brief An immutable node
+     */
+    struct Node {
+        Type m_type;            ///< data type of this value
+        std::any m_value;       ///< Actual value, whose type is SnapshotTypeToNative<m_type>::type
+        Position m_position;    ///< Position in the input stream at which the value was parsed
+        size_t m_hash;          ///< hash of the value, computed from the hashes of the children
+
+        Node(Type t, std::any &&v, Position p) : m_type(t), m_value(std::move(v)), m_position(p), m_hash(compute_hash(t, m_value)) {}
+        /**
+         * @brief Destructor, the nested nodes are released without recursion
+         */
+        ~Node() {
+            if (m_type & MASK_TYPE_IS_CONTAINER) {
+                release_children(*this);
+            }
+        }
+    };
+
+    std::shared_ptr<const Node> m_node;     ///< shared node, nullptr for a null value without position
+
+    /**
+     * @brief Allocate a new node
+     *
+     * @param t data type
+     * @param v content, whose type is SnapshotTypeToNative<t>::type
+     * @param p Position
+     * @return node
+     */
+    static std::shared_ptr<const Node> make_node(Type t, std::any v, Position p) {
+        // the node is not const itself, so that release_children() may empty it
+        return std::make_shared<Node>(t, std::move(v), p);
+    }
+
+    /**
+     * @brief Release the nested nodes of a container node without recursion
+     *
+     * The children which are only referenced by this node and are non-empty containers are
+     * moved to a work list and emptied one by one. The nodes shared with other documents
+     * are only dereferenced.
+     *
+     * @param n node being destroyed
+     */
+    static void release_children(Node &n) noexcept;
+
+    /**
+     * @brief Move the children of a node which would be destroyed with it to a work list
+     *
+     * @param n container node
+     * @param pending work list
+     */
+    static void detach_children(Node &n, std::vector<std::shared_ptr<const Node>> &pending);
+
+    /**
+     * @brief Compute the hash of a node content
+     *
+     * @param t data type
+     * @param v content, whose type is SnapshotTypeToNative<t>::type
+     * @return hash
+     */
+    static size_t compute_hash(Type t, const std::any &v);
+
+    /**
+     * @brief Hash a scalar node content, consistently with Value::hash()
+     *
+     * @param t data type, must not be Object nor Array
+     * @param v content, whose type is SnapshotTypeToNative<t>::type
+     * @return hash
+     */
+    static size_t hash_scalar(Type t, const std::any &v);
+
+    /**
+     * @brief Build a Value from a scalar Snapshot, used to compare numbers
+     *
+     * @param s scalar
+     * @return Value
+     */
+    static Value scalar_to_value(const Snapshot &s);
+
+    /**
+     * @brief Find a member of an object by its key
+     *
+     * @param members members of an object
+     * @param key key
+     * @return iterator to the member or to the position where it would be inserted
+     */
+    static ObjectSnapshots::const_iterator lower_bound(const ObjectSnapshots &members, std::string_view key);
+
+    /**
+     * @brief Find a member of an object by its key
+     *
+     * @param members members of an object
+     * @param key key
+     * @return iterator to the member or end()
+     */
+    static ObjectSnapshots::const_iterator find_member(const ObjectSnapshots &members, const Key &key);
+
+    /**
+     * @brief Build an immutable copy of a Value
+     *
+     * @param v JSON value
+     * @param keys optional table used to intern the object keys
+     */
+    Snapshot(const Value &v, KeyTable *keys);
+
+    friend class Interner;
+};
+
+}
+
+namespace std {
+
+/**
+ * @brief Specialization of std::hash for MiniJSON::Snapshot, see Snapshot::hash()
+ */
+template<> struct hash<MiniJSON::Snapshot> {
+    /**
+     * @brief Hash a value
+     *
+     * @param v value
+     * @return hash
+     */
+    size_t operator()(const MiniJSON::Snapshot &v) const noexcept {
+        return v.hash();
+    }
+};
+
+}
+
+#include <mini_json/mini_json_snapshot_impl.h>
+
+#endif /* HB64C9263_5333_448A_8162_D4D562FB7E96 */
@@ -0,0 +1,434 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HECC9AEDB_1F1A_44D2_88BB_DE290627463C
+#define HECC9AEDB_1F1A_44D2_88BB_DE290627463C
+
+#include <algorithm>
+#include <stdexcept>
+#include <mini_json/mini_json_snapshot.h>
+#include <mini_json/mini_json_value.h>
+
+namespace MiniJSON {
+
+inline Snapshot::Snapshot(const Value &v, KeyTable *keys) : m_node() {
+    const Position p = v.get_position();
+    switch (v.get_type()) {
+    case Type::Null:
+        m_node = make_node(Null, std::any(), p);
+        break;
+    case Type::Boolean:
+        m_node = make_node(Boolean, v.get<Type::Boolean>(), p);
+        break;
+    case Type::UInt64:
+        m_node = make_node(UInt64, v.get<Type::UInt64>(), p);
+        break;
+    case Type::Int64:
+        m_node = make_node(Int64, v.get<Type::Int64>(), p);
+        break;
+    case Type::Double:
+        m_node = make_node(Double, v.get<Type::Double>(), p);
+        break;
+    case Type::String:
+        // the nodes hold a std::string, without the resource of the value
+        m_node = make_node(String, std::string(v.get<Type::String>()), p);
+        break;
+    case Type::Object:
+    {
+        // ObjectValues is already sorted, with unique keys
+        const auto &map = v.get<Type::Object>();
+        ObjectSnapshots members;
+        members.reserve(map.size());
+        for (const auto &m : map) {
+            members.emplace_back(keys ? keys->intern(m.first) : Key(m.first), Snapshot(m.second, keys));
+        }
+        m_node = make_node(Object, std::move(members), p);
+        break;
+    }
+    case Type::Array:
+    {
+        const auto &list = v.get<Type::Array>();
+        ArraySnapshots elements;
+        elements.reserve(list.size());
+        for (const auto &e : list) {
+            elements.push_back(Snapshot(e, keys));
+        }
+        m_node = make_node(Array, std::move(elements), p);
+        break;
+    }
+    }
+}
+
+inline Snapshot::Snapshot(Value &&v) : m_node() {
+    const Position p = v.get_position();
+    switch (v.get_type()) {
+    case Type::Object:
+    {
+        auto &map = v.get<Type::Object>();
+        ObjectSnapshots members;
+        members.reserve(map.size());
+        // the keys are copied, they are allocated from the resource of the map
+        for (auto &m : map) {
+            members.emplace_back(Key(m.first), Snapshot(std::move(m.second)));
+        }
+        map.clear();
+        m_node = make_node(Object, std::move(members), p);
+        break;
+    }
+    case Type::Array:
+    {
+        auto &list = v.get<Type::Array>();
+        ArraySnapshots elements;
+        elements.reserve(list.size());
+        for (auto &e : list) {
+            elements.emplace_back(std::move(e));
+        }
+        list.clear();
+        m_node = make_node(Array, std::move(elements), p);
+        break;
+    }
+    default:
+        *this = Snapshot(static_cast<const Value &>(v));
+        break;
+    }
+}
+
+inline ObjectSnapshots::const_iterator Snapshot::lower_bound(const ObjectSnapshots &members, std::string_view key) {
+    return std::lower_bound(members.begin(), members.end(), key,
+        [](const ObjectSnapshots::value_type &m, std::string_view k) { return m.first.view() < k; });
+}
+
+inline ObjectSnapshots::const_iterator Snapshot::find_member(const ObjectSnapshots &members, const Key &key) {
+    // below this size, a linear scan on the precomputed hashes beats the binary search
+    static constexpr size_t LINEAR_SEARCH_MAX = 8;
+    if (members.size() <= LINEAR_SEARCH_MAX) {
+        for (auto it = members.begin(); it != members.end(); ++it) {
+            if (it->first == key) {
+                return it;
+            }
+        }
+        return members.end();
+    }
+    auto it = lower_bound(members, key.view());
+    if (it == members.end() || it->first != key) {
+        return members.end();
+    }
+    return it;
+}
+
+inline const Snapshot & Snapshot::operator[](std::string_view key) const {
+    const auto &members = get<Type::Object>();
+    auto it = lower_bound(members, key);
+    if (it == members.end() || it->first.view() != key) {
+        throw std::out_of_range("Snapshot::operator[]");
+    }
+    return it->second;
+}
+
+inline const Snapshot & Snapshot::operator[](const Key &key) const {
+    const auto &members = get<Type::Object>();
+    auto it = find_member(members, key);
+    if (it == members.end()) {
+        throw std::out_of_range("Snapshot::operator[]");
+    }
+    return it->second;
+}
+
+inline bool Snapshot::contains(std::string_view key) const {
+    const auto &members = get<Type::Object>();
+    auto it = lower_bound(members, key);
+    return it != members.end() && it->first.view() == key;
+}
+
+inline const Snapshot * Snapshot::find(std::string_view key) const noexcept {
+    const ObjectSnapshots *members = get_ptr<Type::Object>();
+    if (members == nullptr) {
+        return nullptr;
+    }
+    auto it = lower_bound(*members, key);
+    return it != members->end() && it->first.view() == key ? &it->second : nullptr;
+}
+
+inline const Snapshot * Snapshot::find(const Key &key) const noexcept {
+    const ObjectSnapshots *members = get_ptr<Type::Object>();
+    if (members == nullptr) {
+        return nullptr;
+    }
+    auto it = find_member(*members, key);
+    return it != members->end() ? &it->second : nullptr;
+}
+
+inline size_t Snapshot::size() const {
+    switch (get_type()) {
+        case Type::Array:
+            return get<Type::Array>().size();
+        case Type::Object:
+            return get<Type::Object>().size();
+        case Type::String:
+            return get<Type::String>().size();
+        default:
+            throw std::bad_any_cast();
+    }
+}
+
+inline Snapshot Snapshot::set(std::string_view key, Snapshot v) const {
+    const auto &members = get<Type::Object>();
+    auto pos = lower_bound(members, key);
+    if (pos != members.end() && pos->first.view() == key) {
+        // keep the existing, possibly interned, key
+        return set(pos->first, std::move(v));
+    }
+    return set(Key(key), std::move(v));
+}
+
+inline Snapshot Snapshot::set(const Key &key, Snapshot v) const {
+    const auto &members = get<Type::Object>();
+    auto pos = lower_bound(members, key.view());
+    // copy the handles of the members, the subtrees are shared
+    ObjectSnapshots copy;
+    copy.reserve(members.size() + 1);
+    copy.insert(copy.end(), members.begin(), pos);
+    copy.emplace_back(key, std::move(v));
+    if (pos != members.end() && pos->first == key) {
+        ++pos;
+    }
+    copy.insert(copy.end(), pos, members.end());
+    return Snapshot(std::move(copy), get_position());
+}
+
+inline Snapshot Snapshot::erase(std::string_view key) const {
+    const auto &members = get<Type::Object>();
+    auto pos = lower_bound(members, key);
+    if (pos == members.end() || pos->first.view() != key) {
+        return *this;
+    }
+    ObjectSnapshots copy;
+    copy.reserve(members.size() - 1);
+    copy.insert(copy.end(), members.begin(), pos);
+    copy.insert(copy.end(), std::next(pos), members.end());
+    return Snapshot(std::move(copy), get_position());
+}
+
+inline Snapshot Snapshot::set(size_t index, Snapshot v) const {
+    const auto &elements = get<Type::Array>();
+    if (index >= elements.size()) {
+        throw std::out_of_range("Snapshot::set");
+    }
+    ArraySnapshots copy(elements);
+    copy[index] = std::move(v);
+    return Snapshot(std::move(copy), get_position());
+}
+
+inline Snapshot Snapshot::insert(size_t index, Snapshot v) const {
+    const auto &elements = get<Type::Array>();
+    if (index > elements.size()) {
+        throw std::out_of_range("Snapshot::insert");
+    }
+    ArraySnapshots copy;
+    copy.reserve(elements.size() + 1);
+    copy.insert(copy.end(), elements.begin(), elements.begin() + index);
+    copy.push_back(std::move(v));
+    copy.insert(copy.end(), elements.begin() + index, elements.end());
+    return Snapshot(std::move(copy), get_position());
+}
+
+inline Snapshot Snapshot::push_back(Snapshot v) const {
+    return insert(get<Type::Array>().size(), std::move(v));
+}
+
+inline Snapshot Snapshot::erase(size_t index) const {
+    const auto &elements = get<Type::Array>();
+    if (index >= elements.size()) {
+        throw std::out_of_range("Snapshot::erase");
+    }
+    ArraySnapshots copy;
+    copy.reserve(elements.size() - 1);
+    copy.insert(copy.end(), elements.begin(), elements.begin() + index);
+    copy.insert(copy.end(), elements.begin() + index + 1, elements.end());
+    return Snapshot(std::move(copy), get_position());
+}
+
+inline void Snapshot::detach_children(Node &n, std::vector<std::shared_ptr<const Node>> &pending) {
+    // use_count() == 1: this node holds the only reference, no other thread can acquire one
+    const auto detach = [&pending](Snapshot &c) {
+        if (c.m_node && c.m_node.use_count() == 1 && (c.m_node->m_type & MASK_TYPE_IS_CONTAINER)) {
+            pending.push_back(std::move(c.m_node));
+        }
+    };
+    if (n.m_type == Object) {
+        for (auto &m : *std::any_cast<ObjectSnapshots>(&n.m_value)) {
+            detach(m.second);
+        }
+    }
+    else {
+        for (auto &e : *std::any_cast<ArraySnapshots>(&n.m_value)) {
+            detach(e);
+        }
+    }
+}
+
+inline void Snapshot::release_children(Node &n) noexcept {
+    std::vector<std::shared_ptr<const Node>> pending;
+    try {
+        detach_children(n, pending);
+        while (!pending.empty()) {
+            std::shared_ptr<const Node> child = std::move(pending.back());
+            pending.pop_back();
+            // the nodes are allocated non-const by make_node()
+            detach_children(const_cast<Node &>(*child), pending);
+            // child is destroyed here, its remaining children are scalars or shared nodes
+        }
+    }
+    catch (...) {
+        // out of memory for the work list: the remaining nodes are destroyed recursively
+    }
+}
+
+inline size_t Snapshot::compute_hash(Type t, const std::any &v) {
+    // same combination as Value::hash()
+    static constexpr uint64_t HASH_OBJECT = 0x6F626A65ULL;
+    static constexpr uint64_t HASH_ARRAY = 0x61727261ULL;
+
+    switch (t) {
+    case Type::Object:
+    {
+        size_t h = Value::hash_mix(HASH_OBJECT);
+        for (const auto &m : std::any_cast<const ObjectSnapshots &>(v)) {
+            h = Value::hash_combine(h, m.first.hash());
+            h = Value::hash_combine(h, m.second.hash());
+        }
+        return h;
+    }
+    case Type::Array:
+    {
+        size_t h = Value::hash_mix(HASH_ARRAY);
+        for (const auto &e : std::any_cast<const ArraySnapshots &>(v)) {
+            h = Value::hash_combine(h, e.hash());
+        }
+        return h;
+    }
+    default:
+        return hash_scalar(t, v);
+    }
+}
+
+inline size_t Snapshot::hash_scalar(Type t, const std::any &v) {
+    // the argument only selects the native type
+    return Value::hash_scalar_content(t, [&v](const auto *type) {
+        using T = std::remove_const_t<std::remove_pointer_t<decltype(type)>>;
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return std::any_cast<std::string>(&v);
+        }
+        else {
+            return std::any_cast<T>(&v);
+        }
+    });
+}
+
+inline Value Snapshot::scalar_to_value(const Snapshot &s) {
+    switch (s.get_type()) {
+    case Type::Boolean:
+        return Value(s.get<Type::Boolean>());
+    case Type::UInt64:
+        return Value(s.get<Type::UInt64>());
+    case Type::Int64:
+        return Value(s.get<Type::Int64>());
+    case Type::Double:
+        return Value(s.get<Type::Double>());
+    default:
+        return Value();
+    }
+}
+
+inline bool Snapshot::operator==(const Snapshot &o) const {
+    if (m_node == o.m_node) {
+        return true;
+    }
+    if (hash() != o.hash()) {
+        return false;
+    }
+    const Type t = get_type();
+    const Type ot = o.get_type();
+    if (t != ot) {
+        // if the types are both numerics but different, let Value do the "deep" comparison
+        if ((t & MASK_TYPE_IS_NUMERIC) && (ot & MASK_TYPE_IS_NUMERIC)) {
+            return scalar_to_value(*this) == scalar_to_value(o);
+        }
+        return false;
+    }
+    switch (t) {
+    case Type::Null:
+        return true;
+    case Type::Boolean:
+        return get<Type::Boolean>() == o.get<Type::Boolean>();
+    case Type::UInt64:
+        return get<Type::UInt64>() == o.get<Type::UInt64>();
+    case Type::Int64:
+        return get<Type::Int64>() == o.get<Type::Int64>();
+    case Type::Double:
+        return get<Type::Double>() == o.get<Type::Double>();
+    case Type::String:
+        return get<Type::String>() == o.get<Type::String>();
+    case Type::Object:
+        return get<Type::Object>() == o.get<Type::Object>();
+    case Type::Array:
+        return get<Type::Array>() == o.get<Type::Array>();
+    }
+    return false;
+}
+
+inline Value Snapshot::to_value() const {
+    switch (get_type()) {
+    case Type::Null:
+        return Value(get_position());
+    case Type::Boolean:
+        return Value(get<Type::Boolean>(), get_position());
+    case Type::UInt64:
+        return Value(get<Type::UInt64>(), get_position());
+    case Type::Int64:
+        return Value(get<Type::Int64>(), get_position());
+    case Type::Double:
+        return Value(get<Type::Double>(), get_position());
+    case Type::String:
+        return Value(get<Type::String>(), get_position());
+    case Type::Object:
+    {
+        Value ret = Value::new_object();
+        ret.set_position(get_position());
+        auto &map = ret.get<Type::Object>();
+        for (const auto &m : get<Type::Object>()) {
+            // members are sorted, append at the end of the map
+            map.emplace_hint(map.end(), m.first.str(), m.second.to_value());
+        }
+        return ret;
+    }
+    case Type::Array:
+    {
+        Value ret = Value::new_array();
+        ret.set_position(get_position());
+        auto &list = ret.get<Type::Array>();
+        for (const auto &e : get<Type::Array>()) {
+            list.push_back(e.to_value());
+        }
+        return ret;
+    }
+    }
+    throw std::exception();
+}
+
+}
+
+#endif /* HECC9AEDB_1F1A_44D2_88BB_DE290627463C */
@@ -0,0 +1,505 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC211BA27_06F8_4DAE_8A87_A0F73C5F2FFB
+#define HC211BA27_06F8_4DAE_8A87_A0F73C5F2FFB
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <optional>
+#include <string_view>
+#include <stdexcept>
+#include <any>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_parser.h>
+
+/**
+ * @brief Declare a document parsed at compile time
+ *
+ * The macro declares a constexpr MiniJSON::StaticDocument named name, sized for the document.
+ * A syntax error in the document is a compilation error. Inside a function, prefix the macro
+ * with static so that the document lives in the read-only data:
+ * @code
+ * static MINI_JSON_STATIC_DOCUMENT(defaults, R"({"port": 8080, "hosts": ["a", "b"]})");
+ * constexpr uint64_t port = defaults.root()["port"].get<MiniJSON::Type::UInt64>();
+ * @endcode
+ *
+ * @param name name of the variable
+ * @param text string literal, UTF-8 encoded
+ */
+#define MINI_JSON_STATIC_DOCUMENT(name, text) \
+    constexpr ::MiniJSON::StaticDocument< \
+        ::MiniJSON::StaticParser::measure(text).m_nodes, \
+        ::MiniJSON::StaticParser::measure(text).m_bytes> name{std::string_view(text)}
+
+namespace MiniJSON {
+
+/**
+ * @brief A node of the tape of a StaticDocument
+ *
+ * The nodes are stored in document order: the children of a container follow it and
+ * m_end gives the index following its subtree, that is the index of its next sibling.
+ */
+struct StaticNode {
+    Type m_type = Type::Null;   ///< data type
+    size_t m_end = 0;           ///< index of the node following the subtree
+    size_t m_size = 0;          ///< number of elements or members
+    size_t m_key = 0;           ///< offset of the key of a member in the strings
+    size_t m_key_length = 0;    ///< length of the key of a member
+    size_t m_text = 0;          ///< offset of a string in the strings
+    size_t m_text_length = 0;   ///< length of a string
+    bool m_boolean = false;     ///< Boolean content
+    uint64_t m_uint64 = 0;      ///< UInt64 content
+    int64_t m_int64 = 0;        ///< Int64 content
+    double m_double = 0.0;      ///< Double content
+};
+
+/**
+ * @brief Native type returned by StaticValue::get()
+ *
+ * @tparam dt data type
+ */
+template<Type dt> struct StaticTypeToNative {};
+/**
+ * @brief Specialization of StaticTypeToNative for Boolean
+ */
+template<> struct StaticTypeToNative<Type::Boolean> { typedef bool type; /*!< Boolean data type */};
+/**
+ * @brief Specialization of StaticTypeToNative for UInt64
+ */
+template<> struct StaticTypeToNative<Type::UInt64>  { typedef uint64_t type; /*!< unsigned 64 bits number data type */};
+/**
+ * @brief Specialization of StaticTypeToNative for Int64
+ */
+template<> struct StaticTypeToNative<Type::Int64>   { typedef int64_t type; /*!< signed 64 bits number data type */};
+/**
+ * @brief Specialization of StaticTypeToNative for Double
+ */
+template<> struct StaticTypeToNative<Type::Double>  { typedef double type; /*!< 64 bits floating point number data type */};
+/**
+ * @brief Specialization of StaticTypeToNative for String, a view on the read-only strings
+ */
+template<> struct StaticTypeToNative<Type::String>  { typedef std::string_view type; /*!< string data type */};
+
+/**
+ * @brief A read-only view on a value of a StaticDocument
+ *
+ * The accessors follow the ones of Value and are constexpr. The strings are returned as
+ * std::string_view and the containers are browsed with operator[], find() or the iterators.
+ * A StaticValue is a pair of pointers and an index, it is meant to be passed by value.
+ */
+class StaticValue {
+public:
+    /**
+     * @brief Iterator on the elements of an array or the members of an object
+     */
+    class const_iterator {
+    public:
+        /**
+         * @brief Build an iterator
+         *
+         * @param nodes tape
+         * @param strings strings of the document
+         * @param index index of the current node
+         */
+        constexpr const_iterator(const StaticNode *nodes, const char *strings, size_t index) :
+            m_nodes(nodes), m_strings(strings), m_index(index) {}
+        /**
+         * @brief Returns the current element or member, see StaticValue::key()
+         */
+        constexpr StaticValue operator*() const {
+            return StaticValue(m_nodes, m_strings, m_index);
+        }
+        /**
+         * @brief Move to the next sibling
+         */
+        constexpr const_iterator & operator++() {
+            m_index = m_nodes[m_index].m_end;
+            return *this;
+        }
+        /**
+         * @brief equal operator
+         */
+        constexpr bool operator==(const const_iterator &o) const {
+            return m_index == o.m_index;
+        }
+        /**
+         * @brief != operator
+         */
+        constexpr bool operator!=(const const_iterator &o) const {
+            return m_index != o.m_index;
+        }
+    private:
+        const StaticNode *m_nodes;  ///< tape
+        const char *m_strings;      ///< strings of the document
+        size_t m_index;             ///< current node
+    };
+
+    /**
+     * @brief Build a view on a node
+     *
+     * @param nodes tape
+     * @param strings strings of the document
+     * @param index index of the node
+     */
+    constexpr StaticValue(const StaticNode *nodes, const char *strings, size_t index) :
+        m_nodes(nodes), m_strings(strings), m_index(index) {}
+
+    /**
+     * @brief Returns the type of the value
+     *
+     * @return type
+     */
+    constexpr Type get_type() const {
+        return node().m_type;
+    }
+
+    /**
+     * @brief Get the content of a scalar
+     *
+     * @tparam dt Must be equal to the data type of the value (Boolean, UInt64, Int64, Double or String)
+     * @return the value's content
+     * @throws std::bad_any_cast if the template argument does not match the actual data type
+     */
+    template<Type dt> constexpr typename StaticTypeToNative<dt>::type get() const;
+
+    /**
+     * @brief Returns the number of elements of an array or members of an object
+     *
+     * @return size, 0 for a scalar
+     */
+    constexpr size_t size() const {
+        return node().m_size;
+    }
+
+    /**
+     * @brief Returns the key of a member of an object
+     *
+     * @return key, empty if the value is not a member
+     */
+    constexpr std::string_view key() const {
+        return std::string_view(m_strings + node().m_key, node().m_key_length);
+    }
+
+    /**
+     * @brief Find a member by its key
+     *
+     * If the key is repeated, the last occurrence is returned, as Parser keeps the last one.
+     *
+     * @param key key
+     * @return the member or an empty optional if the key is absent or the value is not an Object
+     */
+    constexpr std::optional<StaticValue> find(std::string_view key) const;
+
+    /**
+     * @brief Test whether an object has a member
+     *
+     * @param key key
+     * @return true if this is an object with this key
+     */
+    constexpr bool contains(std::string_view key) const {
+        return find(key).has_value();
+    }
+
+    /**
+     * @brief Access a member of an object
+     *
+     * @param key key
+     * @return the member
+     * @throws std::out_of_range if this is not an object or the key is absent
+     */
+    constexpr StaticValue operator[](std::string_view key) const;
+
+    /**
+     * @brief Access an element of an array
+     *
+     * @param index index
+     * @return the element
+     * @throws std::out_of_range if this is not an array or the index is out of range
+     */
+    constexpr StaticValue operator[](size_t index) const;
+
+    /**
+     * @brief Get the content of a member, or a default value
+     *
+     * @tparam dt Expected data type of the member
+     * @param key key
+     * @param def default value
+     * @return the member's content or def if the member is missing or has another type
+     */
+    template<Type dt> constexpr typename StaticTypeToNative<dt>::type get_or(std::string_view key, typename StaticTypeToNative<dt>::type def) const {
+        const std::optional<StaticValue> m = find(key);
+        return m.has_value() && m->get_type() == dt ? m->get<dt>() : def;
+    }
+
+    /**
+     * @brief Returns an iterator on the first element or member
+     */
+    constexpr const_iterator begin() const {
+        return const_iterator(m_nodes, m_strings, m_index + 1);
+    }
+    /**
+     * @brief Returns an iterator past the last element or member
+     */
+    constexpr const_iterator end() const {
+        return const_iterator(m_nodes, m_strings, node().m_end);
+    }
+
+    /**
+     * @brief Build a Value holding a copy of this value
+     *
+     * @return JSON value
+     */
+    Value to_value() const;
+
+private:
+    const StaticNode *m_nodes;  ///< tape
+    const char *m_strings;      ///< strings of the document
+    size_t m_index;             ///< index of the node
+
+    /**
+     * @brief Returns the node
+     */
+    constexpr const StaticNode & node() const {
+        return m_nodes[m_index];
+    }
+};
+
+/**
+ * @brief A constexpr JSON parser producing a tape of StaticNode
+ *
+ * The parser runs twice on the same text: measure() computes the number of nodes and the
+ * size of the decoded strings, then StaticDocument fills arrays of these sizes.
+ *
+ * The grammar is the one of Parser, with the same distinction between the UInt64, Int64 and
+ * Double numbers and the same error on out of range integers and too large floating point numbers.
+ * The floating point numbers are correctly rounded, as by strtod(), down to the subnormal values and zero. When the significand is at most 2^53 and the decimal
+ * exponent is at most 22 in absolute value, which covers the usual configuration values, the
+ * conversion is a single floating point operation. Otherwise, an approximation is corrected
+ * by exact comparisons with big integers, which is slower to evaluate.
+ *
+ * The syntax errors throw a MalFormedException, and an invalid UTF-8 sequence throws an
+ * UTF8Exception: during a constant evaluation, this is a compilation error.
+ */
+class StaticParser {
+public:
+    /**
+     * @brief Size of a document
+     */
+    struct Size {
+        size_t m_nodes;     ///< number of nodes
+        size_t m_bytes;     ///< size of the decoded keys and strings
+    };
+
+    /**
+     * @brief Measure a document
+     *
+     * @param text document, UTF-8 encoded
+     * @return size of the document
+     * @throws MalFormedException
+     * @throws UTF8Exception
+     */
+    static constexpr Size measure(std::string_view text) {
+        StaticParser p(text);
+        p.parse();
+        return {p.m_node_count, p.m_byte_count};
+    }
+
+    /**
+     * @brief Prepare the measure of a document
+     *
+     * @param text document, UTF-8 encoded
+     */
+    constexpr explicit StaticParser(std::string_view text) :
+        m_text(text), m_pos(0), m_nodes(nullptr), m_strings(nullptr), m_measure(true),
+        m_node_count(0), m_byte_count(0), m_scratch() {}
+
+    /**
+     * @brief Prepare the parsing of a document
+     *
+     * @param text document, UTF-8 encoded
+     * @param nodes output tape, large enough for the document
+     * @param strings output strings, large enough for the document
+     */
+    constexpr StaticParser(std::string_view text, StaticNode *nodes, char *strings) :
+        m_text(text), m_pos(0), m_nodes(nodes), m_strings(strings), m_measure(false),
+        m_node_count(0), m_byte_count(0), m_scratch() {}
+
+    /**
+     * @brief Parse the document
+     *
+     * @throws MalFormedException
+     * @throws UTF8Exception
+     */
+    constexpr void parse();
+
+private:
+    std::string_view m_text;    ///< document
+    size_t m_pos;               ///< current offset
+    StaticNode *m_nodes;        ///< output tape, nullptr when measuring
+    char *m_strings;            ///< output strings, nullptr when measuring
+    bool m_measure;             ///< only measure, the outputs are not written
+    size_t m_node_count;        ///< number of nodes produced
+    size_t m_byte_count;        ///< number of bytes of strings produced
+    StaticNode m_scratch;       ///< written instead of the tape while measuring
+
+    /**
+     * @brief Returns a node of the tape, or the scratch node while measuring
+     */
+    constexpr StaticNode & at(size_t index) {
+        return m_measure ? m_scratch : m_nodes[index];
+    }
+    /**
+     * @brief Append a node to the tape
+     */
+    constexpr size_t new_node(Type t) {
+        at(m_node_count).m_type = t;
+        return m_node_count++;
+    }
+    /**
+     * @brief Append a byte to the strings
+     */
+    constexpr void put(char c) {
+        if (!m_measure) {
+            m_strings[m_byte_count] = c;
+        }
+        ++m_byte_count;
+    }
+
+    /**
+     * @brief Throw a MalFormedException at the current offset
+     */
+    [[noreturn]] void malformed(const char *info) const;
+
+    /**
+     * @brief Skip the JSON whitespaces
+     */
+    constexpr void skip_whitespaces();
+    /**
+     * @brief Test whether the end of the text is reached
+     */
+    constexpr bool eof() const {
+        return m_pos >= m_text.size();
+    }
+    /**
+     * @brief Returns the current character, the end must not be reached
+     */
+    constexpr char peek() const {
+        return m_text[m_pos];
+    }
+    /**
+     * @brief Consume a literal (true, false or null)
+     */
+    constexpr void expect(std::string_view word);
+    /**
+     * @brief Read any value
+     *
+     * @return index of its node
+     */
+    constexpr size_t read_value();
+    /**
+     * @brief Read the members of an object
+     *
+     * @param index index of the object node
+     */
+    constexpr void read_object(size_t index);
+    /**
+     * @brief Read the elements of an array
+     *
+     * @param index index of the array node
+     */
+    constexpr void read_array(size_t index);
+    /**
+     * @brief Read and decode a string into the strings
+     *
+     * @param offset receives the offset of the decoded string
+     * @param length receives the length of the decoded string
+     */
+    constexpr void read_string(size_t &offset, size_t &length);
+    /**
+     * @brief Read the 4 hexadecimal digits of an unicode escape sequence
+     */
+    constexpr uint32_t read_hex4();
+    /**
+     * @brief Append the UTF-8 encoding of a code point to the strings
+     */
+    constexpr void put_codepoint(uint32_t cp);
+    /**
+     * @brief Read a number
+     *
+     * @param index index of the number node
+     */
+    constexpr void read_number(size_t index);
+
+    class BigInt;
+
+    /**
+     * @brief Convert a decimal number to the nearest double
+     *
+     * @param begin offset of the first digit of the number
+     * @param exponent value of the exponent part
+     * @param estimate approximation of the number, within a few units in the last place
+     * @return the nearest double
+     * @throws MalFormedException if the number is out of range
+     */
+    constexpr double nearest_double(size_t begin, int64_t exponent, double estimate) const;
+};
+
+/**
+ * @brief A document parsed at compile time
+ *
+ * Use the MINI_JSON_STATIC_DOCUMENT macro to declare a document: it computes the template
+ * arguments from the text.
+ *
+ * @tparam N number of nodes
+ * @tparam M size of the decoded keys and strings
+ */
+template<size_t N, size_t M>
+class StaticDocument {
+public:
+    /**
+     * @brief Parse a document
+     *
+     * @param text document, UTF-8 encoded, whose size must be (N, M) (see StaticParser::measure())
+     * @throws MalFormedException
+     * @throws UTF8Exception
+     */
+    constexpr explicit StaticDocument(std::string_view text) : m_nodes{}, m_strings{} {
+        StaticParser(text, m_nodes.data(), m_strings.data()).parse();
+    }
+
+    /**
+     * @brief Returns the root value
+     *
+     * @return view on the root value
+     */
+    constexpr StaticValue root() const {
+        return StaticValue(m_nodes.data(), m_strings.data(), 0);
+    }
+
+private:
+    std::array<StaticNode, N> m_nodes;  ///< tape
+    std::array<char, M == 0 ? 1 : M> m_strings;   ///< decoded keys and strings
+};
+
+}
+
+#include <mini_json/mini_json_static_document_impl.h>
+
+#endif /* HC211BA27_06F8_4DAE_8A87_A0F73C5F2FFB */
@@ -0,0 +1,852 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H4C51F8B1_FB45_42B2_B953_B23CED2BD341
+#define H4C51F8B1_FB45_42B2_B953_B23CED2BD341
+
+#include <string>
+#include <stdexcept>
+#include <mini_json/mini_json_static_document.h>
+
+namespace MiniJSON {
+
+template<Type dt> constexpr typename StaticTypeToNative<dt>::type StaticValue::get() const {
+    if (node().m_type != dt) {
+        throw std::bad_any_cast();
+    }
+    if constexpr (dt == Type::Boolean) {
+        return node().m_boolean;
+    }
+    else if constexpr (dt == Type::UInt64) {
+        return node().m_uint64;
+    }
+    else if constexpr (dt == Type::Int64) {
+        return node().m_int64;
+    }
+    else if constexpr (dt == Type::Double) {
+        return node().m_double;
+    }
+    else {
+        return std::string_view(m_strings + node().m_text, node().m_text_length);
+    }
+}
+
+constexpr std::optional<StaticValue> StaticValue::find(std::string_view key) const {
+    if (node().m_type != Type::Object) {
+        return std::nullopt;
+    }
+    // std::optional is not assignable in constant expressions before C++20, keep the index
+    size_t found = 0;
+    for (size_t i = m_index + 1; i < node().m_end; i = m_nodes[i].m_end) {
+        if (StaticValue(m_nodes, m_strings, i).key() == key) {
+            found = i;
+        }
+    }
+    if (found == 0) {
+        return std::nullopt;
+    }
+    return StaticValue(m_nodes, m_strings, found);
+}
+
+constexpr StaticValue StaticValue::operator[](std::string_view key) const {
+    const std::optional<StaticValue> m = find(key);
+    if (!m.has_value()) {
+        throw std::out_of_range("StaticValue::operator[]");
+    }
+    return *m;
+}
+
+constexpr StaticValue StaticValue::operator[](size_t index) const {
+    if (node().m_type != Type::Array || index >= node().m_size) {
+        throw std::out_of_range("StaticValue::operator[]");
+    }
+    const_iterator it = begin();
+    for (size_t i = 0; i < index; ++i) {
+        ++it;
+    }
+    return *it;
+}
+
+inline Value StaticValue::to_value() const {
+    switch (get_type()) {
+    case Type::Null:
+        return Value();
+    case Type::Boolean:
+        return Value(get<Type::Boolean>());
+    case Type::UInt64:
+        return Value(get<Type::UInt64>());
+    case Type::Int64:
+        return Value(get<Type::Int64>());
+    case Type::Double:
+        return Value(get<Type::Double>());
+    case Type::String:
+        return Value(std::string(get<Type::String>()));
+    case Type::Object:
+    {
+        Value ret = Value::new_object();
+        for (StaticValue m : *this) {
+            ret.insert_or_assign(std::string(m.key()), m.to_value());
+        }
+        return ret;
+    }
+    case Type::Array:
+    {
+        Value ret = Value::new_array();
+        for (StaticValue e : *this) {
+            ret.push_back(e.to_value());
+        }
+        return ret;
+    }
+    }
+    return Value();
+}
+
+inline void StaticParser::malformed(const char *info) const {
+    // the position is only computed on errors
+    uint64_t line = 1;
+    uint64_t column = 1;
+    for (size_t i = 0; i < m_pos && i < m_text.size(); ++i) {
+        if (m_text[i] == '\n') {
+            ++line;
+            column = 1;
+        }
+        else {
+            ++column;
+        }
+    }
+    throw MalFormedException(Position(line, column, m_pos), info);
+}
+
+constexpr void StaticParser::parse() {
+    skip_whitespaces();
+    read_value();
+    skip_whitespaces();
+    if (!eof()) {
+        malformed("unexpected characters after the document");
+    }
+}
+
+constexpr void StaticParser::skip_whitespaces() {
+    while (!eof() && (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r')) {
+        ++m_pos;
+    }
+}
+
+constexpr void StaticParser::expect(std::string_view word) {
+    if (m_text.substr(m_pos, word.size()) != word) {
+        malformed("invalid literal");
+    }
+    m_pos += word.size();
+}
+
+constexpr size_t StaticParser::read_value() {
+    if (eof()) {
+        malformed("unexpected end of document");
+    }
+    size_t index = 0;
+    switch (peek()) {
+    case '{':
+        index = new_node(Type::Object);
+        read_object(index);
+        break;
+    case '[':
+        index = new_node(Type::Array);
+        read_array(index);
+        break;
+    case '"':
+    {
+        index = new_node(Type::String);
+        size_t offset = 0;
+        size_t length = 0;
+        read_string(offset, length);
+        at(index).m_text = offset;
+        at(index).m_text_length = length;
+        break;
+    }
+    case 't':
+        expect("true");
+        index = new_node(Type::Boolean);
+        at(index).m_boolean = true;
+        break;
+    case 'f':
+        expect("false");
+        index = new_node(Type::Boolean);
+        at(index).m_boolean = false;
+        break;
+    case 'n':
+        expect("null");
+        index = new_node(Type::Null);
+        break;
+    default:
+        if (peek() == '-' || (peek() >= '0' && peek() <= '9')) {
+            index = new_node(Type::Null);
+            read_number(index);
+            break;
+        }
+        malformed("unexpected character");
+    }
+    at(index).m_end = m_node_count;
+    return index;
+}
+
+constexpr void StaticParser::read_object(size_t index) {
+    ++m_pos;
+    skip_whitespaces();
+    size_t count = 0;
+    if (!eof() && peek() == '}') {
+        ++m_pos;
+        at(index).m_size = 0;
+        return;
+    }
+    while (true) {
+        skip_whitespaces();
+        if (eof() || peek() != '"') {
+            malformed("expected a key");
+        }
+        size_t key = 0;
+        size_t key_length = 0;
+        read_string(key, key_length);
+        skip_whitespaces();
+        if (eof() || peek() != ':') {
+            malformed("expected ':'");
+        }
+        ++m_pos;
+        skip_whitespaces();
+        const size_t member = read_value();
+        at(member).m_key = key;
+        at(member).m_key_length = key_length;
+        ++count;
+        skip_whitespaces();
+        if (eof()) {
+            malformed("unexpected end of object");
+        }
+        if (peek() == '}') {
+            ++m_pos;
+            break;
+        }
+        if (peek() != ',') {
+            malformed("expected ',' or '}'");
+        }
+        ++m_pos;
+    }
+    at(index).m_size = count;
+}
+
+constexpr void StaticParser::read_array(size_t index) {
+    ++m_pos;
+    skip_whitespaces();
+    size_t count = 0;
+    if (!eof() && peek() == ']') {
+        ++m_pos;
+        at(index).m_size = 0;
+        return;
+    }
+    while (true) {
+        skip_whitespaces();
+        read_value();
+        ++count;
+        skip_whitespaces();
+        if (eof()) {
+            malformed("unexpected end of array");
+        }
+        if (peek() == ']') {
+            ++m_pos;
+            break;
+        }
+        if (peek() != ',') {
+            malformed("expected ',' or ']'");
+        }
+        ++m_pos;
+    }
+    at(index).m_size = count;
+}
+
+constexpr uint32_t StaticParser::read_hex4() {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (eof()) {
+            malformed("unexpected end of string");
+        }
+        const char c = peek();
+        v <<= 4;
+        if (c >= '0' && c <= '9') {
+            v |= uint32_t(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+            v |= uint32_t(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F') {
+            v |= uint32_t(c - 'A' + 10);
+        }
+        else {
+            malformed("invalid unicode escape sequence");
+        }
+        ++m_pos;
+    }
+    return v;
+}
+
+constexpr void StaticParser::put_codepoint(uint32_t cp) {
+    if (cp < 0x80) {
+        put(char(cp));
+    }
+    else if (cp < 0x800) {
+        put(char(0xC0 | (cp >> 6)));
+        put(char(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000) {
+        put(char(0xE0 | (cp >> 12)));
+        put(char(0x80 | ((cp >> 6) & 0x3F)));
+        put(char(0x80 | (cp & 0x3F)));
+    }
+    else {
+        put(char(0xF0 | (cp >> 18)));
+        put(char(0x80 | ((cp >> 12) & 0x3F)));
+        put(char(0x80 | ((cp >> 6) & 0x3F)));
+        put(char(0x80 | (cp & 0x3F)));
+    }
+}
+
+constexpr void StaticParser::read_string(size_t &offset, size_t &length) {
+    ++m_pos;
+    offset = m_byte_count;
+    while (true) {
+        if (eof()) {
+            malformed("unexpected end of string");
+        }
+        const unsigned char c = static_cast<unsigned char>(peek());
+        if (c == '"') {
+            ++m_pos;
+            break;
+        }
+        if (c < 0x20) {
+            malformed("control character in a string");
+        }
+        if (c == '\\') {
+            ++m_pos;
+            if (eof()) {
+                malformed("unexpected end of string");
+            }
+            const char e = peek();
+            ++m_pos;
+            switch (e) {
+            case '"': put('"'); break;
+            case '\\': put('\\'); break;
+            case '/': put('/'); break;
+            case 'b': put('\b'); break;
+            case 'f': put('\f'); break;
+            case 'n': put('\n'); break;
+            case 'r': put('\r'); break;
+            case 't': put('\t'); break;
+            case 'u':
+            {
+                uint32_t cp = read_hex4();
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (m_text.substr(m_pos, 2) != "\\u") {
+                        malformed("invalid surrogate pair");
+                    }
+                    m_pos += 2;
+                    const uint32_t low = read_hex4();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        malformed("invalid surrogate pair");
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    malformed("invalid surrogate pair");
+                }
+                put_codepoint(cp);
+                break;
+            }
+            default:
+                malformed("invalid escape sequence");
+            }
+            continue;
+        }
+        // copy an UTF-8 sequence after checking its length and continuation bytes
+        size_t n = 1;
+        if (c >= 0xF0 && c <= 0xF4) {
+            n = 4;
+        }
+        else if (c >= 0xE0) {
+            n = c <= 0xEF ? 3 : 0;
+        }
+        else if (c >= 0xC2) {
+            n = 2;
+        }
+        else if (c >= 0x80) {
+            n = 0;
+        }
+        if (n == 0 || m_pos + n > m_text.size()) {
+            throw UTF8Exception();
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const unsigned char b = static_cast<unsigned char>(m_text[m_pos + i]);
+            if (i > 0 && (b & 0xC0) != 0x80) {
+                throw UTF8Exception();
+            }
+            put(char(b));
+        }
+        m_pos += n;
+    }
+    length = m_byte_count - offset;
+}
+
+/**
+ * @brief Unsigned integer of fixed capacity, for the exact comparisons of nearest_double()
+ */
+class StaticParser::BigInt {
+public:
+    /**
+     * @brief Capacity, in 32 bits limbs
+     *
+     * The compared integers have at most 2600 bits: a significand of 801 digits, or a power
+     * of 5 of at most 1100 multiplied by a significand of 54 bits.
+     */
+    static constexpr size_t LIMBS = 128;
+
+    /**
+     * @brief Build an integer
+     *
+     * @param v value
+     */
+    constexpr explicit BigInt(uint64_t v = 0) : m_limbs{}, m_size(0) {
+        while (v != 0) {
+            push(uint32_t(v));
+            v >>= 32;
+        }
+    }
+
+    /**
+     * @brief Multiply by a small integer and add another one
+     *
+     * @param m multiplier
+     * @param a addend
+     */
+    constexpr void mul_add(uint32_t m, uint32_t a) {
+        uint64_t carry = a;
+        for (size_t i = 0; i < m_size; ++i) {
+            const uint64_t t = uint64_t(m_limbs[i]) * m + carry;
+            m_limbs[i] = uint32_t(t);
+            carry = t >> 32;
+        }
+        if (carry != 0) {
+            push(uint32_t(carry));
+        }
+    }
+
+    /**
+     * @brief Multiply by a 64 bits integer
+     *
+     * @param m multiplier
+     */
+    constexpr void mul(uint64_t m) {
+        BigInt high(*this);
+        high.mul_add(uint32_t(m >> 32), 0);
+        high.shl(32);
+        mul_add(uint32_t(m), 0);
+        add(high);
+    }
+
+    /**
+     * @brief Multiply by a power of 5
+     *
+     * @param n exponent
+     */
+    constexpr void mul_pow5(uint64_t n) {
+        for (; n >= 13; n -= 13) {
+            mul_add(1220703125, 0);
+        }
+        uint32_t p = 1;
+        for (; n > 0; --n) {
+            p *= 5;
+        }
+        mul_add(p, 0);
+    }
+
+    /**
+     * @brief Add an integer
+     *
+     * @param o addend
+     */
+    constexpr void add(const BigInt &o) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < o.m_size || carry != 0; ++i) {
+            if (i == m_size) {
+                push(0);
+            }
+            const uint64_t t = uint64_t(m_limbs[i]) + (i < o.m_size ? o.m_limbs[i] : 0) + carry;
+            m_limbs[i] = uint32_t(t);
+            carry = t >> 32;
+        }
+    }
+
+    /**
+     * @brief Multiply by a power of 2
+     *
+     * @param bits exponent
+     */
+    constexpr void shl(uint64_t bits) {
+        if (m_size == 0) {
+            return;
+        }
+        const size_t limbs = size_t(bits / 32);
+        const unsigned int shift = unsigned(bits % 32);
+        if (m_size + limbs + 1 > LIMBS) {
+            throw std::length_error("StaticParser::BigInt capacity exceeded");
+        }
+        m_limbs[m_size + limbs] = 0;
+        for (size_t i = m_size; i-- > 0;) {
+            const uint64_t t = uint64_t(m_limbs[i]) << shift;
+            m_limbs[i + limbs + 1] |= uint32_t(t >> 32);
+            m_limbs[i + limbs] = uint32_t(t);
+        }
+        for (size_t i = 0; i < limbs; ++i) {
+            m_limbs[i] = 0;
+        }
+        m_size += limbs + 1;
+        trim();
+    }
+
+    /**
+     * @brief Compare with another integer
+     *
+     * @param o other integer
+     * @return -1, 0 or 1 if this is less than, equal to or greater than o
+     */
+    constexpr int compare(const BigInt &o) const {
+        if (m_size != o.m_size) {
+            return m_size < o.m_size ? -1 : 1;
+        }
+        for (size_t i = m_size; i-- > 0;) {
+            if (m_limbs[i] != o.m_limbs[i]) {
+                return m_limbs[i] < o.m_limbs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+private:
+    uint32_t m_limbs[LIMBS];    ///< limbs, the least significant first
+    size_t m_size;              ///< number of limbs used, the most significant one is not 0
+
+    constexpr void push(uint32_t limb) {
+        if (m_size == LIMBS) {
+            throw std::length_error("StaticParser::BigInt capacity exceeded");
+        }
+        m_limbs[m_size++] = limb;
+    }
+
+    constexpr void trim() {
+        while (m_size > 0 && m_limbs[m_size - 1] == 0) {
+            --m_size;
+        }
+    }
+};
+
+constexpr double StaticParser::nearest_double(size_t begin, int64_t exponent, double estimate) const {
+    // the significand as an integer: beyond 800 digits, the other digits can't change the
+    // rounding, as long as a nonzero one is kept as a final 1
+    constexpr size_t MAX_DIGITS = 800;
+    BigInt digits;
+    size_t n = 0;
+    bool fractional = false;
+    bool sticky = false;
+    uint32_t chunk = 0;
+    uint32_t scale = 1;
+    for (size_t i = begin; i < m_text.size(); ++i) {
+        const char c = m_text[i];
+        if (c == '.') {
+            fractional = true;
+            continue;
+        }
+        if (!(c >= '0' && c <= '9')) {
+            break;
+        }
+        if (n == 0 && c == '0') {
+            exponent -= fractional;
+        }
+        else if (n < MAX_DIGITS) {
+            chunk = chunk * 10 + uint32_t(c - '0');
+            scale *= 10;
+            ++n;
+            exponent -= fractional;
+            if (scale == 1000000000) {
+                digits.mul_add(scale, chunk);
+                chunk = 0;
+                scale = 1;
+            }
+        }
+        else {
+            sticky = sticky || c != '0';
+            exponent += !fractional;
+        }
+    }
+    if (sticky) {
+        chunk = chunk * 10 + 1;
+        scale *= 10;
+        ++n;
+        --exponent;
+    }
+    digits.mul_add(scale, chunk);
+
+    // the value is digits * 10^exponent, and 10^(n + exponent - 1) <= value < 10^(n + exponent)
+    if (n == 0 || int64_t(n) + exponent < -324) {
+        return 0.0;
+    }
+    if (int64_t(n) + exponent > 310) {
+        malformed("error while parsing a floating-point number");
+    }
+
+    // the candidate is m * 2^k, with 2^52 <= m < 2^53, or m < 2^52 and k = -1074 (subnormal)
+    constexpr uint64_t HIDDEN = uint64_t(1) << 52;
+    constexpr uint64_t MAX_M = (uint64_t(1) << 53) - 1;
+    uint64_t m = 0;
+    int64_t k = -1074;
+    if (!(estimate <= 1.7976931348623157e308)) {
+        m = MAX_M;
+        k = 971;
+    }
+    else if (estimate > 0.0) {
+        double x = estimate;
+        k = 0;
+        for (; x >= 9007199254740992.0; ++k) {
+            x *= 0.5;
+        }
+        for (; x < 4503599627370496.0 && k > -1074; --k) {
+            x *= 2.0;
+        }
+        m = uint64_t(x);
+    }
+
+    // compare the value with (2m + 1) * 2^(k - 1), the midpoint between m * 2^k and its successor:
+    // digits * 5^exponent * 2^exponent against (2m + 1) * 2^(k - 1), without the negative powers
+    BigInt lhs(digits);
+    BigInt pow5(1);
+    if (exponent >= 0) {
+        lhs.mul_pow5(uint64_t(exponent));
+    }
+    else {
+        pow5.mul_pow5(uint64_t(-exponent));
+    }
+    const auto compare_midpoint = [&](uint64_t cm, int64_t ck) {
+        BigInt a(lhs);
+        BigInt b(pow5);
+        b.mul(2 * cm + 1);
+        if (exponent >= ck - 1) {
+            a.shl(uint64_t(exponent - (ck - 1)));
+        }
+        else {
+            b.shl(uint64_t(ck - 1 - exponent));
+        }
+        return a.compare(b);
+    };
+
+    // move the candidate one unit in the last place at a time, the ties go to the even significand
+    while (true) {
+        const int above = compare_midpoint(m, k);
+        if (above > 0 || (above == 0 && (m & 1) != 0)) {
+            if (m == MAX_M) {
+                if (k == 971) {
+                    malformed("error while parsing a floating-point number");
+                }
+                m = HIDDEN;
+                ++k;
+            }
+            else {
+                ++m;
+            }
+            if (above == 0) {
+                break;
+            }
+            continue;
+        }
+        if (m == 0) {
+            break;
+        }
+        uint64_t pm = m - 1;
+        int64_t pk = k;
+        if (m == HIDDEN && k > -1074) {
+            pm = MAX_M;
+            --pk;
+        }
+        const int below = compare_midpoint(pm, pk);
+        if (below < 0 || (below == 0 && (m & 1) != 0)) {
+            m = pm;
+            k = pk;
+            if (below == 0) {
+                break;
+            }
+            continue;
+        }
+        break;
+    }
+
+    // m * 2^k is exact, and so are the intermediate products
+    double d = double(m);
+    for (; k >= 32; k -= 32) {
+        d *= 4294967296.0;
+    }
+    for (; k <= -32; k += 32) {
+        d *= 1.0 / 4294967296.0;
+    }
+    for (; k > 0; --k) {
+        d *= 2.0;
+    }
+    for (; k < 0; ++k) {
+        d *= 0.5;
+    }
+    return d;
+}
+
+constexpr void StaticParser::read_number(size_t index) {
+    const bool negative = peek() == '-';
+    if (negative) {
+        ++m_pos;
+    }
+    const size_t begin = m_pos;
+    if (eof() || !(peek() >= '0' && peek() <= '9')) {
+        malformed("error while reading a number (integral part)");
+    }
+
+    // significand, as long as it fits in 64 bits, and decimal exponent
+    uint64_t significand = 0;
+    bool truncated = false;
+    int64_t exponent = 0;
+    int64_t explicit_exponent = 0;
+    bool integral = true;
+    bool overflow = false;
+
+    const auto digit = [&](char c, bool fractional) {
+        const uint64_t d = uint64_t(c - '0');
+        if (!truncated && significand <= (UINT64_MAX - d) / 10) {
+            significand = significand * 10 + d;
+            if (fractional) {
+                --exponent;
+            }
+        }
+        else {
+            // the integers must be exact, the other digits only matter for the rounding
+            overflow = overflow || !fractional;
+            truncated = true;
+            if (!fractional) {
+                ++exponent;
+            }
+        }
+    };
+
+    if (peek() == '0') {
+        ++m_pos;
+    }
+    else {
+        while (!eof() && peek() >= '0' && peek() <= '9') {
+            digit(peek(), false);
+            ++m_pos;
+        }
+    }
+    if (!eof() && peek() == '.') {
+        integral = false;
+        ++m_pos;
+        if (eof() || !(peek() >= '0' && peek() <= '9')) {
+            malformed("error while reading a number (fractional part)");
+        }
+        while (!eof() && peek() >= '0' && peek() <= '9') {
+            digit(peek(), true);
+            ++m_pos;
+        }
+    }
+    if (!eof() && (peek() == 'e' || peek() == 'E')) {
+        integral = false;
+        ++m_pos;
+        bool negative_exponent = false;
+        if (!eof() && (peek() == '+' || peek() == '-')) {
+            negative_exponent = peek() == '-';
+            ++m_pos;
+        }
+        if (eof() || !(peek() >= '0' && peek() <= '9')) {
+            malformed("error while reading a number (exponent part)");
+        }
+        int64_t e = 0;
+        while (!eof() && peek() >= '0' && peek() <= '9') {
+            if (e < 100000) {
+                e = e * 10 + (peek() - '0');
+            }
+            ++m_pos;
+        }
+        explicit_exponent = negative_exponent ? -e : e;
+        exponent += explicit_exponent;
+    }
+
+    StaticNode &n = at(index);
+    if (integral) {
+        if (overflow || (negative && significand > uint64_t(INT64_MAX) + 1)) {
+            malformed("error while parsing an integer number");
+        }
+        if (negative) {
+            n.m_type = Type::Int64;
+            n.m_int64 = significand == uint64_t(INT64_MAX) + 1 ? INT64_MIN : -int64_t(significand);
+        }
+        else {
+            n.m_type = Type::UInt64;
+            n.m_uint64 = significand;
+        }
+        return;
+    }
+
+    // exact when the significand and the power of ten are exact doubles
+    double powers[23] = {};
+    powers[0] = 1.0;
+    for (int i = 1; i < 23; ++i) {
+        powers[i] = powers[i - 1] * 10.0;
+    }
+    double d = double(significand);
+    if (significand != 0) {
+        int64_t e = exponent;
+        if (!truncated && significand <= (uint64_t(1) << 53) && e >= -22 && e <= 22) {
+            d = e >= 0 ? d * powers[e] : d / powers[-e];
+        }
+        else {
+            // approximation, within a few units in the last place, without overflow
+            while (e > 22 && d <= 1.7976931348623157e308 / powers[22]) {
+                d *= powers[22];
+                e -= 22;
+            }
+            while (e < -22 && d != 0.0) {
+                d /= powers[22];
+                e += 22;
+            }
+            if (e > 22) {
+                malformed("error while parsing a floating-point number");
+            }
+            if (e >= 0) {
+                d = d <= 1.7976931348623157e308 / powers[e] ? d * powers[e] : 1.7976931348623157e308;
+            }
+            else if (e >= -22) {
+                d /= powers[-e];
+            }
+            d = nearest_double(begin, explicit_exponent, d);
+        }
+        if (!(d <= 1.7976931348623157e308)) {
+            malformed("error while parsing a floating-point number");
+        }
+    }
+    n.m_type = Type::Double;
+    n.m_double = negative ? -d : d;
+}
+
+}
+
+#endif /* H4C51F8B1_FB45_42B2_B953_B23CED2BD341 */
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H95E2E56B_59C5_427F_8588_AA57474CE3B9
+#define H95E2E56B_59C5_427F_8588_AA57474CE3B9
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+#include <mini_json/mini_json_value.h>
+#include <mini_json/mini_json_parser.h>
+#include <mini_json/mini_json_pointer.h>
+#include <mini_json/mini_json_query.h>
+#include <mini_json/mini_json_byte_search.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief A predicate evaluated on the parser events, without building the document
+ *
+ * The predicate is a conjunction of clauses comparing the value at a path with a scalar
+ * literal, for instance:
+ * @code
+ * .level == "error" and .http.status >= 500 and .tags[0] != null
+ * @endcode
+ *
+ * A path is "." (the whole document) or a sequence of .name, ["name"] and [index], it is
+ * compiled into a JSON Pointer: as in RFC 6901, [0] also selects the member "0" of an object.
+ * The literals are JSON scalars. The comparisons follow Query::compare(): a missing value is
+ * only different from any literal.
+ *
+ * A document repeating a key on the path of a clause does not match: Parser keeps the last
+ * occurrence of a repeated key, while the clause may have been decided on the first one. The
+ * documents repeating other keys are evaluated normally.
+ *
+ * A document is abandoned as soon as a clause is false, the rest of the document is not parsed.
+ * A matching document is parsed until its end, to make sure it is well formed.
+ *
+ * Before parsing a line, filter_lines() runs a prefilter on its raw bytes: a clause which is
+ * false when its value is missing requires the keys of its path to appear in the line, as
+ * "key", and an == clause on a string, a boolean or null requires its literal too. The lines
+ * without a backslash, hence without escape sequences, lacking one of these needles are
+ * rejected without being parsed. See may_match().
+ *
+ * A StreamFilter is immutable once built and can be used from several threads, each one with
+ * its own Parser.
+ */
+class StreamFilter {
+public:
+    /**
+     * @brief A clause of the predicate
+     */
+    struct Clause {
+        Pointer m_path;     ///< path of the tested value
+        CompareOp m_op;     ///< operator
+        Value m_literal;    ///< right operand
+    };
+
+    /**
+     * @brief Result of the evaluation of a document
+     */
+    enum Result {
+        Match,      ///< the document matches the predicate
+        NoMatch,    ///< the document does not match the predicate
+        Malformed   ///< the document is not valid JSON and the predicate was not decided before the error
+    };
+
+    /**
+     * @brief Statistics of filter_lines()
+     */
+    struct Stats {
+        uint64_t m_lines;       ///< number of documents read, blank lines excluded
+        uint64_t m_matches;     ///< number of matching documents
+        uint64_t m_malformed;   ///< number of malformed documents, among the parsed ones
+        uint64_t m_skipped;     ///< number of documents rejected by the prefilter, without parsing
+    };
+
+    /**
+     * @brief Build a filter matching all the documents
+     */
+    StreamFilter() : m_clauses(), m_needles() {}
+
+    /**
+     * @brief Compile a filter expression
+     *
+     * @param expression clauses separated by "and"
+     * @throws QuerySyntaxException if the expression is not valid
+     */
+    explicit StreamFilter(std::string_view expression);
+
+    /**
+     * @brief Add a clause
+     *
+     * @param path path of the tested value
+     * @param op operator
+     * @param literal scalar right operand
+     * @return this filter
+     */
+    StreamFilter & where(Pointer path, CompareOp op, Value literal) {
+        m_clauses.push_back({std::move(path), op, std::move(literal)});
+        add_needles(m_clauses.back());
+        return *this;
+    }
+
+    /**
+     * @brief Returns the clauses of the predicate
+     *
+     * @return clauses
+     */
+    const std::vector<Clause> & clauses() const noexcept {
+        return m_clauses;
+    }
+
+    /**
+     * @brief Evaluate the predicate on a document
+     *
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param document document, UTF-8 encoded
+     * @param parser parser to use
+     * @return evaluation result, this method does not throw parsing exceptions
+     */
+    template<typename StatsPolicy> Result evaluate(std::string_view document, BasicParser<StatsPolicy> &parser) const;
+
+    /**
+     * @brief Test whether a document matches the predicate
+     *
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param document document, UTF-8 encoded
+     * @param parser parser to use
+     * @return true if the document is valid and matches the predicate
+     */
+    template<typename StatsPolicy> bool matches(std::string_view document, BasicParser<StatsPolicy> &parser) const {
+        return evaluate(document, parser) == Match;
+    }
+
+    /**
+     * @brief Prefilter, test whether a document may match the predicate without parsing it
+     *
+     * A document for which this method returns false can't match. A document for which it
+     * returns true must be verified with evaluate().
+     *
+     * @param document raw document
+     * @return false if the document can't match
+     */
+    bool may_match(std::string_view document) const noexcept;
+
+    /**
+     * @brief Returns the byte sequences required by the prefilter
+     *
+     * @return needles
+     */
+    const std::vector<std::string> & needles() const noexcept {
+        return m_needles;
+    }
+
+    /**
+     * @brief Filter a stream of JSON Lines (NDJSON)
+     *
+     * Each matching line is copied to the output, with its raw bytes. The blank lines are
+     * skipped. The malformed lines do not match.
+     *
+     * @tparam StatsPolicy statistics policy of the parser
+     * @param in input stream, one document per line
+     * @param out output stream
+     * @param parser parser to use
+     * @return statistics
+     */
+    template<typename StatsPolicy> Stats filter_lines(std::istream &in, std::ostream &out, BasicParser<StatsPolicy> &parser) const;
+
+private:
+    std::vector<Clause> m_clauses;      ///< conjunction of clauses
+    std::vector<std::string> m_needles; ///< byte sequences required in a matching document without escape sequences
+
+    /**
+     * @brief Add the needles of a clause to the prefilter
+     *
+     * @param c clause
+     */
+    void add_needles(const Clause &c);
+
+    class Evaluator;
+    class Compiler;
+};
+
+}
+
+#include <mini_json/mini_json_stream_filter_impl.h>
+
+#endif /* H95E2E56B_59C5_427F_8588_AA57474CE3B9 */
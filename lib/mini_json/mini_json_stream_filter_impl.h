@@ -0,0 +1,536 @@
+/*
+ * Copyright 2023 Florent Bondoux
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H99D90258_AC6A_45DB_85CA_DDF905B0A055
+#define H99D90258_AC6A_45DB_85CA_DDF905B0A055
+
+#include <algorithm>
+#include <mini_json/mini_json_stream_filter.h>
+
+namespace MiniJSON {
+
+/**
+ * @brief Parser event handler evaluating the clauses of a StreamFilter
+ */
+class StreamFilter::Evaluator {
+public:
+    /**
+     * @brief Prepare the evaluation of a document
+     *
+     * @param clauses clauses of the filter
+     */
+    explicit Evaluator(const std::vector<Clause> &clauses) : m_clauses(clauses), m_state(clauses.size(), UNDECIDED), m_stack(), m_max_depth(0) {
+        for (const Clause &c : clauses) {
+            m_max_depth = std::max(m_max_depth, c.m_path.size());
+        }
+    }
+
+    /**
+     * @brief Handle a null value
+     */
+    bool null_value(Position) {
+        return scalar([]() { return Value(); });
+    }
+    /**
+     * @brief Handle a boolean value
+     */
+    bool boolean_value(bool v, Position) {
+        return scalar([v]() { return Value(v); });
+    }
+    /**
+     * @brief Handle a positive integer
+     */
+    bool uint64_value(uint64_t v, Position) {
+        return scalar([v]() { return Value(v); });
+    }
+    /**
+     * @brief Handle a negative integer
+     */
+    bool int64_value(int64_t v, Position) {
+        return scalar([v]() { return Value(v); });
+    }
+    /**
+     * @brief Handle a floating point number
+     */
+    bool double_value(double v, Position) {
+        return scalar([v]() { return Value(v); });
+    }
+    /**
+     * @brief Handle a string
+     */
+    bool string_value(std::string &&v, Position) {
+        return scalar([&v]() { return Value(v); });
+    }
+    /**
+     * @brief Handle the begining of an object
+     */
+    bool begin_object(Position) {
+        if (!test([]() { return Value::new_object(); })) {
+            return false;
+        }
+        m_stack.push_back({false, 0, {}, {}});
+        return true;
+    }
+    /**
+     * @brief Handle an object key
+     *
+     * @return false if the key is repeated on the path of a clause
+     */
+    bool key(std::string &&k, Position) {
+        Frame &f = m_stack.back();
+        f.m_key = std::move(k);
+        const size_t depth = m_stack.size();
+        if (depth > m_max_depth) {
+            return true;
+        }
+        for (size_t i = 0; i < m_clauses.size(); ++i) {
+            const Pointer &path = m_clauses[i].m_path;
+            if (path.size() < depth || !prefix_at(path, depth)) {
+                continue;
+            }
+            if (std::find(f.m_seen.begin(), f.m_seen.end(), i) != f.m_seen.end()) {
+                // the parser keeps the last occurrence, which the clause may have been decided before
+                return false;
+            }
+            f.m_seen.push_back(i);
+        }
+        return true;
+    }
+    /**
+     * @brief Handle the end of an object
+     */
+    bool end_object() {
+        m_stack.pop_back();
+        next();
+        return true;
+    }
+    /**
+     * @brief Handle the begining of an array
+     */
+    bool begin_array(Position) {
+        if (!test([]() { return Value::new_array(); })) {
+            return false;
+        }
+        m_stack.push_back({true, 0, {}, {}});
+        return true;
+    }
+    /**
+     * @brief Handle the end of an array
+     */
+    bool end_array() {
+        m_stack.pop_back();
+        next();
+        return true;
+    }
+
+    /**
+     * @brief Decide the clauses whose values were not found in the document
+     *
+     * @return true if all the clauses are true
+     */
+    bool finish() const {
+        for (size_t i = 0; i < m_clauses.size(); ++i) {
+            if (m_state[i] == UNDECIDED && !Query::compare(nullptr, m_clauses[i].m_op, &m_clauses[i].m_literal)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static constexpr char UNDECIDED = 0;    ///< the value of the clause has not been found yet
+    static constexpr char DECIDED = 1;      ///< the clause is true
+
+    /**
+     * @brief Current position in an array or an object
+     */
+    struct Frame {
+        bool m_array;               ///< the container is an array
+        size_t m_index;             ///< index of the current element of an array
+        std::string m_key;          ///< key of the current member of an object
+        std::vector<size_t> m_seen; ///< clauses whose path goes through a key already seen in this object
+    };
+
+    const std::vector<Clause> &m_clauses;   ///< clauses of the filter
+    std::vector<char> m_state;              ///< state of each clause
+    std::vector<Frame> m_stack;             ///< current path
+    size_t m_max_depth;                     ///< length of the longest path of the clauses
+
+    /**
+     * @brief Test whether the current path is the path of a clause
+     *
+     * @param path path of a clause
+     * @return true if the paths are equal
+     */
+    bool at(const Pointer &path) const {
+        return path.size() == m_stack.size() && prefix_at(path, path.size());
+    }
+
+    /**
+     * @brief Test whether the first tokens of a path are the current path
+     *
+     * @param path path of a clause
+     * @param n number of tokens to compare, at most the sizes of the path and of the current path
+     * @return true if the n first tokens are equal
+     */
+    bool prefix_at(const Pointer &path, size_t n) const {
+        const auto &tokens = path.tokens();
+        for (size_t i = 0; i < n; ++i) {
+            const Frame &f = m_stack[i];
+            if (f.m_array ? tokens[i].index() != f.m_index : tokens[i].key().view() != f.m_key) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decide the clauses testing the current value
+     *
+     * @tparam F function returning the current value
+     * @param make builds the current value, only called if a clause tests it
+     * @return false if a clause is false
+     */
+    template<typename F> bool test(const F &make) {
+        if (m_stack.size() > m_max_depth) {
+            return true;
+        }
+        for (size_t i = 0; i < m_clauses.size(); ++i) {
+            if (m_state[i] != UNDECIDED || !at(m_clauses[i].m_path)) {
+                continue;
+            }
+            const Value v = make();
+            if (!Query::compare(&v, m_clauses[i].m_op, &m_clauses[i].m_literal)) {
+                return false;
+            }
+            m_state[i] = DECIDED;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Handle a scalar value
+     *
+     * @tparam F function returning the value
+     * @param make builds the value
+     * @return false if a clause is false
+     */
+    template<typename F> bool scalar(const F &make) {
+        if (!test(make)) {
+            return false;
+        }
+        next();
+        return true;
+    }
+
+    /**
+     * @brief Move to the next element if the current container is an array
+     */
+    void next() {
+        if (!m_stack.empty() && m_stack.back().m_array) {
+            ++m_stack.back().m_index;
+        }
+    }
+};
+
+/**
+ * @brief Compiler of the filter expressions
+ */
+class StreamFilter::Compiler {
+public:
+    /**
+     * @brief Prepare the compilation
+     *
+     * @param text expression
+     */
+    explicit Compiler(std::string_view text) : m_text(text), m_pos(0) {}
+
+    /**
+     * @brief Compile the expression
+     *
+     * @param filter filter receiving the clauses
+     */
+    void compile(StreamFilter &filter) {
+        skip_ws();
+        while (true) {
+            Pointer path = read_path();
+            skip_ws();
+            const CompareOp op = read_operator();
+            skip_ws();
+            Value literal = read_literal();
+            filter.where(std::move(path), op, std::move(literal));
+            skip_ws();
+            if (m_pos == m_text.size()) {
+                return;
+            }
+            if (!accept("and") || !(peek() == ' ' || peek() == '\t')) {
+                fail("expected \"and\"");
+            }
+            skip_ws();
+        }
+    }
+
+private:
+    std::string_view m_text;    ///< expression
+    size_t m_pos;               ///< current offset
+
+    /**
+     * @brief Throw a QuerySyntaxException at the current offset
+     */
+    [[noreturn]] void fail(const std::string &info) const {
+        throw QuerySyntaxException(m_pos, info);
+    }
+    /**
+     * @brief Returns the current character, or '\0' at the end of the expression
+     */
+    char peek() const {
+        return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+    }
+    /**
+     * @brief Skip the next characters if they are s
+     */
+    bool accept(std::string_view s) {
+        if (m_text.substr(m_pos, s.size()) == s) {
+            m_pos += s.size();
+            return true;
+        }
+        return false;
+    }
+    /**
+     * @brief Skip the blank characters
+     */
+    void skip_ws() {
+        while (peek() == ' ' || peek() == '\t') {
+            ++m_pos;
+        }
+    }
+    /**
+     * @brief Returns the length of the JSON string starting at the current offset
+     */
+    size_t string_length() const {
+        for (size_t i = m_pos + 1; i < m_text.size(); ++i) {
+            if (m_text[i] == '\\') {
+                ++i;
+            }
+            else if (m_text[i] == '"') {
+                return i + 1 - m_pos;
+            }
+        }
+        fail("unterminated string");
+    }
+    /**
+     * @brief Parse a JSON scalar of the given length at the current offset
+     */
+    Value read_json(size_t length) {
+        try {
+            Value v = Parser().parse(std::string(m_text.substr(m_pos, length)));
+            m_pos += length;
+            return v;
+        }
+        catch (const std::exception &) {
+            fail("invalid literal");
+        }
+    }
+    /**
+     * @brief Read a path, "." or a sequence of .name, ["name"] and [index]
+     */
+    Pointer read_path() {
+        if (peek() != '.') {
+            fail("expected a path");
+        }
+        std::vector<Pointer::Token> tokens;
+        if (m_pos + 1 == m_text.size() || m_text[m_pos + 1] == ' ' || m_text[m_pos + 1] == '\t') {
+            ++m_pos;
+            return Pointer();
+        }
+        while (true) {
+            if (peek() == '.' && m_pos + 1 < m_text.size() && m_text[m_pos + 1] != '[') {
+                ++m_pos;
+                const size_t start = m_pos;
+                while (m_pos < m_text.size() && std::string_view(" \t.[=!<>").find(m_text[m_pos]) == std::string_view::npos) {
+                    ++m_pos;
+                }
+                if (m_pos == start) {
+                    fail("expected a member name");
+                }
+                tokens.emplace_back(m_text.substr(start, m_pos - start));
+            }
+            else if (accept(".[") || accept("[")) {
+                if (peek() == '"') {
+                    const Value key = read_json(string_length());
+                    tokens.emplace_back(key.get<Type::String>());
+                }
+                else {
+                    const size_t start = m_pos;
+                    while (peek() >= '0' && peek() <= '9') {
+                        ++m_pos;
+                    }
+                    if (m_pos == start) {
+                        fail("expected a string or an index");
+                    }
+                    tokens.emplace_back(m_text.substr(start, m_pos - start));
+                    if (tokens.back().index() == Pointer::Token::NOT_AN_INDEX) {
+                        fail("invalid index");
+                    }
+                }
+                if (!accept("]")) {
+                    fail("expected ']'");
+                }
+            }
+            else {
+                return Pointer(std::move(tokens));
+            }
+        }
+    }
+    /**
+     * @brief Read a comparison operator
+     */
+    CompareOp read_operator() {
+        if (accept("==")) {
+            return CompareOp::Equal;
+        }
+        if (accept("!=")) {
+            return CompareOp::NotEqual;
+        }
+        if (accept("<=")) {
+            return CompareOp::LessEqual;
+        }
+        if (accept(">=")) {
+            return CompareOp::GreaterEqual;
+        }
+        if (accept("<")) {
+            return CompareOp::Less;
+        }
+        if (accept(">")) {
+            return CompareOp::Greater;
+        }
+        fail("expected a comparison operator");
+    }
+    /**
+     * @brief Read a JSON scalar
+     */
+    Value read_literal() {
+        if (peek() == '"') {
+            return read_json(string_length());
+        }
+        size_t length = 0;
+        while (m_pos + length < m_text.size() && m_text[m_pos + length] != ' ' && m_text[m_pos + length] != '\t') {
+            ++length;
+        }
+        if (length == 0 || peek() == '{' || peek() == '[') {
+            fail("expected a scalar literal");
+        }
+        return read_json(length);
+    }
+};
+
+inline StreamFilter::StreamFilter(std::string_view expression) : m_clauses(), m_needles() {
+    Compiler(expression).compile(*this);
+}
+
+inline void StreamFilter::add_needles(const Clause &c) {
+    if (Query::compare(nullptr, c.m_op, &c.m_literal)) {
+        // the clause is true if the value is missing, nothing is required
+        return;
+    }
+    std::vector<std::string> needles;
+    for (const Pointer::Token &t : c.m_path.tokens()) {
+        // a token which is a valid index may not be a key
+        if (t.index() == Pointer::Token::NOT_AN_INDEX) {
+            needles.push_back('"' + t.key().str() + '"');
+        }
+    }
+    if (c.m_op == CompareOp::Equal) {
+        switch (c.m_literal.get_type()) {
+        case Type::String:
+            needles.push_back('"' + std::string(c.m_literal.get<Type::String>()) + '"');
+            break;
+        case Type::Boolean:
+            needles.push_back(c.m_literal.get<Type::Boolean>() ? "true" : "false");
+            break;
+        case Type::Null:
+            needles.push_back("null");
+            break;
+        default:
+            // a number has many representations (1, 1.0, 1e0...)
+            break;
+        }
+    }
+    for (std::string &n : needles) {
+        if (std::find(m_needles.begin(), m_needles.end(), n) == m_needles.end()) {
+            m_needles.push_back(std::move(n));
+        }
+    }
+}
+
+inline bool StreamFilter::may_match(std::string_view document) const noexcept {
+    if (m_needles.empty() || ByteSearch::contains(document, '\\')) {
+        // the keys and the strings may be escaped
+        return true;
+    }
+    for (const std::string &n : m_needles) {
+        if (!ByteSearch::contains(document, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename StatsPolicy> inline StreamFilter::Result StreamFilter::evaluate(std::string_view document, BasicParser<StatsPolicy> &parser) const {
+    Evaluator evaluator(m_clauses);
+    try {
+        if (!parser.parse(document, evaluator)) {
+            // stopped as soon as a clause was false
+            return NoMatch;
+        }
+    }
+    catch (const std::exception &) {
+        return Malformed;
+    }
+    return evaluator.finish() ? Match : NoMatch;
+}
+
+template<typename StatsPolicy> inline StreamFilter::Stats StreamFilter::filter_lines(std::istream &in, std::ostream &out, BasicParser<StatsPolicy> &parser) const {
+    Stats stats{0, 0, 0, 0};
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        ++stats.m_lines;
+        if (!may_match(line)) {
+            ++stats.m_skipped;
+            continue;
+        }
+        switch (evaluate(line, parser)) {
+        case Match:
+            ++stats.m_matches;
+            out.write(line.data(), static_cast<std::streamsize>(line.size()));
+            out.put('\n');
+            break;
+        case Malformed:
+            ++stats.m_malformed;
+            break;
+        case NoMatch:
+            break;
+        }
+    }
+    return stats;
+}
+
+}
+
+#endif /* H99D90258_AC6A_45DB_85CA_DDF905B0A055 */
@@ -24,10 +24,18 @@
 #include <string>
 #include <map>
 #include <list>
-#include <any>
+#include <any>             // std::bad_any_cast, thrown on type mismatches
+#include <memory_resource>
+#include <new>
+#include <vector>
 #include <exception>
+#include <stdexcept>
 #include <initializer_list>
 #include <tuple>
+#include <string_view>
+#include <functional>
+#include <utility>
+#include <iterator>
 
 #include "utf_conv.h"
 
@@ -45,7 +53,7 @@ enum Type : unsigned int {
     UInt64 = 0x102, ///< number, restricted to unsigned 64 bits values
     Int64 = 0x103,  ///< number, restricted to signed 64 bits values
     Double = 0x304, ///< number, restricted to 64 bits floting point values
-    String = 0x5,   ///< string, underlying type is std::string
+    String = 0x5,   ///< string, underlying type is std::pmr::string
     Object = 0x406, ///< object, underlying type is ObjectValues
     Array = 0x407   ///< array, underlying type is ArrayValues
 };
@@ -69,13 +77,18 @@ static constexpr unsigned int MASK_TYPE_IS_CONTAINER = 0x400;
 /**
  * @brief The underlying type of a Value representing a JSON object
  * 
+ * The comparator is transparent: the members can be looked up with a std::string_view or a
+ * const char * without building a temporary string.
+ * 
+ * The nodes and the characters of the keys are allocated from the memory resource of the map.
  */
-typedef std::map<std::string, Value> ObjectValues;
+typedef std::pmr::map<std::pmr::string, Value, std::less<>> ObjectValues;
 /**
  * @brief The underlying type of a Value representing a JSON array
  * 
+ * The nodes are allocated from the memory resource of the list.
  */
-typedef std::list<Value> ArrayValues;
+typedef std::pmr::list<Value> ArrayValues;
 
 /**
  * @brief A templated struct holding the mapping between the Type enum and the actual data type
@@ -106,7 +119,7 @@ template<> struct TypeToNative<Type::Double>  { typedef double type; /*!< 64 bit
 /**
  * @brief Specialization of TypeToNative for String
  */
-template<> struct TypeToNative<Type::String>  { typedef std::string type; /*!< string data type */};
+template<> struct TypeToNative<Type::String>  { typedef std::pmr::string type; /*!< string data type */};
 /**
  * @brief Specialization of TypeToNative for Object
  */
@@ -161,8 +174,17 @@ struct Position {
 /**
  * @brief A JSON Value
  * 
- * The Value objects have two member variables : m_type, holding its data type, and m_value, a std::any holding the content.
- * Depending of the size of the content, there may be dynamic memory allocation to store the content.
+ * The Value objects have two member variables : m_type, holding its data type, and m_payload, holding the content.
+ * The booleans and numbers are stored in the Value. The strings, objects and arrays are stored in a block
+ * allocated from a std::pmr::memory_resource, which also allocates the nodes of the objects and arrays.
+ * 
+ * The resource is given when the value is built, and defaults to std::pmr::get_default_resource().
+ * It is not propagated: a value inserted in a container keeps its own resource. A copy uses the default
+ * resource, unless a resource is given to the copy constructor.
+ *
+ * The strings and the keys of the objects are std::pmr::string, their characters are allocated from
+ * the resource of the value and of the map: a document built with a resource does not use the global
+ * heap. A std::string given to a constructor is copied into the resource.
  */
 class Value {
 public:
@@ -170,48 +192,58 @@ public:
      * @brief Constructs a null JSON value
      * 
      */
-    Value() : m_type(Null), m_value(), m_position() {}
+    Value() : m_type(Null), m_payload(), m_position() {}
     /**
      * @brief Constructs a null JSON value
      * 
      * @param p Position in stream
      */
-    explicit Value(Position p) : m_type(Null), m_value(), m_position(p) {}
+    explicit Value(Position p) : m_type(Null), m_payload(), m_position(p) {}
     /**
      * @brief Constructs a boolean JSON value
      * 
      * @param v value
      * @param p Position in stream
      */
-    Value(bool v, Position p = {}) : m_type(Boolean), m_value(v), m_position(p) {}
+    Value(bool v, Position p = {}) : m_type(Boolean), m_payload(), m_position(p) {
+        m_payload.m_boolean = v;
+    }
     /**
      * @brief Constructs a number JSON value holding unsigned 64 bits integer values
      * 
      * @param v value
      * @param p Position in stream
      */
-    Value(uint64_t v, Position p = {}) : m_type(UInt64), m_value(v), m_position(p) {}
+    Value(uint64_t v, Position p = {}) : m_type(UInt64), m_payload(), m_position(p) {
+        m_payload.m_uint64 = v;
+    }
     /**
      * @brief Constructs a number JSON value holding signed 64 bits integer values
      * 
      * @param v value
      * @param p Position in stream
      */
-    Value(int64_t v, Position p = {}) : m_type(Int64), m_value(v), m_position(p) {}
+    Value(int64_t v, Position p = {}) : m_type(Int64), m_payload(), m_position(p) {
+        m_payload.m_int64 = v;
+    }
     /**
      * @brief Constructs a number JSON value holding unsigned 64 bits integer values
      * 
      * @param v value
      * @param p Position in stream
      */
-    Value(unsigned int v, Position p = {}) : m_type(UInt64), m_value(uint64_t(v)), m_position(p) {}
+    Value(unsigned int v, Position p = {}) : m_type(UInt64), m_payload(), m_position(p) {
+        m_payload.m_uint64 = v;
+    }
     /**
      * @brief Constructs a number JSON value holding signed 64 bits integer values
      * 
      * @param v value
      * @param p Position in stream
      */
-    Value(int v, Position p = {}) : m_type(Int64), m_value(int64_t(v)), m_position(p) {}
+    Value(int v, Position p = {}) : m_type(Int64), m_payload(), m_position(p) {
+        m_payload.m_int64 = v;
+    }
     /**
      * @brief Constructs a number JSON value holding 64 bits floating point values
      * 
@@ -219,18 +251,58 @@ public:
      * @param p Position in stream
      */
     Value(double v, Position p = {}) :
-        m_type(Double), m_value(v), m_position(p) {
+        m_type(Double), m_payload(), m_position(p) {
         if (!std::isfinite(v)) {
             throw BadValueException();
         }
+        m_payload.m_double = v;
     }
     /**
      * @brief Constructs a string JSON value
      * 
      * @param v value, must be UTF-8 encoded
      * @param p Position in stream
+     * @param resource memory resource of the string
      */
-    Value(const std::string &v, Position p = {}) : m_type(String), m_value(v), m_position(p) {}
+    Value(const std::string &v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(String), m_payload(), m_position(p) {
+        m_payload.m_string = new_string(v, resource);
+    }
+    /**
+     * @brief Constructs a string JSON value
+     * 
+     * @param v value, must be UTF-8 encoded
+     * @param p Position in stream
+     * @param resource memory resource of the string
+     */
+    Value(std::string_view v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(String), m_payload(), m_position(p) {
+        m_payload.m_string = new_string(v, resource);
+    }
+    /**
+     * @brief Constructs a string JSON value
+     * 
+     * @param v value, must be UTF-8 encoded
+     * @param p Position in stream
+     * @param resource memory resource of the string
+     */
+    Value(const std::pmr::string &v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(String), m_payload(), m_position(p) {
+        m_payload.m_string = new_string(v, resource);
+    }
+    /**
+     * @brief Constructs a string JSON value, moving the string
+     * 
+     * The characters are only moved if the string uses the same resource, they are copied otherwise.
+     * 
+     * @param v value, must be UTF-8 encoded
+     * @param p Position in stream
+     * @param resource memory resource of the string
+     */
+    Value(std::pmr::string &&v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(String), m_payload(), m_position(p) {
+        m_payload.m_string = new_string(std::move(v), resource);
+    }
     /**
      * @brief Constructs a NULL or string JSON value
      * 
@@ -238,90 +310,155 @@ public:
      * 
      * @param v if v is null, construct a NULL JSON value. Otherwise construct a string
      * @param p Position in stream
+     * @param resource memory resource of the string
      */
-    Value(const char *v, Position p = {}) :  m_type(), m_value(), m_position(p) {
-        if (v == nullptr) {
-            m_type = Null;
-            m_value.reset();
-        }
-        else {
+    Value(const char *v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(Null), m_payload(), m_position(p) {
+        if (v != nullptr) {
+            m_payload.m_string = new_string(std::string_view(v), resource);
             m_type = String;
-            m_value = std::string(v);
         }
     }
     /**
      * @brief Constructs an object JSON value
      * 
+     * The members are copied into the resource.
+     * 
      * @param v value, the keys must be UTF-8 encoded
      * @param p Position in stream
+     * @param resource memory resource of the object
      */
-    Value(const ObjectValues &v, Position p = {}) : m_type(Object), m_value(v), m_position(p) {}
+    Value(const ObjectValues &v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(Object), m_payload(), m_position(p) {
+        m_payload.m_object = copy_container(v, resource);
+    }
+    /**
+     * @brief Constructs an object JSON value, moving the members
+     * 
+     * The object keeps the memory resource of v.
+     * 
+     * @param v value, the keys must be UTF-8 encoded
+     * @param p Position in stream
+     */
+    Value(ObjectValues &&v, Position p = {}) : m_type(Object), m_payload(), m_position(p) {
+        m_payload.m_object = new_container<ObjectValues>(v.get_allocator().resource(), std::move(v));
+    }
     /**
      * @brief Constructs an array JSON value
      * 
+     * The elements are copied into the resource.
+     * 
+     * @param v value
+     * @param p Position in stream
+     * @param resource memory resource of the array
+     */
+    Value(const ArrayValues &v, Position p = {}, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+        m_type(Array), m_payload(), m_position(p) {
+        m_payload.m_array = copy_container(v, resource);
+    }
+    /**
+     * @brief Constructs an array JSON value, moving the elements
+     * 
+     * The array keeps the memory resource of v.
+     * 
      * @param v value
      * @param p Position in stream
      */
-    Value(const ArrayValues &v, Position p = {}): m_type(Array), m_value(v), m_position(p) {}
+    Value(ArrayValues &&v, Position p = {}) : m_type(Array), m_payload(), m_position(p) {
+        m_payload.m_array = new_container<ArrayValues>(v.get_allocator().resource(), std::move(v));
+    }
     /**
      * @brief Constructs an object JSON value
      * 
      * @param l list of (key, value) couples
      */
-    Value(std::initializer_list<std::tuple<std::string, Value>> l) : m_type(Object), m_value(ObjectValues{}), m_position()
+    Value(std::initializer_list<std::tuple<std::string, Value>> l) : Value(ObjectValues())
     {
         auto &content = get<Object>();
         for (auto &p : l) {
-            content[std::get<0>(p)] = std::get<1>(p);
+            content.insert_or_assign(std::pmr::string(std::get<0>(p), content.get_allocator()), std::get<1>(p));
         }
     }
 
     /**
      * @brief Copy constructor
      * 
+     * The copy uses the default memory resource.
+     * 
      * @param o JSON value
      */
-    Value(const Value &o) : m_type(o.m_type), m_value(o.m_value), m_position(o.m_position) {}
+    Value(const Value &o) : Value(o, std::pmr::get_default_resource()) {}
+    /**
+     * @brief Copy constructor, using a memory resource
+     * 
+     * @param o JSON value
+     * @param resource memory resource of the copy and of its descendants
+     */
+    Value(const Value &o, std::pmr::memory_resource *resource);
     /**
      * @brief Move constructor
      * 
+     * The moved value is left null. The value keeps its memory resource.
+     * 
      * @param o JSON value
      */
-    Value(Value &&o) : m_type(o.m_type), m_value(std::move(o.m_value)), m_position(o.m_position) {}
+    Value(Value &&o) noexcept : m_type(o.m_type), m_payload(o.m_payload), m_position(o.m_position) {
+        o.m_type = Null;
+    }
     
     
+    /**
+     * @brief Destructor
+     * 
+     * The nested containers are destroyed iteratively, using a work list rather than the
+     * call stack, so that the destruction of a deep document can't overflow the stack.
+     */
+    ~Value() {
+        if (m_type & MASK_TYPE_IS_CONTAINER) {
+            release_children();
+        }
+        release_payload();
+    }
+    
     /**
      * @brief Assignment operator
      * 
+     * The copy uses the default memory resource.
+     * 
      * @param o JSON value
      * @return reference to this
      */
     Value & operator=(const Value &o) {
-        m_type = o.m_type;
-        m_value = o.m_value;
-        m_position = o.m_position;
-        return *this;
+        return *this = Value(o);
     }
     /**
      * @brief Move assignment operator
      * 
+     * The moved value is left null. The value keeps its memory resource.
+     * o may be a descendant of this value.
+     * 
      * @param o JSON value
      * @return reference to this
      */
-    Value & operator=(Value &&o) {
-        m_type = o.m_type;
-        m_value = std::move(o.m_value);
-        m_position = o.m_position;
+    Value & operator=(Value &&o) noexcept {
+        if (this != &o) {
+            Value old(std::move(*this));
+            m_type = o.m_type;
+            m_payload = o.m_payload;
+            m_position = o.m_position;
+            o.m_type = Null;
+        }
         return *this;
     }
     
     /**
      * @brief Returns an empty JSON object value
      * 
+     * @param resource memory resource of the object
      * @return JSON value
      */
-    static Value new_object() {
-        return Value(ObjectValues{});
+    static Value new_object(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+        return Value(ObjectValues(resource));
     }
     /**
      * @brief Returns a new JSON object value
@@ -336,10 +473,11 @@ public:
     /**
      * @brief Returns an empty JSON array value
      * 
+     * @param resource memory resource of the array
      * @return JSON value
      */
-    static Value new_array() {
-        return Value(ArrayValues{});
+    static Value new_array(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+        return Value(ArrayValues(resource));
     }
     /**
      * @brief Returns a new JSON array value
@@ -348,10 +486,24 @@ public:
      * @return JSON value
      */
     static Value new_array(std::initializer_list<Value> l) {
+        return Value(ArrayValues(l));
+    }
+    /**
+     * @brief Returns a new JSON array value, forwarding each argument to the constructor of an element
+     * 
+     * Unlike the initializer_list version, the rvalue arguments are moved instead of being copied.
+     * 
+     * @param first first element
+     * @param rest other elements
+     * @return JSON value
+     */
+    template<typename First, typename... Rest,
+             typename = std::enable_if_t<sizeof...(Rest) != 0 || !std::is_convertible_v<First, std::pmr::memory_resource *> || std::is_null_pointer_v<std::decay_t<First>>>>
+    static Value new_array(First &&first, Rest &&...rest) {
         Value ret = new_array();
-        for (auto & v : l) {
-            ret.get<Array>().push_back(v);
-        }
+        auto &content = ret.get<Array>();
+        content.emplace_back(std::forward<First>(first));
+        (content.emplace_back(std::forward<Rest>(rest)), ...);
         return ret;
     }
     
@@ -361,6 +513,9 @@ public:
      * For numeric types, return true if the values are equal
      * even if the data types are different.
      * 
+     * The comparison returns immediately when comparing a value with itself
+     * or containers of different sizes.
+     * 
      * @param o other value
      * @return true if the values are identical
      */
@@ -375,6 +530,73 @@ public:
     bool operator!=(const Value &o) const {
         return !operator==(o);
     }
+    
+    /**
+     * @brief Returns a hash of this value, consistent with operator==
+     * 
+     * Two values which compare equal have the same hash. In particular, the numbers
+     * are hashed by value: UInt64 1, Int64 1 and Double 1.0 have the same hash.
+     * The positions are ignored.
+     * 
+     * The hash is computed on each call, which is O(n) for containers
+     * (see Snapshot::hash() for a cached version).
+     * 
+     * @return hash
+     */
+    size_t hash() const;
+
+    /**
+     * @brief Memory footprint of a value and its descendants, by category, see memory_usage()
+     */
+    struct MemoryUsage {
+        uint64_t m_values;          ///< number of Value objects
+        uint64_t m_value_bytes;     ///< Value objects, without their Position
+        uint64_t m_position_bytes;  ///< Position of the Value objects
+        uint64_t m_payload_bytes;   ///< blocks holding the content of the strings, objects and arrays
+        uint64_t m_node_bytes;      ///< links of the nodes of the objects and arrays
+        uint64_t m_string_bytes;    ///< characters of the strings stored outside of the string objects
+        uint64_t m_key_bytes;       ///< keys of the objects, string objects and characters
+
+        /**
+         * @brief Returns the sum of all categories
+         *
+         * @return bytes
+         */
+        uint64_t total() const {
+            return m_value_bytes + m_position_bytes + m_payload_bytes + m_node_bytes + m_string_bytes + m_key_bytes;
+        }
+
+        /**
+         * @brief Accumulate the footprint of another value
+         *
+         * @param o footprint
+         * @return this footprint
+         */
+        MemoryUsage & operator+=(const MemoryUsage &o) {
+            m_values += o.m_values;
+            m_value_bytes += o.m_value_bytes;
+            m_position_bytes += o.m_position_bytes;
+            m_payload_bytes += o.m_payload_bytes;
+            m_node_bytes += o.m_node_bytes;
+            m_string_bytes += o.m_string_bytes;
+            m_key_bytes += o.m_key_bytes;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Returns the memory footprint of this value and of its descendants
+     *
+     * The footprint includes this Value object itself. The sizes of the nodes of the objects and
+     * arrays are estimated from the usual layout of the red-black tree and list nodes, and the
+     * bookkeeping of the allocators (malloc headers, unused pool space) is not counted, so the
+     * result is a lower bound of the memory taken by the document.
+     *
+     * The descendants are walked without recursion.
+     *
+     * @return footprint
+     */
+    MemoryUsage memory_usage() const;
 
     /**
      * @brief Returns the type of the value
@@ -385,6 +607,24 @@ public:
         return m_type;
     }
     
+    /**
+     * @brief Returns the memory resource of the content of a String, Object or Array value
+     * 
+     * @return memory resource, nullptr for the other types
+     */
+    std::pmr::memory_resource * get_resource() const noexcept {
+        switch (m_type) {
+            case Type::String:
+                return m_payload.m_string->m_resource;
+            case Type::Object:
+                return m_payload.m_object->get_allocator().resource();
+            case Type::Array:
+                return m_payload.m_array->get_allocator().resource();
+            default:
+                return nullptr;
+        }
+    }
+
     /**
      * @brief Returns the position at which the value was parsed
      * 
@@ -412,8 +652,11 @@ public:
      * @throws throws std::bad_any_cast if the template argument does not match the actual data type
      */
     template<Type dt> const typename TypeToNative<dt>::type & get() const {
-        typedef typename TypeToNative<dt>::type T;
-        return std::any_cast<const T &>(m_value);
+        const typename TypeToNative<dt>::type *v = get_ptr<dt>();
+        if (v == nullptr) {
+            throw std::bad_any_cast();
+        }
+        return *v;
     }
     /**
      * @brief Get a reference on the object content
@@ -425,8 +668,7 @@ public:
      * @throws throws std::bad_any_cast if the template argument does not match the actual data type
      */
     template<Type dt> typename TypeToNative<dt>::type & get() {
-        typedef typename TypeToNative<dt>::type T;
-        return std::any_cast<T &>(m_value);
+        return const_cast<typename TypeToNative<dt>::type &>(static_cast<const Value *>(this)->get<dt>());
     }
 
     /**
@@ -438,9 +680,32 @@ public:
      * @tparam dt Must be equal to the data type of the object
      * @return a pointer to the value's content
      */
-    template<Type dt> const typename TypeToNative<dt>::type * get_ptr() const {
-        typedef typename TypeToNative<dt>::type T;
-        return std::any_cast<const T>(&m_value);
+    template<Type dt> const typename TypeToNative<dt>::type * get_ptr() const noexcept {
+        if (m_type != dt) {
+            return nullptr;
+        }
+        if constexpr (dt == Type::Boolean) {
+            return &m_payload.m_boolean;
+        }
+        else if constexpr (dt == Type::UInt64) {
+            return &m_payload.m_uint64;
+        }
+        else if constexpr (dt == Type::Int64) {
+            return &m_payload.m_int64;
+        }
+        else if constexpr (dt == Type::Double) {
+            return &m_payload.m_double;
+        }
+        else if constexpr (dt == Type::String) {
+            return &m_payload.m_string->m_string;
+        }
+        else if constexpr (dt == Type::Object) {
+            return m_payload.m_object;
+        }
+        else {
+            static_assert(dt == Type::Array, "Null has no content");
+            return m_payload.m_array;
+        }
     }
     /**
      * @brief Get a pointer to the object content
@@ -451,9 +716,8 @@ public:
      * @tparam dt Must be equal to the data type of the object
      * @return a pointer to the value's content
      */
-    template<Type dt> typename TypeToNative<dt>::type * get_ptr() {
-        typedef typename TypeToNative<dt>::type T;
-        return std::any_cast<T>(&m_value);
+    template<Type dt> typename TypeToNative<dt>::type * get_ptr() noexcept {
+        return const_cast<typename TypeToNative<dt>::type *>(static_cast<const Value *>(this)->get_ptr<dt>());
     }
     
     /**
@@ -464,8 +728,13 @@ public:
      * @throws std::out_of_range if the key is not defined
      * @throws std::bad_any_cast if this value is not an Object
      */
-    const Value & operator[](const std::string &key) const {
-        return get<Type::Object>().at(key);
+    const Value & operator[](std::string_view key) const {
+        const auto &map = get<Type::Object>();
+        auto it = map.find(key);
+        if (it == map.end()) {
+            throw std::out_of_range("Value::operator[]");
+        }
+        return it->second;
     }
     
     /**
@@ -473,11 +742,15 @@ public:
      * 
      * @param key The key to retrieve
      * @return Value
-     * @throws std::out_of_range if the key is not defined
      * @throws std::bad_any_cast if this value is not an Object
      */
-    Value & operator[](const std::string &key) {
-        return get<Type::Object>()[key];
+    Value & operator[](std::string_view key) {
+        auto &map = get<Type::Object>();
+        auto it = map.find(key);
+        if (it == map.end()) {
+            it = map.emplace_hint(it, key, Value());
+        }
+        return it->second;
     }
     
     /**
@@ -487,8 +760,68 @@ public:
      * @return true if the key is defined
      * @throws std::bad_any_cast if this value is not an Object
      */
-    bool contains(const std::string &key) const {
-        return get<Type::Object>().count(key) != 0;
+    bool contains(std::string_view key) const {
+        const auto &map = get<Type::Object>();
+        return map.find(key) != map.end();
+    }
+
+    /**
+     * @brief Find a member by its key, with a single lookup
+     * 
+     * Unlike operator[], find() does not throw an exception if this value is not an Object.
+     * 
+     * @param key The key to retrieve
+     * @return a pointer to the member, or nullptr if this value is not an Object or if the key is not defined
+     */
+    const Value * find(std::string_view key) const noexcept {
+        const ObjectValues *map = get_ptr<Type::Object>();
+        if (map == nullptr) {
+            return nullptr;
+        }
+        auto it = map->find(key);
+        return it != map->end() ? &it->second : nullptr;
+    }
+    /**
+     * @brief Find a member by its key, with a single lookup
+     * 
+     * Unlike operator[], find() does not throw an exception if this value is not an Object.
+     * 
+     * @param key The key to retrieve
+     * @return a pointer to the member, or nullptr if this value is not an Object or if the key is not defined
+     */
+    Value * find(std::string_view key) noexcept {
+        return const_cast<Value *>(static_cast<const Value *>(this)->find(key));
+    }
+
+    /**
+     * @brief Get a const pointer to the content of a member
+     * 
+     * This method never throws an exception.
+     * 
+     * @tparam dt Expected data type of the member
+     * @param key The key to retrieve
+     * @return a pointer to the member's content, or nullptr if this value is not an Object,
+     *         if the key is not defined or if the member is not of type dt
+     */
+    template<Type dt> const typename TypeToNative<dt>::type * get_ptr(std::string_view key) const noexcept {
+        const Value *v = find(key);
+        return v != nullptr ? v->get_ptr<dt>() : nullptr;
+    }
+
+    /**
+     * @brief Get a copy of the content of a member, or a default value
+     * 
+     * This method does not throw an exception, unless copying the content does.
+     * 
+     * @tparam dt Expected data type of the member
+     * @param key The key to retrieve
+     * @param def Value returned if this value is not an Object, if the key is not defined or if
+     *            the member is not of type dt
+     * @return the member's content or def
+     */
+    template<Type dt> typename TypeToNative<dt>::type get_or(std::string_view key, typename TypeToNative<dt>::type def) const {
+        const typename TypeToNative<dt>::type *p = get_ptr<dt>(key);
+        return p != nullptr ? *p : def;
     }
     
     
@@ -511,6 +844,79 @@ public:
         }
     }
     
+    /**
+     * @brief Append an element to an Array value
+     * 
+     * @param v element
+     * @return reference to the new element
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    Value & push_back(const Value &v) {
+        return get<Array>().emplace_back(v);
+    }
+    /**
+     * @brief Append an element to an Array value, moving it
+     * 
+     * @param v element
+     * @return reference to the new element
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    Value & push_back(Value &&v) {
+        return get<Array>().emplace_back(std::move(v));
+    }
+    /**
+     * @brief Append an element to an Array value, constructed in place
+     * 
+     * @param args arguments forwarded to a constructor of Value
+     * @return reference to the new element
+     * @throws std::bad_any_cast if this value is not an Array
+     */
+    template<typename... Args> Value & emplace_back(Args &&...args) {
+        return get<Array>().emplace_back(std::forward<Args>(args)...);
+    }
+    /**
+     * @brief Insert an element in an Array value
+     * 
+     * @param index position of the new element, at most the size of the array
+     * @param v element
+     * @return reference to the new element
+     * @throws std::bad_any_cast if this value is not an Array
+     * @throws std::out_of_range if index is greater than the size of the array
+     */
+    Value & insert(size_t index, Value v) {
+        auto &content = get<Array>();
+        if (index > content.size()) {
+            throw std::out_of_range("Value::insert");
+        }
+        return *content.insert(std::next(content.begin(), static_cast<ptrdiff_t>(index)), std::move(v));
+    }
+    /**
+     * @brief Add a member to an Object value, constructed in place, if the key is not already present
+     * 
+     * As std::map::try_emplace, the arguments are not used if the key is present.
+     * 
+     * @param key key, must be UTF-8 encoded
+     * @param args arguments forwarded to a constructor of Value
+     * @return iterator to the member with this key and true if it was inserted
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    template<typename... Args> std::pair<ObjectValues::iterator, bool> emplace(std::string_view key, Args &&...args) {
+        auto &map = get<Object>();
+        return map.try_emplace(std::pmr::string(key, map.get_allocator()), std::forward<Args>(args)...);
+    }
+    /**
+     * @brief Set a member of an Object value, replacing the previous value if the key is present
+     * 
+     * @param key key, must be UTF-8 encoded
+     * @param v value
+     * @return reference to the member value
+     * @throws std::bad_any_cast if this value is not an Object
+     */
+    Value & insert_or_assign(std::string_view key, Value v) {
+        auto &map = get<Object>();
+        return map.insert_or_assign(std::pmr::string(key, map.get_allocator()), std::move(v)).first->second;
+    }
+    
     /**
      * @brief Return a compact string representation of this document
      * 
@@ -527,33 +933,186 @@ public:
     std::string to_string(int indent) const;
 
 private:
-    Type m_type;        ///< data type of this value
-    std::any m_value;   ///< Actual value, whose type is TypeToNative<m_type>::type
+    /**
+     * @brief Content of a String value
+     */
+    struct StringBox {
+        std::pmr::string m_string;                  ///< string, whose characters are allocated from m_resource
+        std::pmr::memory_resource *m_resource;      ///< memory resource of this block
+    };
+
+    /**
+     * @brief Content of a value, selected by m_type
+     */
+    union Payload {
+        bool m_boolean;             ///< Boolean content
+        uint64_t m_uint64;          ///< UInt64 content
+        int64_t m_int64;            ///< Int64 content
+        double m_double;            ///< Double content
+        StringBox *m_string;        ///< String content
+        ObjectValues *m_object;     ///< Object content, allocated from the resource of the map
+        ArrayValues *m_array;       ///< Array content, allocated from the resource of the list
+    };
+
+    Type m_type;            ///< data type of this value
+    Payload m_payload;      ///< Actual value, whose type is TypeToNative<m_type>::type
     Position m_position;    ///< Position in the input stream at which the value was parsed
     
-    /* Compare 2 any values with the same data type */
     /**
-     * @brief Compare two std::any assuming they are holding the same data type and the operator == is defined
+     * @brief Allocate the content of a String value
+     * 
+     * @param v string
+     * @param resource memory resource
+     * @return content
+     */
+    template<typename S> static StringBox * new_string(S &&v, std::pmr::memory_resource *resource) {
+        void *block = resource->allocate(sizeof(StringBox), alignof(StringBox));
+        try {
+            return new (block) StringBox{std::pmr::string(std::forward<S>(v), resource), resource};
+        }
+        catch (...) {
+            resource->deallocate(block, sizeof(StringBox), alignof(StringBox));
+            throw;
+        }
+    }
+    
+    /**
+     * @brief Allocate the content of an Object or Array value
      * 
-     * @tparam dt Data type
-     * @param a std::any holding a TypeToNative<dt>::type value
-     * @param b std::any holding a TypeToNative<dt>::type value
-     * @return true if the values are equal
+     * @tparam C ObjectValues or ArrayValues
+     * @param resource memory resource of the block and of the container
+     * @param args arguments forwarded to the constructor of the container, after the allocator
+     * @return content
      */
-    template <Type dt> static bool value_equal(const std::any &a, const std::any &b) {
-        const auto &va = std::any_cast<const typename TypeToNative<dt>::type &>(a);
-        const auto &vb = std::any_cast<const typename TypeToNative<dt>::type &>(b);
-        return va == vb;
+    template<typename C, typename... Args> static C * new_container(std::pmr::memory_resource *resource, Args &&...args) {
+        void *block = resource->allocate(sizeof(C), alignof(C));
+        if constexpr (sizeof...(Args) == 0) {
+            return new (block) C(resource);
+        }
+        else {
+            // the move constructor of the pmr containers keeps the allocator and doesn't throw
+            return new (block) C(std::forward<Args>(args)...);
+        }
     }
     
+    /**
+     * @brief Allocate a copy of the content of an Object or Array value
+     * 
+     * @tparam C ObjectValues or ArrayValues
+     * @param v content
+     * @param resource memory resource of the copy and of its descendants
+     * @return content
+     */
+    template<typename C> static C * copy_container(const C &v, std::pmr::memory_resource *resource);
+    
+    /**
+     * @brief Destroy and deallocate the content of an Object or Array value
+     * 
+     * @tparam C ObjectValues or ArrayValues
+     * @param c content
+     */
+    template<typename C> static void delete_container(C *c) noexcept {
+        std::pmr::memory_resource *resource = c->get_allocator().resource();
+        c->~C();
+        resource->deallocate(c, sizeof(C), alignof(C));
+    }
+    
+    /**
+     * @brief Destroy and deallocate the content of a String, Object or Array value
+     */
+    void release_payload() noexcept;
+    
     /**
      * @brief Compare 2 numeric values (integral or floating point)
      * 
+     * The comparison is exact: an integer is only equal to a double holding the same mathematical value.
+     * 
      * @param a Value of type Int64, UInt64 or Double
      * @param b Value of type Int64, UInt64 or Double
      * @return true if the two numeric values are equal
      */
     static bool numeric_equal(const Value &a, const Value &b);
+    
+    /**
+     * @brief Finalize a 64 bits value into a well distributed hash
+     * 
+     * @param x value
+     * @return hash
+     */
+    static size_t hash_mix(uint64_t x);
+    
+    /**
+     * @brief Combine a hash into a seed, the result depends on the order of the calls
+     * 
+     * @param seed current hash
+     * @param h hash to combine
+     * @return new hash
+     */
+    static size_t hash_combine(size_t seed, size_t h);
+    
+    /**
+     * @brief Hash a scalar (non container) value
+     * 
+     * @param v value, must not be an Object nor an Array
+     * @return hash
+     */
+    static size_t hash_scalar(const Value &v);
+    
+    /**
+     * @brief Hash a scalar content
+     * 
+     * @tparam Get function returning a pointer to the content, given its native type (std::string_view for a String)
+     * @param t data type, must not be Object nor Array
+     * @param get accessor of the content
+     * @return hash
+     */
+    template<typename Get> static size_t hash_scalar_content(Type t, Get get);
+    
+    /**
+     * @brief Destroy the nested containers of a container without recursion
+     * 
+     * The non-empty containers found among the descendants are moved to a work list and
+     * emptied one by one, so each destructor only releases scalars and empty containers.
+     */
+    void release_children() noexcept;
+    
+    /**
+     * @brief Move the non-empty container children of a container to a work list
+     * 
+     * @param v container
+     * @param pending work list
+     */
+    static void detach_children(Value &v, std::vector<Value> &pending);
+
+    /**
+     * @brief Returns the number of bytes allocated by a string for its characters, from its resource
+     *
+     * @param s string
+     * @return bytes, 0 when the characters are stored in the small string buffer
+     */
+    static size_t string_allocated_bytes(const std::pmr::string &s) noexcept;
+
+    friend class Snapshot;
+    friend class Patch;
+};
+
+}
+
+namespace std {
+
+/**
+ * @brief Specialization of std::hash for MiniJSON::Value, see Value::hash()
+ */
+template<> struct hash<MiniJSON::Value> {
+    /**
+     * @brief Hash a value
+     * 
+     * @param v value
+     * @return hash
+     */
+    size_t operator()(const MiniJSON::Value &v) const {
+        return v.hash();
+    }
 };
 
 }
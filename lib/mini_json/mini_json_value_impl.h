@@ -17,6 +17,7 @@
 #ifndef H16B861EE_DE73_445A_9722_3184BA3BDA77
 #define H16B861EE_DE73_445A_9722_3184BA3BDA77
 
+#include <cstring>
 #include <mini_json/mini_json_value.h>
 #include <mini_json/mini_json_generator.h>
 
@@ -88,30 +89,30 @@ inline bool Value::numeric_equal(const Value &a, const Value &b) {
             return false;
         }
         
-        // if ra is integral and positive
+        // the integral double is converted to an integer, which is exact once in range:
+        // converting the integer to a double would round it above 2^53
         if (va >= 0.0) {
-            // cast to integer and check that we are not out of bounds
-            uint64_t ua = (uint64_t) trunc(va);
-            if (va != (double) ua) {
+            // ra is integral and positive
+            if (va >= 18446744073709551616.0) {
                 return false;
             }
+            uint64_t ua = (uint64_t) va;
             uint64_t vb;
             switch (rb.m_type) {
                 case Type::Int64: vb = rb.get<Type::Int64>(); break;
                 case Type::UInt64: vb = rb.get<Type::UInt64>(); break;
                 default: return false;
             }
-            return va == vb;
+            return ua == vb;
         }
         else {
             // ra is integral and negative
-            // cast to integer and check that we are not out of bounds
-            int64_t ia = (int64_t) trunc(va);
-            if (va != (double) ia) {
+            if (va < -9223372036854775808.0) {
                 return false;
             }
+            int64_t ia = (int64_t) va;
             int64_t vb = rb.get<Type::Int64>();
-            return va == vb;
+            return ia == vb;
         }
     }
     
@@ -120,6 +121,9 @@ inline bool Value::numeric_equal(const Value &a, const Value &b) {
 
 inline bool Value::operator==(const Value &o) const {
     const auto type_is_numeric = [](const Type t) { return bool(t & MASK_TYPE_IS_NUMERIC); };
+    if (this == &o) {
+        return true;
+    }
     if (m_type != o.m_type) {
         // if the types are both numerics but different, do a "deep" comparison
         if (type_is_numeric(m_type) && type_is_numeric(o.m_type)) {
@@ -131,23 +135,278 @@ inline bool Value::operator==(const Value &o) const {
     case Type::Null:
         return true;
     case Type::Boolean:
-        return value_equal<Type::Boolean>(m_value, o.m_value);
+        return m_payload.m_boolean == o.m_payload.m_boolean;
     case Type::UInt64:
-        return value_equal<Type::UInt64>(m_value, o.m_value);
+        return m_payload.m_uint64 == o.m_payload.m_uint64;
     case Type::Int64:
-        return value_equal<Type::Int64>(m_value, o.m_value);
+        return m_payload.m_int64 == o.m_payload.m_int64;
     case Type::Double:
-        return value_equal<Type::Double>(m_value, o.m_value);
+        return m_payload.m_double == o.m_payload.m_double;
     case Type::String:
-        return value_equal<Type::String>(m_value, o.m_value);
+        return m_payload.m_string->m_string == o.m_payload.m_string->m_string;
     case Type::Object:
-        return value_equal<Type::Object>(m_value, o.m_value);
+        return *m_payload.m_object == *o.m_payload.m_object;
     case Type::Array:
-        return value_equal<Type::Array>(m_value, o.m_value);
+        return *m_payload.m_array == *o.m_payload.m_array;
     }
     return false;
 }
 
+inline Value::Value(const Value &o, std::pmr::memory_resource *resource) : m_type(o.m_type), m_payload(o.m_payload), m_position(o.m_position) {
+    switch (o.m_type) {
+    case Type::String:
+        m_payload.m_string = new_string(o.m_payload.m_string->m_string, resource);
+        break;
+    case Type::Object:
+        m_payload.m_object = copy_container(*o.m_payload.m_object, resource);
+        break;
+    case Type::Array:
+        m_payload.m_array = copy_container(*o.m_payload.m_array, resource);
+        break;
+    default:
+        break;
+    }
+}
+
+template<typename C> inline C * Value::copy_container(const C &v, std::pmr::memory_resource *resource) {
+    C *c = new_container<C>(resource);
+    try {
+        for (const auto &e : v) {
+            if constexpr (std::is_same_v<C, ObjectValues>) {
+                c->emplace_hint(c->end(), e.first, Value(e.second, resource));
+            }
+            else {
+                c->emplace_back(e, resource);
+            }
+        }
+    }
+    catch (...) {
+        delete_container(c);
+        throw;
+    }
+    return c;
+}
+
+inline void Value::release_payload() noexcept {
+    switch (m_type) {
+    case Type::String:
+    {
+        std::pmr::memory_resource *resource = m_payload.m_string->m_resource;
+        m_payload.m_string->~StringBox();
+        resource->deallocate(m_payload.m_string, sizeof(StringBox), alignof(StringBox));
+        break;
+    }
+    case Type::Object:
+        delete_container(m_payload.m_object);
+        break;
+    case Type::Array:
+        delete_container(m_payload.m_array);
+        break;
+    default:
+        break;
+    }
+    m_type = Null;
+}
+
+inline void Value::detach_children(Value &v, std::vector<Value> &pending) {
+    const auto nested = [](const Value &c) {
+        if (c.m_type == Object) {
+            return !c.get<Object>().empty();
+        }
+        if (c.m_type == Array) {
+            return !c.get<Array>().empty();
+        }
+        return false;
+    };
+    if (v.m_type == Object) {
+        for (auto &m : v.get<Object>()) {
+            if (nested(m.second)) {
+                pending.push_back(std::move(m.second));
+            }
+        }
+    }
+    else {
+        for (auto &e : v.get<Array>()) {
+            if (nested(e)) {
+                pending.push_back(std::move(e));
+            }
+        }
+    }
+}
+
+inline void Value::release_children() noexcept {
+    std::vector<Value> pending;
+    try {
+        detach_children(*this, pending);
+        while (!pending.empty()) {
+            Value v = std::move(pending.back());
+            pending.pop_back();
+            detach_children(v, pending);
+            // v is destroyed here, its remaining children are scalars or empty containers
+        }
+    }
+    catch (...) {
+        // out of memory for the work list: the remaining values are destroyed recursively
+    }
+}
+
+inline size_t Value::hash_mix(uint64_t x) {
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return size_t(x);
+}
+
+inline size_t Value::hash_combine(size_t seed, size_t h) {
+    return hash_mix(uint64_t(seed) * 31 + h + 0x9E3779B97F4A7C15ULL);
+}
+
+template<typename Get> inline size_t Value::hash_scalar_content(Type t, Get get) {
+    // one distinct constant per kind of value, all the numbers share the same one
+    static constexpr uint64_t HASH_NULL = 0x6E756C6CULL;
+    static constexpr uint64_t HASH_BOOLEAN = 0x626F6F6CULL;
+    static constexpr uint64_t HASH_NUMBER = 0x6E756D62ULL;
+    static constexpr uint64_t HASH_FRACTION = 0x66726163ULL;
+    static constexpr uint64_t HASH_STRING = 0x73747269ULL;
+    
+    switch (t) {
+    case Type::Null:
+        return hash_mix(HASH_NULL);
+    case Type::Boolean:
+        return hash_mix(HASH_BOOLEAN + *get(static_cast<const bool *>(nullptr)));
+    case Type::UInt64:
+        return hash_combine(HASH_NUMBER, hash_mix(*get(static_cast<const uint64_t *>(nullptr))));
+    case Type::Int64:
+        // a positive Int64 has the same representation as the equal UInt64
+        return hash_combine(HASH_NUMBER, hash_mix(uint64_t(*get(static_cast<const int64_t *>(nullptr)))));
+    case Type::Double:
+    {
+        // an integral double is hashed as the equal integer, if it is in range (see numeric_equal)
+        double d = *get(static_cast<const double *>(nullptr));
+        if (trunc(d) == d) {
+            if (d >= 0.0 && d < 18446744073709551616.0) {
+                return hash_combine(HASH_NUMBER, hash_mix(uint64_t(d)));
+            }
+            if (d < 0.0 && d >= -9223372036854775808.0) {
+                return hash_combine(HASH_NUMBER, hash_mix(uint64_t(int64_t(d))));
+            }
+        }
+        // this value can only be equal to another double with the same representation
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return hash_combine(HASH_FRACTION, hash_mix(bits));
+    }
+    case Type::String:
+        // the strings are selected as std::string_view, the storage type differs between Value and Snapshot
+        return hash_combine(HASH_STRING, std::hash<std::string_view>()(*get(static_cast<const std::string_view *>(nullptr))));
+    default:
+        throw std::bad_any_cast();
+    }
+}
+
+inline size_t Value::hash_scalar(const Value &v) {
+    return hash_scalar_content(v.m_type, [&v](const auto *type) {
+        using T = std::remove_const_t<std::remove_pointer_t<decltype(type)>>;
+        if constexpr (std::is_same_v<T, bool>) {
+            return &v.m_payload.m_boolean;
+        }
+        else if constexpr (std::is_same_v<T, uint64_t>) {
+            return &v.m_payload.m_uint64;
+        }
+        else if constexpr (std::is_same_v<T, int64_t>) {
+            return &v.m_payload.m_int64;
+        }
+        else if constexpr (std::is_same_v<T, double>) {
+            return &v.m_payload.m_double;
+        }
+        else {
+            return &v.m_payload.m_string->m_string;
+        }
+    });
+}
+
+inline size_t Value::hash() const {
+    static constexpr uint64_t HASH_OBJECT = 0x6F626A65ULL;
+    static constexpr uint64_t HASH_ARRAY = 0x61727261ULL;
+    
+    switch (m_type) {
+    case Type::Object:
+    {
+        // the members are sorted, the order of the combinations is deterministic
+        size_t h = hash_mix(HASH_OBJECT);
+        for (const auto &m : get<Type::Object>()) {
+            h = hash_combine(h, std::hash<std::string_view>()(m.first));
+            h = hash_combine(h, m.second.hash());
+        }
+        return h;
+    }
+    case Type::Array:
+    {
+        size_t h = hash_mix(HASH_ARRAY);
+        for (const auto &e : get<Type::Array>()) {
+            h = hash_combine(h, e.hash());
+        }
+        return h;
+    }
+    default:
+        return hash_scalar(*this);
+    }
+}
+
+inline size_t Value::string_allocated_bytes(const std::pmr::string &s) noexcept {
+    // the characters of a short string are stored in the string object itself
+    const char *object = reinterpret_cast<const char *>(&s);
+    if (s.data() >= object && s.data() < object + sizeof(std::pmr::string)) {
+        return 0;
+    }
+    return s.capacity() + 1;
+}
+
+inline Value::MemoryUsage Value::memory_usage() const {
+    // color and parent, left, right links of a red-black tree node, next and previous links of a list node
+    static constexpr size_t MAP_NODE_LINKS = 4 * sizeof(void *);
+    static constexpr size_t LIST_NODE_LINKS = 2 * sizeof(void *);
+
+    MemoryUsage usage{};
+    std::vector<const Value *> pending;
+    pending.push_back(this);
+    while (!pending.empty()) {
+        const Value *v = pending.back();
+        pending.pop_back();
+
+        usage.m_values += 1;
+        usage.m_value_bytes += sizeof(Value) - sizeof(Position);
+        usage.m_position_bytes += sizeof(Position);
+        switch (v->m_type) {
+        case Type::String:
+            usage.m_payload_bytes += sizeof(StringBox);
+            usage.m_string_bytes += string_allocated_bytes(v->m_payload.m_string->m_string);
+            break;
+        case Type::Object:
+            usage.m_payload_bytes += sizeof(ObjectValues);
+            for (const auto &m : *v->m_payload.m_object) {
+                usage.m_node_bytes += MAP_NODE_LINKS;
+                usage.m_key_bytes += sizeof(std::pmr::string) + string_allocated_bytes(m.first);
+                pending.push_back(&m.second);
+            }
+            break;
+        case Type::Array:
+            usage.m_payload_bytes += sizeof(ArrayValues);
+            for (const auto &e : *v->m_payload.m_array) {
+                usage.m_node_bytes += LIST_NODE_LINKS;
+                pending.push_back(&e);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return usage;
+}
+
 inline std::string Value::to_string() const {
     return Generator::to_string(*this);
 }